@@ -0,0 +1,492 @@
+﻿#include "analytics.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// ---- 统计 ----
+
+static void phaseReset(PhaseStats& ps) {
+    ps.seconds = 0;
+    ps.fuelBurned = 0;
+    ps.peakEGT = -DBL_MAX;
+    ps.peakMs = 0;
+    ps.peakEngine = -1;
+}
+
+// b 的时间轴位置加上 base 后并入 a
+static void phaseMerge(PhaseStats& a, const PhaseStats& b, int64_t base) {
+    a.seconds += b.seconds;
+    a.fuelBurned += b.fuelBurned;
+    if (b.peakEGT > a.peakEGT) {
+        a.peakEGT = b.peakEGT;
+        a.peakMs = b.peakMs + base;
+        a.peakEngine = b.peakEngine;
+    }
+}
+
+// 由数值推断阶段；prev 为上一行的阶段
+static int inferPhase(const TelemetrySample& s, int prev) {
+    bool still = true, noFlow = true;
+    double maxN1 = -DBL_MAX;
+    for (int i = 0; i < s.engineCount; i++) {
+        still = still && s.N1[i] == 0;
+        noFlow = noFlow && s.FF[i] == 0;
+        maxN1 = std::max(maxN1, s.N1[i]);
+    }
+    if (noFlow) return still ? ENGINE_OFF : ENGINE_STOPPING;
+    if (prev == ENGINE_RUNNING || maxN1 > 95) return ENGINE_RUNNING;
+    return prev == STATS_PENDING ? (int)STATS_PENDING : (int)ENGINE_STARTING;
+}
+
+void statsBegin(RecordingStats& st, double n1Limit, bool fileStart) {
+    st.n1Limit = n1Limit;
+    st.rows = 0;
+    for (double& a : st.aboveSeconds) a = 0;
+    for (PhaseStats& ps : st.phases) phaseReset(ps);
+    phaseReset(st.pending);
+    st.changes.clear();
+    st.resets.clear();
+    st.faults.clear();
+    st.started = fileStart;
+    memset(&st.first, 0, sizeof(st.first));
+    st.firstPhase = -1;
+    st.timeline = 0;
+    st.prevRaw = 0;
+    st.prevFuel = NAN; // 首行不计耗油
+    st.phase = fileStart ? (int)ENGINE_OFF : (int)STATS_PENDING;
+    st.failed = false;
+    st.errorOffset = 0;
+}
+
+void statsAddRow(RecordingStats& st, const TelemetrySample& s, int phase) {
+    if (!st.started) {
+        // 段首行：时间差、耗油与阶段都取决于前一段，合并时再算
+        st.started = true;
+        st.first = s;
+        st.firstPhase = phase;
+        st.prevRaw = s.timeMs;
+        st.prevFuel = s.fuel;
+        st.phase = phase >= 0 ? phase : inferPhase(s, STATS_PENDING);
+        return;
+    }
+
+    // 每行代表自上一行起的一段时间
+    int64_t d = s.timeMs - st.prevRaw;
+    if (d < 0) {
+        st.resets.push_back(st.timeline);
+        d = s.timeMs;
+    }
+    st.timeline += d;
+    int p = phase >= 0 ? phase : inferPhase(s, st.phase);
+    if (p != st.phase && p != STATS_PENDING) st.changes.push_back({ st.timeline, p });
+
+    PhaseStats& ps = p == STATS_PENDING ? st.pending : st.phases[p];
+    double dt = d * 1e-3;
+    ps.seconds += dt;
+    double burn = st.prevFuel - s.fuel;
+    if (burn > 0) ps.fuelBurned += burn;
+    for (int i = 0; i < s.engineCount; i++) {
+        if (s.T[i] > ps.peakEGT) {
+            ps.peakEGT = s.T[i];
+            ps.peakMs = st.timeline;
+            ps.peakEngine = i;
+        }
+        if (s.N1[i] > st.n1Limit) st.aboveSeconds[i] += dt;
+    }
+
+    st.phase = p;
+    st.prevRaw = s.timeMs;
+    st.prevFuel = s.fuel;
+    st.rows++;
+}
+
+void statsAddFault(RecordingStats& st, int64_t timeMs, FaultType type) {
+    // 告警与其所在行同一步记录，通常属于当前一段；该行之后又归零过时往前找
+    // 第 k 段的时间轴位置 = 起点 + Time(ms)，末行为下一段的起点；首段起点为 -首行 Time(ms)
+    int64_t base = st.timeline - st.prevRaw, end = st.timeline;
+    for (size_t k = st.resets.size(); k > 0 && base + timeMs > end; k--) {
+        end = st.resets[k - 1];
+        base = k > 1 ? st.resets[k - 2] : -st.first.timeMs;
+    }
+    st.faults.push_back({ timeMs, base + timeMs, type });
+}
+
+void statsAppend(RecordingStats& st, const RecordingStats& next) {
+    if (!next.started) return;
+    statsAddRow(st, next.first, next.firstPhase);
+    int64_t base = st.timeline;
+
+    // 段首待定的行与段首行同属 STARTING 或 RUNNING，此时已能确定
+    phaseMerge(st.phase == STATS_PENDING ? st.pending : st.phases[st.phase], next.pending, base);
+    for (int p = 0; p < STATS_PHASES; p++) phaseMerge(st.phases[p], next.phases[p], base);
+    for (int i = 0; i < SIM_MAX_ENGINES; i++) st.aboveSeconds[i] += next.aboveSeconds[i];
+    for (const PhaseChange& c : next.changes) {
+        if (c.phase == st.phase) continue; // 段内从待定转为已知，实际未变
+        st.changes.push_back({ c.ms + base, c.phase });
+        st.phase = c.phase;
+    }
+    if (next.phase != STATS_PENDING) st.phase = next.phase;
+    for (int64_t r : next.resets) st.resets.push_back(r + base);
+    for (const FaultEvent& e : next.faults) st.faults.push_back({ e.timeMs, e.atMs + base, e.type });
+
+    st.timeline = base + next.timeline;
+    st.prevRaw = next.prevRaw;
+    st.prevFuel = next.prevFuel;
+    st.rows += next.rows;
+    if (next.failed && !st.failed) {
+        st.failed = true;
+        st.errorOffset = next.errorOffset;
+    }
+}
+
+// 时间轴位置 ms 处的阶段（文件开头为 OFF）
+static int phaseAt(const std::vector<PhaseChange>& changes, int64_t ms) {
+    auto it = std::upper_bound(changes.begin(), changes.end(), ms,
+        [](int64_t v, const PhaseChange& c) { return v < c.ms; });
+    return it == changes.begin() ? ENGINE_OFF : (it - 1)->phase;
+}
+
+// ms 起第一次进入 a 或 b 阶段的时刻，没有为 -1
+static int64_t nextChange(const std::vector<PhaseChange>& changes, int64_t ms, int a, int b) {
+    auto it = std::lower_bound(changes.begin(), changes.end(), ms,
+        [](const PhaseChange& c, int64_t v) { return c.ms < v; });
+    for (; it != changes.end(); ++it) {
+        if (it->phase == a || it->phase == b) return it->ms;
+    }
+    return -1;
+}
+
+static FaultOutcome outcomeAt(const RecordingStats& st, int64_t atMs, FaultType type) {
+    FaultOutcome o;
+    o.atMs = atMs;
+    o.type = type;
+    o.phase = phaseAt(st.changes, atMs);
+    o.shutdownMs = o.offMs = -1;
+    if (o.phase != ENGINE_OFF) {
+        int64_t stop = o.phase == ENGINE_STOPPING ? atMs : nextChange(st.changes, atMs, ENGINE_STOPPING, ENGINE_OFF);
+        int64_t off = nextChange(st.changes, atMs, ENGINE_OFF, ENGINE_OFF);
+        if (stop >= 0) o.shutdownMs = stop - atMs;
+        if (off >= 0) o.offMs = off - atMs;
+    }
+    return o;
+}
+
+void statsFaultOutcomes(const RecordingStats& st, const std::vector<FaultEvent>& faults, std::vector<FaultOutcome>& out) {
+    // 各段（两次归零之间）的时间轴起点：时间轴位置 = bases[k] + Time(ms)，
+    // 第 k 段最后一行的时间轴位置为 bases[k + 1]
+    std::vector<int64_t> bases(1, 0);
+    bases.insert(bases.end(), st.resets.begin(), st.resets.end());
+    auto fits = [&](size_t k, int64_t t) { return k + 1 == bases.size() || bases[k] + t <= bases[k + 1]; };
+
+    // 日志没有分段信息：按记录顺序分配，Time(ms) 变小说明已是后面的段；
+    // 几段都放得下时优先放到该时刻发动机未关闭的段（告警多发生在运行中）
+    out.clear();
+    size_t seg = 0;
+    int64_t last = -1;
+    for (const FaultEvent& e : faults) {
+        if (e.atMs >= 0) {
+            out.push_back(outcomeAt(st, e.atMs, e.type));
+            continue;
+        }
+        if (e.timeMs < last && seg + 1 < bases.size()) seg++;
+        while (!fits(seg, e.timeMs)) seg++;
+        size_t pick = seg;
+        for (size_t k = seg; k < bases.size() && fits(k, e.timeMs); k++) {
+            if (phaseAt(st.changes, bases[k] + e.timeMs) != ENGINE_OFF) {
+                pick = k;
+                break;
+            }
+        }
+        seg = pick;
+        last = e.timeMs;
+        out.push_back(outcomeAt(st, bases[seg] + e.timeMs, e.type));
+    }
+}
+
+// ---- 数值解析 ----
+
+static const double g_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// 解析一个十进制数，返回其后的位置，不是数时返回 nullptr。
+// 有效数字不超过 15 位、十进制指数在 ±22 以内时尾数与 10 的幂都能精确表示，一次乘除即得正确舍入的结果
+// （%g 输出只有 6 位有效数字，总是走这条路）；其余（含 nan/inf）交给 strtod
+static const char* parseNumber(const char* p, const char* end, double& out) {
+    const char* start = p;
+    bool neg = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) p++;
+    uint64_t mant = 0;
+    int digits = 0, exp10 = 0;
+    bool any = false;
+    for (; p < end && (unsigned)(*p - '0') < 10; p++, any = true) {
+        if (digits < 19) {
+            mant = mant * 10 + (*p - '0');
+            if (mant) digits++;
+        }
+        else exp10++;
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && (unsigned)(*p - '0') < 10; p++, any = true) {
+            if (digits < 19) {
+                mant = mant * 10 + (*p - '0');
+                if (mant) digits++;
+                exp10--;
+            }
+        }
+    }
+    if (any && p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool eneg = q < end && *q == '-';
+        if (q < end && (*q == '-' || *q == '+')) q++;
+        int e = 0;
+        bool edigits = false;
+        for (; q < end && (unsigned)(*q - '0') < 10; q++, edigits = true) {
+            if (e < 10000) e = e * 10 + (*q - '0');
+        }
+        if (edigits) {
+            exp10 += eneg ? -e : e;
+            p = q;
+        }
+    }
+    if (any && digits <= 15 && exp10 >= -22 && exp10 <= 22) {
+        double v = (double)mant;
+        v = exp10 < 0 ? v / g_pow10[-exp10] : v * g_pow10[exp10];
+        out = neg ? -v : v;
+        return p;
+    }
+
+    // 慢路径：字段复制成以 0 结尾的串
+    char buf[64];
+    const char* q = start;
+    size_t n = 0;
+    while (q < end && *q != ',' && *q != '\n' && *q != '\r' && n + 1 < sizeof(buf)) buf[n++] = *q++;
+    buf[n] = 0;
+    char* stop;
+    out = strtod(buf, &stop);
+    if (stop == buf) return nullptr;
+    return start + (stop - buf);
+}
+
+static const char* parseInt(const char* p, const char* end, int64_t& out) {
+    bool neg = p < end && *p == '-';
+    if (neg) p++;
+    const char* digits = p;
+    int64_t v = 0;
+    for (; p < end && (unsigned)(*p - '0') < 10; p++) v = v * 10 + (*p - '0');
+    if (p == digits) return nullptr;
+    out = neg ? -v : v;
+    return p;
+}
+
+// ---- 文件 ----
+
+static bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static bool fileExists(const std::string& path) {
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (fp) fclose(fp);
+    return fp != nullptr;
+}
+
+std::string recordingLogPath(const std::string& csvPath) {
+    size_t slash = csvPath.find_last_of("/\\");
+    size_t nameAt = slash == std::string::npos ? 0 : slash + 1;
+    std::string stem = endsWith(csvPath, ".csv") ? csvPath.substr(0, csvPath.size() - 4) : csvPath;
+    size_t data = stem.rfind("data");
+    if (data != std::string::npos && data >= nameAt) {
+        std::string log = stem.substr(0, data) + "log" + stem.substr(data + 4) + ".txt";
+        if (fileExists(log)) return log;
+    }
+    for (const char* ext : { ".log", ".txt" }) {
+        if (fileExists(stem + ext)) return stem + ext;
+    }
+    return std::string();
+}
+
+// log.txt 的一行："<Time(ms)>ms: <告警文本>"
+static bool readLog(const std::string& path, std::vector<FaultEvent>& out) {
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        long long t;
+        int n = 0;
+        if (sscanf(line, "%lldms: %n", &t, &n) != 1 || n == 0) continue;
+        char* text = line + n;
+        text[strcspn(text, "\r\n")] = 0;
+        for (int f = 1; f < FAULT_TYPE_COUNT; f++) {
+            if (!strcmp(text, faultTypeToString((FaultType)f))) {
+                out.push_back({ (int64_t)t, -1, (FaultType)f });
+                break;
+            }
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+static bool openTlm(RecordingFile& f, size_t chunkBytes, std::string& error) {
+    const uint8_t* p = f.data.data();
+    size_t size = f.data.size();
+    if (size < sizeof(TlmFileHeader)) {
+        error = "not a telemetry file";
+        return false;
+    }
+    memcpy(&f.header, p, sizeof(f.header));
+    if (!tlmCheckHeader(f.header)) {
+        error = "not a telemetry file";
+        return false;
+    }
+    f.engineCount = tlmEngineCount(f.header.columnCount);
+
+    // 只读块头，按块对齐分段；事件块紧随其所属的数据块，不与之分开
+    size_t pos = sizeof(TlmFileHeader), chunkStart = pos;
+    f.bounds.push_back(pos);
+    while (pos + sizeof(TlmBlockHeader) <= size) {
+        TlmBlockHeader bh;
+        memcpy(&bh, p + pos, sizeof(bh));
+        if (pos + sizeof(bh) + bh.payloadBytes > size) break;
+        if (bh.kind == TLM_DATA_BLOCK && pos - chunkStart >= chunkBytes) {
+            f.bounds.push_back(pos);
+            chunkStart = pos;
+        }
+        pos += sizeof(bh) + bh.payloadBytes;
+    }
+    if (f.bounds.back() != pos) f.bounds.push_back(pos);
+    f.truncated = pos != size;
+    return true;
+}
+
+static bool openCsv(RecordingFile& f, size_t chunkBytes, std::string& error) {
+    const char* p = (const char*)f.data.data();
+    size_t size = f.data.size();
+    const char* nl = (const char*)memchr(p, '\n', size);
+    if (!nl || strncmp(p, "Time(ms),", 9) != 0) {
+        error = "missing Time(ms) header";
+        return false;
+    }
+    int columns = 1 + (int)std::count(p, nl, ',');
+    f.engineCount = (columns - 2) / 3;
+    if (f.engineCount < 1 || f.engineCount > SIM_MAX_ENGINES || columns != 3 * f.engineCount + 2) {
+        error = "unexpected number of columns";
+        return false;
+    }
+
+    // 按字节均分，边界挪到下一个换行之后
+    size_t pos = nl + 1 - p;
+    f.bounds.push_back(pos);
+    while (size - pos > chunkBytes) {
+        const char* next = (const char*)memchr(p + pos + chunkBytes, '\n', size - pos - chunkBytes);
+        if (!next) break;
+        pos = next + 1 - p;
+        if (pos < size) f.bounds.push_back(pos);
+    }
+    f.bounds.push_back(size);
+
+    f.logPath = recordingLogPath(f.path);
+    if (!f.logPath.empty() && !readLog(f.logPath, f.faults)) f.logPath.clear();
+    return true;
+}
+
+bool recordingOpen(RecordingFile& f, const char* path, size_t chunkBytes, std::string& error) {
+    f.path = path;
+    f.logPath.clear();
+    f.binary = endsWith(f.path, ".tlm");
+    f.engineCount = 0;
+    f.bounds.clear();
+    f.faults.clear();
+    f.truncated = false;
+    if (chunkBytes == 0) chunkBytes = 1;
+    if (!f.data.open(path)) {
+        error = "cannot open (or empty)";
+        return false;
+    }
+    return f.binary ? openTlm(f, chunkBytes, error) : openCsv(f, chunkBytes, error);
+}
+
+size_t recordingChunks(const RecordingFile& f) {
+    return f.bounds.empty() ? 0 : f.bounds.size() - 1;
+}
+
+static void scanCsv(const RecordingFile& f, size_t k, RecordingStats& out) {
+    const char* data = (const char*)f.data.data();
+    const char* p = data + f.bounds[k];
+    const char* end = data + f.bounds[k + 1];
+    const int n = f.engineCount;
+
+    TelemetrySample s;
+    memset(&s, 0, sizeof(s));
+    s.engineCount = n;
+    // 列顺序：各发动机 N1、T、FF，燃油
+    double* columns[TLM_MAX_VALUE_COLUMNS];
+    for (int i = 0; i < n; i++) {
+        columns[i] = &s.N1[i];
+        columns[n + i] = &s.T[i];
+        columns[2 * n + i] = &s.FF[i];
+    }
+    columns[3 * n] = &s.fuel;
+
+    while (p < end) {
+        if (*p == '\n' || *p == '\r') {
+            p++;
+            continue;
+        }
+        const char* line = p;
+        p = parseInt(p, end, s.timeMs);
+        for (int c = 0; p && c <= 3 * n; c++) {
+            p = p < end && *p == ',' ? parseNumber(p + 1, end, *columns[c]) : nullptr;
+        }
+        if (p && p < end && *p == '\r') p++;
+        if (!p || (p < end && *p != '\n')) {
+            out.failed = true;
+            out.errorOffset = line - data;
+            return;
+        }
+        p++;
+        statsAddRow(out, s, -1);
+    }
+}
+
+static void scanTlm(const RecordingFile& f, size_t k, RecordingStats& out) {
+    const uint8_t* data = f.data.data();
+    TlmBlock block;
+    TelemetrySample s;
+    for (size_t pos = f.bounds[k]; pos < f.bounds[k + 1];) {
+        TlmBlockHeader bh;
+        memcpy(&bh, data + pos, sizeof(bh));
+        if (bh.kind == TLM_DATA_BLOCK) {
+            if (!tlmDecodeBlock(f.header, bh, data + pos + sizeof(bh), block)) {
+                out.failed = true;
+                out.errorOffset = pos;
+                return;
+            }
+            for (size_t r = 0; r < block.rows(); r++) {
+                block.sample(r, s);
+                statsAddRow(out, s, s.state >= 0 && s.state < STATS_PHASES ? s.state : -1);
+            }
+        }
+        else if (bh.kind == TLM_EVENT_BLOCK && bh.payloadBytes == bh.rowCount * sizeof(TlmEvent)) {
+            for (uint32_t i = 0; i < bh.rowCount; i++) {
+                TlmEvent e;
+                memcpy(&e, data + pos + sizeof(bh) + i * sizeof(TlmEvent), sizeof(e));
+                statsAddFault(out, e.timeMs, (FaultType)e.type);
+            }
+        }
+        pos += sizeof(bh) + bh.payloadBytes;
+    }
+}
+
+void recordingScan(const RecordingFile& f, size_t k, double n1Limit, RecordingStats& out) {
+    // 首段的首行也留给合并，由从文件开头开始的统计接上
+    statsBegin(out, n1Limit, false);
+    if (f.binary) scanTlm(f, k, out);
+    else scanCsv(f, k, out);
+}
@@ -0,0 +1,107 @@
+﻿#pragma once
+// 录制遥测的离线统计：N1 超限时间、各阶段 EGT 峰值与耗油率、每次告警到停车的时间
+//
+// 输入为 data.csv（配套的 log.txt）或 .tlm。每个文件按字节切成若干段（CSV 按行、.tlm 按块对齐），
+// 所有文件的所有段一起交给工作窃取线程并行解析与统计，各段结果再按文件顺序合并，
+// 单个大文件也能用满所有核。文件经内存映射按段读取，不整体载入。
+//
+// CSV 没有状态列，阶段由数值推断（与 updateData 的转换条件相同）：N1 与 FF 全为 0 为 OFF，
+// FF 全为 0 为 STOPPING，否则从 OFF 起为 STARTING，N1 超过 95 后为 RUNNING。
+// 段首处于 STARTING 还是 RUNNING 单看本段无法判断，这些行先记为待定，合并时归入前一段末行的阶段。
+// .tlm 直接使用记录中的状态。
+//
+// Time(ms) 在每次 START 时归零；与 telemetry_replay.h 相同，逐行累加时间差得到单调的时间轴。
+#include "mapped_file.h"
+#include "telemetry_format.h"
+#include <string>
+#include <vector>
+
+enum { STATS_PHASES = ENGINE_STOPPING + 1, STATS_PENDING = -1 };
+
+// 一个阶段的累计
+struct PhaseStats {
+    double seconds;
+    double fuelBurned;
+    double peakEGT;   // 没有数据时为 -DBL_MAX
+    int64_t peakMs;   // 峰值所在的时间轴位置
+    int peakEngine;
+};
+
+// 阶段变化：时间轴位置 ms 起进入 phase
+struct PhaseChange {
+    int64_t ms;
+    int phase;
+};
+
+// 一条告警
+struct FaultEvent {
+    int64_t timeMs; // 日志中的 Time(ms)
+    int64_t atMs;   // 时间轴位置，-1 为未知（CSV 的日志，统计后按顺序推定）
+    FaultType type;
+};
+
+// 一段（或合并后整个文件）的统计。段内时间轴位置相对段首行
+struct RecordingStats {
+    double n1Limit;
+    uint64_t rows;
+    double aboveSeconds[SIM_MAX_ENGINES]; // N1 超过 n1Limit 的时间
+    PhaseStats phases[STATS_PHASES];
+    PhaseStats pending;                   // 段首阶段待定的行
+    std::vector<PhaseChange> changes;
+    std::vector<int64_t> resets;          // Time(ms) 归零处：此后时间轴位置 = 该值 + Time(ms)
+    std::vector<FaultEvent> faults;       // .tlm 中的告警（记录在所属数据块之后，扫描时即可定位）
+
+    // 扫描状态
+    bool started;
+    TelemetrySample first;                // 段首行，合并时按前一段末行补算
+    int firstPhase;
+    int64_t timeline;                     // 最后一行的时间轴位置
+    int64_t prevRaw;
+    double prevFuel;
+    int phase;                            // 最后一行的阶段，可能为 STATS_PENDING
+
+    bool failed;
+    size_t errorOffset;                   // 出错位置（文件内字节偏移）
+};
+
+// fileStart 为真时从文件开头统计：首行之前视为 OFF、Time(ms) 为 0；否则为一段，首行留待合并
+void statsBegin(RecordingStats& st, double n1Limit, bool fileStart);
+// phase 为记录中的状态，-1 为按数值推断
+void statsAddRow(RecordingStats& st, const TelemetrySample& s, int phase);
+// 记录中紧随最近数据行之后的告警
+void statsAddFault(RecordingStats& st, int64_t timeMs, FaultType type);
+// 接上文件中紧随其后的一段
+void statsAppend(RecordingStats& st, const RecordingStats& next);
+
+// 告警之后的停车情况
+struct FaultOutcome {
+    int64_t atMs;       // 时间轴位置
+    FaultType type;
+    int phase;          // 告警时的阶段
+    int64_t shutdownMs; // 到进入 STOPPING 的毫秒数，-1 为记录结束前未停车（告警时已在停车为 0）
+    int64_t offMs;      // 到进入 OFF 的毫秒数，-1 为未停下
+};
+
+// 查出各告警之后的停车时间，位置未知的按记录顺序放到时间轴上；告警时已为 OFF 的 shutdownMs/offMs 为 -1
+void statsFaultOutcomes(const RecordingStats& st, const std::vector<FaultEvent>& faults, std::vector<FaultOutcome>& out);
+
+// 一个录制文件：打开时找出分段边界与告警，各段可在任意线程独立统计
+struct RecordingFile {
+    std::string path;
+    std::string logPath;   // CSV 配套的日志，没有时为空
+    bool binary;
+    int engineCount;
+    MappedFile data;
+    TlmFileHeader header;
+    std::vector<size_t> bounds; // 各段起点，末项为数据终点
+    std::vector<FaultEvent> faults; // CSV 配套日志中的告警（.tlm 的在各段统计中）
+    bool truncated;        // .tlm 末块不完整（录制中断）
+};
+
+// 打开录制文件（.tlm 按扩展名识别，其余按 CSV），按约 chunkBytes 分段
+bool recordingOpen(RecordingFile& f, const char* path, size_t chunkBytes, std::string& error);
+size_t recordingChunks(const RecordingFile& f);
+// 统计第 k 段
+void recordingScan(const RecordingFile& f, size_t k, double n1Limit, RecordingStats& out);
+// CSV 的配套日志：data.csv -> log.txt，x-data.csv -> x-log.txt，否则同名 .log / .txt
+std::string recordingLogPath(const std::string& csvPath);
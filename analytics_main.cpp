@@ -0,0 +1,212 @@
+﻿// 录制遥测的批量统计：一晚的 data.csv/log.txt 与 .tlm 一起交给所有核处理（analytics.h）
+#include "analytics.h"
+#include "telemetry.h"
+#include "work_steal.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+static void printUsage(const char* prog) {
+    printf("Usage: %s <recording>... [options]\n", prog);
+    printf("  recordings are .tlm files or CSV files; a CSV is paired with its fault log\n");
+    printf("  (data.csv -> log.txt, run-data.csv -> run-log.txt, otherwise <name>.log or <name>.txt)\n");
+    printf("  --n1-limit <x>   N1 exceedance threshold in %% (default 105)\n");
+    printf("  --events         list every fault with its time to shutdown\n");
+    printf("  --chunk-mb <n>   size of the pieces files are split into (default 4)\n");
+    printf("  --threads <n>    worker threads (default: all hardware threads)\n");
+}
+
+// 某类告警之后的停车时间
+struct FaultSummary {
+    uint64_t count;
+    uint64_t shutdowns;
+    double shutdownSum, shutdownMax; // 秒
+};
+
+static void addOutcomes(FaultSummary* summary, const std::vector<FaultOutcome>& outcomes) {
+    for (const FaultOutcome& o : outcomes) {
+        FaultSummary& fs = summary[o.type];
+        fs.count++;
+        if (o.shutdownMs < 0) continue;
+        double t = o.shutdownMs / 1000.0;
+        fs.shutdowns++;
+        fs.shutdownSum += t;
+        if (t > fs.shutdownMax) fs.shutdownMax = t;
+    }
+}
+
+static void printFaultSummary(const FaultSummary* summary) {
+    for (int f = 1; f < FAULT_TYPE_COUNT; f++) {
+        const FaultSummary& fs = summary[f];
+        if (!fs.count) continue;
+        printf("  %-11s x%-5llu shutdowns %llu", faultTypeName((FaultType)f),
+            (unsigned long long)fs.count, (unsigned long long)fs.shutdowns);
+        if (fs.shutdowns) printf("  time to shutdown mean %.3f s max %.3f s", fs.shutdownSum / fs.shutdowns, fs.shutdownMax);
+        printf("\n");
+    }
+}
+
+static void printPhases(const PhaseStats* phases, int engineCount) {
+    char name[32];
+    for (int p = 0; p < STATS_PHASES; p++) {
+        const PhaseStats& ps = phases[p];
+        if (ps.seconds <= 0 && ps.peakEngine < 0) continue;
+        printf("  %-8s %11.3f s  fuel %9.1f  burn %7.3f/s", engineStateName(p), ps.seconds, ps.fuelBurned,
+            ps.seconds > 0 ? ps.fuelBurned / ps.seconds : 0.0);
+        if (ps.peakEngine >= 0) {
+            telemetryColumnName(name, sizeof(name), "T", ps.peakEngine, engineCount);
+            printf("  peak EGT %.1f (%s at %.3f s)", ps.peakEGT, name, ps.peakMs / 1000.0);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<const char*> paths;
+    double n1Limit = 105;
+    bool listEvents = false;
+    double chunkMb = 4;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--n1-limit") && hasValue) n1Limit = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--events")) listEvents = true;
+        else if (!strcmp(argv[i], "--chunk-mb") && hasValue) chunkMb = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && hasValue) threads = atoi(argv[++i]);
+        else if (argv[i][0] != '-') paths.push_back(argv[i]);
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (paths.empty() || chunkMb <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    size_t chunkBytes = (size_t)(chunkMb * 1024 * 1024);
+
+    auto wallStart = std::chrono::steady_clock::now();
+    // 打开文件（.tlm 扫描块头、CSV 找分段边界并读日志）也并行
+    std::unique_ptr<RecordingFile[]> files(new RecordingFile[paths.size()]);
+    std::vector<std::string> errors(paths.size());
+    std::vector<char> opened(paths.size(), 0);
+    parallelForStealing(paths.size(), 1, threads, [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; i++) opened[i] = recordingOpen(files[i], paths[i], chunkBytes, errors[i]);
+    });
+
+    // 所有文件的所有段一起分给工作线程
+    struct Piece {
+        size_t file, chunk;
+    };
+    std::vector<Piece> pieces;
+    std::vector<size_t> firstPiece(paths.size());
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < paths.size(); i++) {
+        firstPiece[i] = pieces.size();
+        if (!opened[i]) continue;
+        for (size_t k = 0; k < recordingChunks(files[i]); k++) pieces.push_back({ i, k });
+        bytes += files[i].data.size();
+    }
+    std::vector<RecordingStats> stats(pieces.size());
+    parallelForStealing(pieces.size(), 1, threads, [&](size_t begin, size_t end, int) {
+        for (size_t j = begin; j < end; j++) recordingScan(files[pieces[j].file], pieces[j].chunk, n1Limit, stats[j]);
+    });
+
+    // 按文件顺序合并各段
+    int failures = 0;
+    uint64_t rows = 0;
+    double seconds = 0;
+    PhaseStats allPhases[STATS_PHASES];
+    const char* peakFile[STATS_PHASES] = {};
+    double allAbove = 0;
+    FaultSummary allFaults[FAULT_TYPE_COUNT] = {};
+    RecordingStats fileStats;
+    statsBegin(fileStats, n1Limit, true);
+    for (PhaseStats& ps : allPhases) ps = fileStats.phases[0];
+    std::vector<FaultOutcome> outcomes;
+    char name[32];
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        const RecordingFile& f = files[i];
+        if (!opened[i]) {
+            fprintf(stderr, "%s: %s\n", paths[i], errors[i].c_str());
+            failures++;
+            continue;
+        }
+        statsBegin(fileStats, n1Limit, true);
+        for (size_t k = 0; k < recordingChunks(f); k++) statsAppend(fileStats, stats[firstPiece[i] + k]);
+        if (fileStats.failed) {
+            fprintf(stderr, "%s: %s at byte %zu\n", paths[i], f.binary ? "corrupt block" : "malformed line",
+                fileStats.errorOffset);
+            failures++;
+            continue;
+        }
+        const std::vector<FaultEvent>& faults = f.binary ? fileStats.faults : f.faults;
+        statsFaultOutcomes(fileStats, faults, outcomes);
+
+        double fileSeconds = fileStats.timeline / 1000.0;
+        printf("%s: %d engines, %llu rows, %.3f s, %zu faults%s%s%s\n", paths[i], f.engineCount,
+            (unsigned long long)fileStats.rows, fileSeconds,
+            faults.size(), f.binary ? "" : f.logPath.empty() ? " (no log)" : " from ",
+            f.binary ? "" : f.logPath.c_str(), f.truncated ? " (last block incomplete)" : "");
+        printf("  N1 > %g:", n1Limit);
+        for (int e = 0; e < f.engineCount; e++) {
+            telemetryColumnName(name, sizeof(name), "N1", e, f.engineCount);
+            printf(" %s %.3f s", name, fileStats.aboveSeconds[e]);
+            allAbove += fileStats.aboveSeconds[e];
+        }
+        printf("\n");
+        printPhases(fileStats.phases, f.engineCount);
+        FaultSummary fileFaults[FAULT_TYPE_COUNT] = {};
+        addOutcomes(fileFaults, outcomes);
+        addOutcomes(allFaults, outcomes);
+        printFaultSummary(fileFaults);
+        if (listEvents) {
+            for (const FaultOutcome& o : outcomes) {
+                printf("    %12.3f s %-11s %-8s", o.atMs / 1000.0, faultTypeName(o.type), engineStateName(o.phase));
+                if (o.phase == ENGINE_OFF) printf("  engine off\n");
+                else {
+                    if (o.shutdownMs >= 0) printf("  shutdown +%.3f s", o.shutdownMs / 1000.0);
+                    else printf("  no shutdown");
+                    if (o.offMs >= 0) printf("  off +%.3f s", o.offMs / 1000.0);
+                    printf("\n");
+                }
+            }
+        }
+
+        rows += fileStats.rows;
+        seconds += fileSeconds;
+        for (int p = 0; p < STATS_PHASES; p++) {
+            const PhaseStats& ps = fileStats.phases[p];
+            PhaseStats& all = allPhases[p];
+            all.seconds += ps.seconds;
+            all.fuelBurned += ps.fuelBurned;
+            if (ps.peakEGT > all.peakEGT) {
+                all.peakEGT = ps.peakEGT;
+                peakFile[p] = paths[i];
+            }
+        }
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    if (paths.size() - failures > 1) {
+        printf("all files: %llu rows, %.3f s, N1 > %g for %.3f s (engine-seconds)\n",
+            (unsigned long long)rows, seconds, n1Limit, allAbove);
+        for (int p = 0; p < STATS_PHASES; p++) {
+            const PhaseStats& ps = allPhases[p];
+            if (ps.seconds <= 0) continue;
+            printf("  %-8s %11.3f s  fuel %9.1f  burn %7.3f/s", engineStateName(p), ps.seconds, ps.fuelBurned,
+                ps.fuelBurned / ps.seconds);
+            if (peakFile[p]) printf("  peak EGT %.1f (%s)", ps.peakEGT, peakFile[p]);
+            printf("\n");
+        }
+        printFaultSummary(allFaults);
+    }
+    printf("files=%zu pieces=%zu threads=%d bytes=%llu wall=%.3fs MB/s=%.0f rows/s=%.0f\n", paths.size(), pieces.size(),
+        stealingThreadCount(threads), (unsigned long long)bytes, wall, wall > 0 ? bytes / wall / 1e6 : 0.0,
+        wall > 0 ? rows / wall : 0.0);
+    return failures ? 1 : 0;
+}
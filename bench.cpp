@@ -0,0 +1,373 @@
+﻿// 基准测试：仿真、故障判断、告警与遥测各热点路径的吞吐量和延迟，结果可写成 JSON 与上次结果比较
+//
+// 每项基准按批计时：先把批大小加倍到一批约 10us（计时开销可以忽略），之后反复
+// 恢复初始状态、计时执行一批，直到总计时达到 --min-time。每批的平均单次耗时作为一个样本，
+// 报告样本的 p50/p99 与总吞吐量（engine-ticks/s，一个双发仿真推进一步计 2 个）。
+// p50/p99 是约 10us 一批的平均值的分位数，不是单次操作的延迟，偶发的慢操作会被批内平均掉。
+#include "sim_core.h"
+#include "fleet.h"
+#include "telemetry.h"
+#include "telemetry_format.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+// 计算结果写入 volatile 变量，防止编译器删掉只为计时而做的计算
+static volatile long long g_benchSink;
+static void doNotOptimize(long long v) {
+    g_benchSink = v;
+}
+
+struct Benchmark {
+    const char* name;
+    double ticksPerOp;                // 每次操作推进的 engine-tick 数，0 为只报告 ops/s
+    std::function<void()> reset;      // 每批之前恢复初始状态（不计时），可为空
+    std::function<void(long)> run;    // 执行 n 次操作
+};
+
+struct BenchResult {
+    std::string name;
+    long long ops;
+    double seconds;
+    double opsPerSec;
+    double ticksPerSec;
+    double meanNs;
+    double batchP50Ns, batchP99Ns; // 每批平均耗时的分位数
+};
+
+static double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    size_t k = std::min(v.size() - 1, (size_t)(p * (v.size() - 1) + 0.5));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+static double batchSeconds(const Benchmark& b, long n) {
+    if (b.reset) b.reset();
+    Clock::time_point t0 = Clock::now();
+    b.run(n);
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+static BenchResult runBenchmark(const Benchmark& b, double minTime) {
+    long batch = 1;
+    while (batch < (1L << 20) && batchSeconds(b, batch) < 10e-6) batch *= 2;
+
+    std::vector<double> samples;
+    double total = 0;
+    long long ops = 0;
+    while (total < minTime || samples.size() < 100) {
+        double s = batchSeconds(b, batch);
+        samples.push_back(s / batch * 1e9);
+        total += s;
+        ops += batch;
+    }
+
+    BenchResult r;
+    r.name = b.name;
+    r.ops = ops;
+    r.seconds = total;
+    r.opsPerSec = ops / total;
+    r.ticksPerSec = r.opsPerSec * b.ticksPerOp;
+    r.meanNs = total / ops * 1e9;
+    r.batchP50Ns = percentile(samples, 0.50);
+    r.batchP99Ns = percentile(samples, 0.99);
+    return r;
+}
+
+// 推进到指定状态与时刻的仿真（无输出），默认双发单油箱
+static EngineSim makeSim(EngineState state, double seconds, int engines = SIM_DEFAULT_ENGINES, int tanks = 1) {
+    EngineSim sim;
+    SimConfig config;
+    simConfigMake(config, engines, tanks);
+    simInit(sim, config);
+    simSeed(sim, 1);
+    if (state != ENGINE_OFF) simStart(sim);
+    double runFor = state == ENGINE_STARTING ? seconds : 30;
+    for (SimTime end = sim.now + (SimTime)(runFor * 1e6); sim.now < end;) simStep(sim, SIM_REFERENCE_DT);
+    if (state == ENGINE_STOPPING) {
+        simStop(sim);
+        for (SimTime end = sim.now + (SimTime)(seconds * 1e6); sim.now < end;) simStep(sim, SIM_REFERENCE_DT);
+    }
+    return sim;
+}
+
+static TelemetrySample makeSample(const EngineSim& sim) {
+    TelemetrySample s;
+    simMakeSample(sim, s);
+    return s;
+}
+
+// tlm 为空时跳过 .tlm 相关项
+static std::vector<Benchmark> makeBenchmarks(size_t fleetSize, TlmWriter* tlm) {
+    std::vector<Benchmark> list;
+    const SimTime stepUs = (SimTime)llround(SIM_REFERENCE_DT * 1e6);
+
+    // updateData：每个状态各一项，每批从同一初始状态开始
+    static const EngineState states[] = { ENGINE_OFF, ENGINE_STARTING, ENGINE_RUNNING, ENGINE_STOPPING };
+    static const char* const updateNames[] = {
+        "updateData/OFF", "updateData/STARTING", "updateData/RUNNING", "updateData/STOPPING"
+    };
+    for (int k = 0; k < 4; k++) {
+        EngineSim base = makeSim(states[k], 0.5);
+        auto sim = std::make_shared<EngineSim>(base);
+        list.push_back({ updateNames[k], SIM_DEFAULT_ENGINES,
+            [sim, base]() { *sim = base; },
+            [sim, stepUs](long n) {
+                for (long i = 0; i < n; i++) {
+                    sim->now += stepUs;
+                    sim->rng.tick++;
+                    updateData(*sim, SIM_REFERENCE_DT);
+                }
+            } });
+    }
+
+    // 故障判断：完整的 checkFault（规则表 + 告警），以及只做分类的 check*Fault
+    {
+        EngineSim base = makeSim(ENGINE_RUNNING, 0);
+        auto sim = std::make_shared<EngineSim>(base);
+        list.push_back({ "checkFault", SIM_DEFAULT_ENGINES,
+            [sim, base]() { *sim = base; },
+            [sim, stepUs](long n) {
+                for (long i = 0; i < n; i++) {
+                    sim->now += stepUs;
+                    checkFault(*sim);
+                }
+            } });
+        list.push_back({ "checkFault/classify", SIM_DEFAULT_ENGINES, nullptr,
+            [sim](long n) {
+                int sum = 0;
+                for (long i = 0; i < n; i++) {
+                    uint32_t bits = (uint32_t)i * 2654435761u;
+                    sum += checkFuelFault(*sim, bits);
+                    for (int e = 0; e < SIM_DEFAULT_ENGINES; e++) {
+                        sum += checkN1Fault(sim->engines[e], bits >> e);
+                        sum += checkTemperatureFault(sim->engines[e], bits >> e);
+                    }
+                }
+                doNotOptimize(sum);
+            } });
+    }
+
+    // logFault：5 秒内重复（去重命中），以及每次都记录新告警
+    {
+        auto sim = std::make_shared<EngineSim>(makeSim(ENGINE_RUNNING, 0));
+        list.push_back({ "logFault/dedup", 0,
+            [sim]() { alertClear(sim->alerts); logFault(*sim, OVER_FF); },
+            [sim](long n) {
+                for (long i = 0; i < n; i++) logFault(*sim, OVER_FF);
+            } });
+        list.push_back({ "logFault/new", 0,
+            [sim]() { alertClear(sim->alerts); },
+            [sim](long n) {
+                for (long i = 0; i < n; i++) {
+                    sim->now += ALERT_HOLD_US + 1000;
+                    logFault(*sim, (FaultType)(1 + i % (FAULT_TYPE_COUNT - 1)));
+                    simExpireAlerts(*sim);
+                }
+            } });
+    }
+
+    // 遥测序列化：CSV 文本行与 .tlm 列式编码（写临时文件）
+    {
+        TelemetrySample base = makeSample(makeSim(ENGINE_RUNNING, 0));
+        list.push_back({ "telemetry/csv-row", 0, nullptr,
+            [base](long n) {
+                char buf[256];
+                TelemetrySample s = base;
+                size_t len = 0;
+                for (long i = 0; i < n; i++) {
+                    s.timeMs++;
+                    s.N1[0] += 0.001;
+                    len += formatCsvRow(buf, sizeof(buf), s);
+                }
+                doNotOptimize((long long)len);
+            } });
+        if (tlm) {
+            auto s = std::make_shared<TelemetrySample>(base);
+            list.push_back({ "telemetry/tlm-encode", 0, nullptr,
+                [tlm, s](long n) {
+                    for (long i = 0; i < n; i++) {
+                        s->timeMs += 5;
+                        s->N1[0] += 0.001;
+                        tlm->onSample(*s);
+                    }
+                } });
+        }
+
+        // 无界面模式一帧：simStep 加 .tlm 输出
+        EngineSim baseSim = makeSim(ENGINE_RUNNING, 0);
+        auto sim = std::make_shared<EngineSim>(baseSim);
+        list.push_back({ "frame/simStep", SIM_DEFAULT_ENGINES,
+            [sim, baseSim]() { *sim = baseSim; },
+            [sim](long n) {
+                for (long i = 0; i < n; i++) simStep(*sim, SIM_REFERENCE_DT);
+            } });
+        // 四发四油箱构型
+        EngineSim quadSim = makeSim(ENGINE_RUNNING, 0, SIM_MAX_ENGINES, SIM_MAX_TANKS);
+        auto quad = std::make_shared<EngineSim>(quadSim);
+        list.push_back({ "frame/simStep/quad", SIM_MAX_ENGINES,
+            [quad, quadSim]() { *quad = quadSim; },
+            [quad](long n) {
+                for (long i = 0; i < n; i++) simStep(*quad, SIM_REFERENCE_DT);
+            } });
+        if (tlm) {
+            auto simOut = std::make_shared<EngineSim>(baseSim);
+            list.push_back({ "frame/simStep+tlm", SIM_DEFAULT_ENGINES,
+                [simOut, baseSim, tlm]() { *simOut = baseSim; simOut->sinks.assign(1, tlm); },
+                [simOut](long n) {
+                    for (long i = 0; i < n; i++) simStep(*simOut, SIM_REFERENCE_DT);
+                } });
+        }
+    }
+
+    // 机队：fleetSize 台发动机运行中
+    if (fleetSize > 0) {
+        auto fleet = std::make_shared<EngineFleet>();
+        fleetInit(*fleet, fleetSize, 1);
+        for (size_t i = 0; i < fleetSize; i++) fleetStart(*fleet, i);
+        while (fleet->now < 10000000) fleetStep(*fleet, SIM_REFERENCE_DT);
+        list.push_back({ "fleetStep", (double)fleetSize, nullptr,
+            [fleet](long n) {
+                for (long i = 0; i < n; i++) fleetStep(*fleet, SIM_REFERENCE_DT);
+            } });
+    }
+    return list;
+}
+
+static void writeJson(FILE* fp, const std::vector<BenchResult>& results, double minTime) {
+    char date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    fprintf(fp, "{\n  \"context\": {\"date\": \"%s\", \"kernel\": \"%s\", \"min_time\": %g},\n", date, fleetKernelName(), minTime);
+    fprintf(fp, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(fp, "    {\"name\": \"%s\", \"ops\": %lld, \"seconds\": %.6f, \"ops_per_second\": %.6g, "
+            "\"engine_ticks_per_second\": %.6g, \"mean_ns\": %.3f, \"batch_p50_ns\": %.3f, \"batch_p99_ns\": %.3f}%s\n",
+            r.name.c_str(), r.ops, r.seconds, r.opsPerSec, r.ticksPerSec, r.meanNs, r.batchP50Ns, r.batchP99Ns,
+            i + 1 < results.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+}
+
+// 从之前写出的 JSON 中取某项的批 p50（只识别 writeJson 的格式；旧文件的键为 p50_ns）
+static bool baselineP50(const std::string& json, const std::string& name, double& p50) {
+    size_t pos = json.find("\"name\": \"" + name + "\"");
+    if (pos == std::string::npos) return false;
+    size_t end = json.find('}', pos);
+    for (const char* key : { "\"batch_p50_ns\": ", "\"p50_ns\": " }) {
+        size_t at = json.find(key, pos);
+        if (at == std::string::npos || at > end) continue;
+        p50 = atof(json.c_str() + at + strlen(key));
+        return true;
+    }
+    return false;
+}
+
+static std::string readFile(const char* path) {
+    std::string s;
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return s;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) s.append(buf, n);
+    fclose(fp);
+    return s;
+}
+
+static void printUsage(const char* prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --min-time <s>   timed seconds per benchmark (default 0.5)\n");
+    printf("  --filter <text>  run only benchmarks whose name contains text\n");
+    printf("  --fleet <n>      engines in the fleetStep benchmark, 0 to skip (default 4096)\n");
+    printf("  --json <file>    write results as JSON\n");
+    printf("  --baseline <file> compare batch p50 with an earlier --json file\n");
+    printf("  --threshold <%%>  batch p50 slowdown counted as a regression (default 10)\n");
+}
+
+int main(int argc, char** argv) {
+    double minTime = 0.5;
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    double threshold = 10;
+    long fleetSize = 4096;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--min-time") && hasValue) minTime = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--filter") && hasValue) filter = argv[++i];
+        else if (!strcmp(argv[i], "--fleet") && hasValue) fleetSize = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--json") && hasValue) jsonPath = argv[++i];
+        else if (!strcmp(argv[i], "--baseline") && hasValue) baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "--threshold") && hasValue) threshold = atof(argv[++i]);
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::string baseline;
+    if (baselinePath) {
+        baseline = readFile(baselinePath);
+        if (baseline.empty()) {
+            fprintf(stderr, "cannot read %s\n", baselinePath);
+            return 1;
+        }
+    }
+
+    // .tlm 编码写到临时文件，结束后删除
+    const char* tlmPath = "bench.tlm";
+    TlmWriter tlm;
+    bool tlmOpen = tlm.open(tlmPath);
+    std::vector<Benchmark> list = makeBenchmarks(fleetSize > 0 ? (size_t)fleetSize : 0, tlmOpen ? &tlm : nullptr);
+    std::vector<BenchResult> results;
+    int regressions = 0;
+
+    printf("kernel=%s min-time=%gs\n", fleetKernelName(), minTime);
+    printf("%-22s %12s %14s %10s %10s %10s\n", "benchmark", "ops/s", "engine-ticks/s", "mean(ns)", "batch p50", "batch p99");
+    for (const Benchmark& b : list) {
+        if (filter && !strstr(b.name, filter)) continue;
+        BenchResult r = runBenchmark(b, minTime);
+        results.push_back(r);
+        printf("%-22s %12.4g %14.4g %10.1f %10.1f %10.1f", r.name.c_str(), r.opsPerSec, r.ticksPerSec, r.meanNs, r.batchP50Ns, r.batchP99Ns);
+        double base;
+        if (baselinePath && baselineP50(baseline, r.name, base) && base > 0) {
+            double change = (r.batchP50Ns / base - 1) * 100;
+            bool slower = change > threshold;
+            regressions += slower;
+            printf("  %+6.1f%%%s", change, slower ? " REGRESSION" : "");
+        }
+        printf("\n");
+    }
+    if (tlmOpen) {
+        tlm.close();
+        remove(tlmPath);
+    }
+
+    if (jsonPath) {
+        FILE* fp = fopen(jsonPath, "w");
+        if (!fp) {
+            fprintf(stderr, "cannot open %s\n", jsonPath);
+            return 1;
+        }
+        writeJson(fp, results, minTime);
+        fclose(fp);
+    }
+    if (regressions) {
+        printf("%d benchmark(s) slower than baseline by more than %g%%\n", regressions, threshold);
+        return 2;
+    }
+    return 0;
+}
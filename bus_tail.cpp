@@ -0,0 +1,84 @@
+﻿// 共享内存遥测总线的读者示例：把仿真器（--bus <name>）发布的记录实时打印为 data.csv / log.txt 格式
+#include "telemetry.h"
+#include "telemetry_bus.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+static void printUsage(const char* prog) {
+    printf("Usage: %s <name> [options]\n", prog);
+    printf("  --oldest        start from the oldest record still in the ring (default: new records only)\n");
+    printf("  --every <n>     print every n-th sample (faults are always printed)\n");
+    printf("  --stats         print only the record, fault and overrun counts when the writer closes\n");
+    printf("  --wait          wait for the bus to appear instead of failing\n");
+}
+
+int main(int argc, char** argv) {
+    const char* name = nullptr;
+    bool oldest = false, statsOnly = false, wait = false;
+    long every = 1;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--oldest")) oldest = true;
+        else if (!strcmp(argv[i], "--every") && hasValue) every = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--stats")) statsOnly = true;
+        else if (!strcmp(argv[i], "--wait")) wait = true;
+        else if (argv[i][0] != '-' && !name) name = argv[i];
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (!name || every <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    TelemetryBusReader bus;
+    while (!bus.open(name, oldest)) {
+        if (!wait) {
+            fprintf(stderr, "%s: no telemetry bus (or incompatible version)\n", name);
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (!statsOnly) fputs(csvHeader(bus.engineCount()).c_str(), stdout);
+
+    TelemetryBusRecord r;
+    uint64_t samples = 0, faults = 0, overruns = 0;
+    char line[512];
+    while (!bus.finished()) {
+        TelemetryBusResult res = bus.next(r);
+        if (res == TBUS_EMPTY) {
+            // 没有新记录时短暂睡眠，读者不占满一个核
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            continue;
+        }
+        if (res == TBUS_OVERRUN) {
+            overruns++;
+            if (!statsOnly) fprintf(stderr, "overrun: %llu records lost so far\n", (unsigned long long)bus.lost());
+            continue;
+        }
+        if (r.kind == TBUS_FAULT) {
+            faults++;
+            if (!statsOnly) {
+                formatLogLine(line, sizeof(line), r.sample.timeMs, (FaultType)r.fault);
+                fputs(line, stdout);
+            }
+        }
+        else if (r.kind == TBUS_SAMPLE) {
+            if (!statsOnly && samples % every == 0) {
+                formatCsvRow(line, sizeof(line), r.sample);
+                fputs(line, stdout);
+            }
+            samples++;
+        }
+        if (!statsOnly && bus.backlog() == 0) fflush(stdout);
+    }
+    fprintf(statsOnly ? stdout : stderr, "samples=%llu faults=%llu overruns=%llu lost=%llu\n",
+        (unsigned long long)samples, (unsigned long long)faults, (unsigned long long)overruns,
+        (unsigned long long)bus.lost());
+    return 0;
+}
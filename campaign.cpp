@@ -0,0 +1,330 @@
+﻿#include "campaign.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+// ---- 说明文件解析 ----
+
+static std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+static bool parseNumber(const std::string& s, double& v) {
+    char* end = nullptr;
+    v = strtod(s.c_str(), &end);
+    return end != s.c_str() && trim(end).empty();
+}
+
+static bool parseRange(const std::string& s, double& lo, double& hi) {
+    size_t dots = s.find("..");
+    if (dots == std::string::npos) {
+        if (!parseNumber(trim(s), lo)) return false;
+        hi = lo;
+        return true;
+    }
+    return parseNumber(trim(s.substr(0, dots)), lo) && parseNumber(trim(s.substr(dots + 2)), hi) && lo <= hi;
+}
+
+static bool parseFaults(const std::string& s, std::vector<FaultType>& out) {
+    out.clear();
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) comma = s.size();
+        std::string name = trim(s.substr(pos, comma - pos));
+        FaultType ft = faultTypeFromName(name.c_str());
+        if (ft == NO_FAULT) return false;
+        out.push_back(ft);
+        pos = comma + 1;
+    }
+    return !out.empty();
+}
+
+static bool setKey(CampaignSpec& spec, CampaignScenario& sc, const std::string& key, const std::string& value) {
+    double v;
+    if (key == "seed") {
+        if (!parseNumber(value, v) || v < 0) return false;
+        spec.seed = (uint64_t)v;
+    }
+    else if (key == "runs") {
+        if (!parseNumber(value, v) || v < 0) return false;
+        sc.runs = (uint64_t)v;
+    }
+    else if (key == "dt") {
+        if (!parseNumber(value, sc.dt) || sc.dt <= 0) return false;
+    }
+    else if (key == "start") return parseNumber(value, sc.startAt);
+    else if (key == "stop") return parseNumber(value, sc.stopAt);
+    else if (key == "duration") {
+        if (!parseNumber(value, sc.duration) || sc.duration <= 0) return false;
+    }
+    else if (key == "fault") return parseFaults(value, sc.faults);
+    else if (key == "state") {
+        if (value == "ANY") sc.injectState = -1;
+        else if ((sc.injectState = engineStateFromName(value.c_str())) < 0) return false;
+    }
+    else if (key == "inject") return parseRange(value, sc.injectMin, sc.injectMax);
+    else if (key == "fork" || key == "crossfeed") {
+        if (value != "yes" && value != "no") return false;
+        (key == "fork" ? sc.fork : sc.crossFeed) = value == "yes";
+    }
+    else if (key == "engines") {
+        if (!parseNumber(value, v) || v < 1 || v > SIM_MAX_ENGINES) return false;
+        sc.engines = (int)v;
+    }
+    else if (key == "tanks") {
+        if (!parseNumber(value, v) || v < 1 || v > SIM_MAX_TANKS) return false;
+        sc.tanks = (int)v;
+    }
+    else if (key == "fuel") {
+        if (!parseNumber(value, sc.tankFuel) || sc.tankFuel < 0) return false;
+    }
+    else return false;
+    return true;
+}
+
+bool campaignParse(const char* path, CampaignSpec& spec, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = std::string("cannot open ") + path;
+        return false;
+    }
+    spec = CampaignSpec();
+    CampaignScenario defaults;
+    CampaignScenario* cur = &defaults;
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+        line = trim(line);
+        if (line.empty()) continue;
+
+        if (line[0] == '[') {
+            if (line.back() != ']') {
+                error = "line " + std::to_string(lineNo) + ": bad section";
+                return false;
+            }
+            spec.scenarios.push_back(defaults);
+            cur = &spec.scenarios.back();
+            cur->name = trim(line.substr(1, line.size() - 2));
+            continue;
+        }
+        size_t eq = line.find('=');
+        std::string key = eq == std::string::npos ? line : trim(line.substr(0, eq));
+        std::string value = eq == std::string::npos ? "" : trim(line.substr(eq + 1));
+        if (!setKey(spec, *cur, key, value)) {
+            error = "line " + std::to_string(lineNo) + ": bad value for '" + key + "'";
+            return false;
+        }
+    }
+    // 没有分段时整个文件就是一个场景
+    if (spec.scenarios.empty()) {
+        spec.scenarios.push_back(defaults);
+        spec.scenarios.back().name = "default";
+    }
+    for (const CampaignScenario& sc : spec.scenarios) {
+        if (sc.faults.empty()) {
+            error = "scenario '" + sc.name + "' has no fault";
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---- 单次运行 ----
+
+// 每次运行的随机抽样（故障种类、注入时刻、仿真种子）
+static uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// (seed, 场景, 运行) 逐个混入 splitMix64 得到的随机流起点；直接异或会让不同组合落到同一条流
+static uint64_t runStream(uint64_t seed, uint64_t scenario, uint64_t run) {
+    uint64_t state = seed;
+    state = splitMix64(state) ^ scenario;
+    state = splitMix64(state) ^ run;
+    return splitMix64(state);
+}
+
+static double uniform01(uint64_t& state) {
+    return (splitMix64(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void campaignInit(EngineSim& sim, const CampaignScenario& sc) {
+    SimConfig config;
+    simConfigMake(config, sc.engines, sc.tanks, sc.crossFeed, sc.tankFuel);
+    simInit(sim, config);
+}
+
+// 只记录出现过哪些告警
+class AlertCollector : public TelemetrySink {
+public:
+    uint32_t mask = 0;
+    void onSample(const TelemetrySample&) override {}
+    void onFault(int64_t, FaultType ft) override { mask |= 1u << ft; }
+};
+
+static void campaignBegin(const EngineSim& sim, CampaignProgress& p) {
+    p.stateSince = 0;
+    p.injectUs = 0;
+    p.lastState = sim.state.state;
+    p.started = false;
+    p.stopped = false;
+    p.leftOff = false;
+}
+
+// 按时刻按下 START/STOP，并记录进入当前状态的时刻
+static void campaignControl(EngineSim& sim, const CampaignScenario& sc, CampaignProgress& p) {
+    if (!p.started && sim.now >= (SimTime)(sc.startAt * 1e6)) {
+        simStart(sim);
+        p.started = true;
+    }
+    if (!p.stopped && sc.stopAt >= 0 && sim.now >= (SimTime)(sc.stopAt * 1e6)) {
+        simStop(sim);
+        p.stopped = true;
+    }
+    if (sim.state.state != p.lastState) {
+        p.lastState = sim.state.state;
+        p.stateSince = sim.now;
+    }
+}
+
+static bool campaignInjectDue(const EngineSim& sim, const CampaignScenario& sc, const CampaignProgress& p, SimTime delayUs) {
+    return (sc.injectState < 0 || sc.injectState == p.lastState)
+        && sim.now - (sc.injectState < 0 ? 0 : p.stateSince) >= delayUs;
+}
+
+// 发动机已运转后回到 OFF，此后不会再有变化
+static bool campaignEngineDone(const EngineSim& sim, CampaignProgress& p) {
+    int st = sim.state.state;
+    if (st != ENGINE_OFF) p.leftOff = true;
+    return p.leftOff && st == ENGINE_OFF;
+}
+
+void campaignPrefix(const CampaignScenario& sc, uint64_t seed, size_t scenario, CampaignPrefix& out) {
+    // 与各次运行的随机数分开（运行序号不会用到这么大的值）
+    uint64_t rng = runStream(seed, scenario, UINT64_MAX);
+    out.simSeed = (uint32_t)splitMix64(rng);
+    out.valid = false;
+
+    EngineSim sim;
+    campaignInit(sim, sc);
+    simSeed(sim, out.simSeed);
+    AlertCollector alerts;
+    sim.sinks.push_back(&alerts);
+
+    campaignBegin(sim, out.progress);
+    SimTime endUs = (SimTime)(sc.duration * 1e6);
+    SimTime delayUs = (SimTime)(sc.injectMin * 1e6);
+    while (sim.now < endUs) {
+        campaignControl(sim, sc, out.progress);
+        if (campaignInjectDue(sim, sc, out.progress, delayUs)) {
+            out.valid = true;
+            break;
+        }
+        simStep(sim, sc.dt);
+        if (campaignEngineDone(sim, out.progress) && sc.injectState >= 0) break;
+    }
+    sim.sinks.pop_back();
+    out.state = sim;
+    out.alerts = alerts.mask;
+}
+
+void campaignRun(const CampaignScenario& sc, uint64_t seed, size_t scenario, uint64_t run, CampaignRun& out,
+    const CampaignPrefix* prefix) {
+    uint64_t rng = runStream(seed, scenario, run);
+    out.fault = sc.faults[(size_t)(uniform01(rng) * sc.faults.size())];
+    double delay = sc.injectMin + (sc.injectMax - sc.injectMin) * uniform01(rng);
+    out.simSeed = (uint32_t)splitMix64(rng);
+    out.injected = false;
+    out.injectMs = -1;
+    out.shutdownMs = -1;
+
+    EngineSim sim;
+    AlertCollector alerts;
+    CampaignProgress p;
+    if (prefix && prefix->valid) {
+        // 从预热段的末尾继续，随机流按运行序号区分
+        simBranch(sim, prefix->state, (uint32_t)run + 1);
+        p = prefix->progress;
+        alerts.mask = prefix->alerts;
+        out.simSeed = prefix->simSeed;
+    }
+    else {
+        campaignInit(sim, sc);
+        simSeed(sim, out.simSeed);
+        campaignBegin(sim, p);
+    }
+    sim.sinks.push_back(&alerts);
+
+    SimTime endUs = (SimTime)(sc.duration * 1e6);
+    SimTime delayUs = (SimTime)(delay * 1e6);
+    while (sim.now < endUs) {
+        campaignControl(sim, sc, p);
+        if (!out.injected && campaignInjectDue(sim, sc, p, delayUs)) {
+            simSetFault(sim, (FaultType)out.fault, true);
+            out.injected = true;
+            p.injectUs = sim.now;
+            out.injectMs = sim.now / 1000;
+        }
+
+        simStep(sim, sc.dt);
+
+        int st = sim.state.state;
+        bool done = campaignEngineDone(sim, p);
+        if (out.injected && out.shutdownMs < 0 && (st == ENGINE_STOPPING || done))
+            out.shutdownMs = (sim.now - p.injectUs) / 1000;
+        if (done && (out.injected || sc.injectState >= 0)) break;
+    }
+    sim.sinks.pop_back();
+    out.alerts = alerts.mask;
+    out.fuel = simTotalFuel(sim);
+}
+
+// ---- 统计 ----
+
+static double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    size_t k = (size_t)(p * (v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+void campaignSummarize(const std::vector<CampaignRun>& runs, CampaignSummary& out) {
+    memset(&out, 0, sizeof(out));
+    out.runs = runs.size();
+    std::vector<double> shutdown;
+    double fuelSum = 0;
+    out.fuelMin = runs.empty() ? 0 : runs[0].fuel;
+    out.fuelMax = out.fuelMin;
+    for (const CampaignRun& r : runs) {
+        if (r.injected) out.injected++;
+        if (r.shutdownMs >= 0) shutdown.push_back(r.shutdownMs / 1000.0);
+        for (int f = 1; f < FAULT_TYPE_COUNT; f++) {
+            if (r.alerts & (1u << f)) out.alertRuns[f]++;
+        }
+        fuelSum += r.fuel;
+        out.fuelMin = std::min(out.fuelMin, r.fuel);
+        out.fuelMax = std::max(out.fuelMax, r.fuel);
+    }
+    out.shutdowns = shutdown.size();
+    if (!shutdown.empty()) {
+        double sum = 0;
+        for (double s : shutdown) sum += s;
+        out.shutdownMean = sum / shutdown.size();
+        out.shutdownMax = *std::max_element(shutdown.begin(), shutdown.end());
+        out.shutdownP50 = percentile(shutdown, 0.50);
+        out.shutdownP99 = percentile(shutdown, 0.99);
+    }
+    out.fuelMean = runs.empty() ? 0 : fuelSum / runs.size();
+}
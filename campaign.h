@@ -0,0 +1,92 @@
+﻿#pragma once
+// 蒙特卡洛故障注入批量试验
+//
+// 试验说明文件为文本，每个 [场景] 一组参数，段前的参数作为各场景的默认值：
+//
+//   seed = 42
+//   [hot-start]
+//   runs = 100000
+//   fault = OVER_TEMP1, OVER_TEMP2      # 每次运行从中均匀抽取一种
+//   state = STARTING                   # 发动机进入该状态后才注入，ANY 为不限
+//   inject = 0.5 .. 8                  # 进入状态后再过多久注入（秒，均匀分布）
+//   fork = yes                         # 共用预热段，见下
+//   engines = 4                        # 构型（默认双发单油箱），另有 tanks / crossfeed / fuel
+//
+// fork = yes 时先只仿真一次到最早的注入时刻（进入状态后 inject 下限），
+// 各次运行从这个检查点分支（checkpoint.h），换用各自的随机流继续，
+// 省去成千上万次重复仿真相同的启动过程；此时所有运行共用同一个仿真种子。
+// 每次运行的随机数只由 (seed, 场景序号, 运行序号) 决定，与线程数和调度顺序无关。
+#include "checkpoint.h"
+#include <string>
+#include <vector>
+
+struct CampaignScenario {
+    std::string name;
+    uint64_t runs = 1000;
+    double dt = 0.005;
+    double startAt = 0;      // 按 START 的时刻（秒）
+    double stopAt = -1;      // 按 STOP 的时刻，<0 不按
+    double duration = 120;   // 每次运行的最长仿真时间
+    std::vector<FaultType> faults;
+    int injectState = -1;    // EngineState，-1 为任意状态
+    double injectMin = 0;
+    double injectMax = 0;
+    bool fork = false;       // 从共用的预热段分支
+    // 构型（SimConfig）
+    int engines = SIM_DEFAULT_ENGINES;
+    int tanks = 1;
+    bool crossFeed = false;
+    double tankFuel = 3000;
+};
+
+struct CampaignSpec {
+    uint64_t seed = 1;
+    std::vector<CampaignScenario> scenarios;
+};
+
+// 一次运行的结果
+struct CampaignRun {
+    uint32_t simSeed;
+    int32_t fault;      // 注入的 FaultType
+    bool injected;      // 是否到达注入条件
+    int64_t injectMs;   // 注入时的仿真时刻（毫秒）
+    int64_t shutdownMs; // 注入到开始停车的毫秒数，-1 为未停车
+    uint32_t alerts;    // 出现过的告警（按 FaultType 位）
+    double fuel;        // 结束时燃油余量
+};
+
+// 一个场景的统计
+struct CampaignSummary {
+    uint64_t runs;
+    uint64_t injected;
+    uint64_t shutdowns;
+    // 注入到停车的时间（秒），只统计停车的运行
+    double shutdownMean, shutdownP50, shutdownP99, shutdownMax;
+    uint64_t alertRuns[FAULT_TYPE_COUNT]; // 出现各告警的运行数
+    double fuelMean, fuelMin, fuelMax;
+};
+
+// 一次运行中注入前的控制进度
+struct CampaignProgress {
+    SimTime stateSince; // 进入当前状态的时刻
+    SimTime injectUs;
+    int lastState;
+    bool started, stopped, leftOff;
+};
+
+// 分支起点：仿真到最早的注入时刻为止的状态
+struct CampaignPrefix {
+    bool valid;       // 未到达注入条件时为 false，各次运行仍从头仿真
+    uint32_t simSeed;
+    SimState state;
+    CampaignProgress progress;
+    uint32_t alerts;  // 预热段中出现过的告警
+};
+
+bool campaignParse(const char* path, CampaignSpec& spec, std::string& error);
+// 计算场景的共用预热段（fork = yes 时在各次运行之前调用一次）
+void campaignPrefix(const CampaignScenario& sc, uint64_t seed, size_t scenario, CampaignPrefix& out);
+// prefix 非空且有效时从它分支，否则从头仿真
+void campaignRun(const CampaignScenario& sc, uint64_t seed, size_t scenario, uint64_t run, CampaignRun& out,
+    const CampaignPrefix* prefix = nullptr);
+void campaignSummarize(const std::vector<CampaignRun>& runs, CampaignSummary& out);
@@ -0,0 +1,93 @@
+﻿#include "checkpoint.h"
+#include <cstdio>
+#include <cstring>
+
+static const char CHECKPOINT_MAGIC[4] = { 'E', 'S', 'C', 'K' };
+
+// 告警文本是指向静态字符串的指针，跨进程加载后地址可能不同，按类型重新取
+static void fixAlertText(AlertTable& t) {
+    for (int i = 0; i < FAULT_TYPE_COUNT; i++) t.slots[i].text = faultTypeToString(t.slots[i].type);
+}
+
+static bool alertIndexValid(int i) {
+    return i == ALERT_NONE || (i >= 0 && i < FAULT_TYPE_COUNT);
+}
+
+// 告警表的链表下标会被直接跟随，文件中的值须先检查：下标合法，链表从 head 到 tail 前后一致、
+// 不成环，且恰好串起全部 count 个活动告警
+static bool alertTableValid(const AlertTable& t) {
+    if (!alertIndexValid(t.head) || !alertIndexValid(t.tail) || t.count < 0 || t.count > FAULT_TYPE_COUNT) return false;
+    int active = 0;
+    for (int i = 0; i < FAULT_TYPE_COUNT; i++) {
+        const AlertInfo& a = t.slots[i];
+        if (a.type != (FaultType)i || !alertIndexValid(a.prev) || !alertIndexValid(a.next)) return false;
+        if (a.active) active++;
+    }
+    if (active != t.count) return false;
+    int n = 0, prev = ALERT_NONE;
+    for (int i = t.head; i != ALERT_NONE; i = t.slots[i].next) {
+        if (++n > t.count || !t.slots[i].active || t.slots[i].prev != prev) return false;
+        prev = i;
+    }
+    return n == t.count && prev == t.tail;
+}
+
+// 用作下标或枚举的其余字段
+static bool stateValid(const SimState& s) {
+    const SimConfig& c = s.config;
+    if (c.engineCount < 1 || c.engineCount > SIM_MAX_ENGINES || c.tankCount < 1 || c.tankCount > SIM_MAX_TANKS) return false;
+    for (int i = 0; i < SIM_MAX_ENGINES; i++) {
+        if (c.engineTank[i] < 0 || c.engineTank[i] >= c.tankCount) return false;
+    }
+    if (s.state.state < ENGINE_OFF || s.state.state > ENGINE_STOPPING) return false;
+    return alertTableValid(s.alerts);
+}
+
+void simCheckpoint(const EngineSim& sim, std::vector<uint8_t>& out) {
+    SimCheckpointHeader h;
+    memcpy(h.magic, CHECKPOINT_MAGIC, 4);
+    h.version = SIM_CHECKPOINT_VERSION;
+    h.stateBytes = sizeof(SimState);
+    h.reserved = 0;
+    out.resize(sizeof(h) + sizeof(SimState));
+    memcpy(out.data(), &h, sizeof(h));
+    memcpy(out.data() + sizeof(h), static_cast<const SimState*>(&sim), sizeof(SimState));
+}
+
+bool simRestore(EngineSim& sim, const uint8_t* data, size_t size) {
+    SimCheckpointHeader h;
+    if (size != sizeof(h) + sizeof(SimState)) return false;
+    memcpy(&h, data, sizeof(h));
+    if (memcmp(h.magic, CHECKPOINT_MAGIC, 4) != 0 || h.version != SIM_CHECKPOINT_VERSION || h.stateBytes != sizeof(SimState))
+        return false;
+    SimState s;
+    memcpy(&s, data + sizeof(h), sizeof(SimState));
+    if (!stateValid(s)) return false;
+    fixAlertText(s.alerts);
+    static_cast<SimState&>(sim) = s;
+    return true;
+}
+
+bool simSaveCheckpoint(const EngineSim& sim, const char* path) {
+    std::vector<uint8_t> buf;
+    simCheckpoint(sim, buf);
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return false;
+    bool ok = fwrite(buf.data(), 1, buf.size(), fp) == buf.size();
+    return fclose(fp) == 0 && ok;
+}
+
+bool simLoadCheckpoint(EngineSim& sim, const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return false;
+    // 多读一个字节，以便发现过长的文件
+    std::vector<uint8_t> buf(sizeof(SimCheckpointHeader) + sizeof(SimState) + 1);
+    size_t n = fread(buf.data(), 1, buf.size(), fp);
+    fclose(fp);
+    return simRestore(sim, buf.data(), n);
+}
+
+void simBranch(EngineSim& out, const SimState& base, uint32_t stream) {
+    static_cast<SimState&>(out) = base;
+    simSeed(out, base.rng.seed, stream);
+}
@@ -0,0 +1,32 @@
+﻿#pragma once
+// 检查点与分支：SimState 是一块定长、可按字节复制的内存（约 1.6KB），
+// 保存/恢复就是整块复制，分支就是复制后换一条随机流。
+//
+// 二进制检查点只在同一构建（同一 SimState 布局）之间通用：文件头记录版本与 sizeof(SimState)，
+// 不一致时拒绝加载。
+#include "sim_core.h"
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+static_assert(std::is_trivially_copyable<SimState>::value, "SimState must stay trivially copyable");
+
+enum { SIM_CHECKPOINT_VERSION = 3 };
+
+struct SimCheckpointHeader {
+    char magic[4];       // "ESCK"
+    uint32_t version;    // SIM_CHECKPOINT_VERSION
+    uint32_t stateBytes; // sizeof(SimState)
+    uint32_t reserved;
+};
+
+// 保存全部仿真状态（不含输出接口）
+void simCheckpoint(const EngineSim& sim, std::vector<uint8_t>& out);
+// 恢复状态，sim 的输出接口保持不变；数据无效时返回 false 且不修改 sim
+bool simRestore(EngineSim& sim, const uint8_t* data, size_t size);
+bool simSaveCheckpoint(const EngineSim& sim, const char* path);
+bool simLoadCheckpoint(EngineSim& sim, const char* path);
+
+// 从 base 分出一个变体：复制状态（时刻、tick 不变），改用随机流 stream，
+// 此后各变体的随机数互不相同、各自可复现。out 的输出接口保持不变。
+void simBranch(EngineSim& out, const SimState& base, uint32_t stream);
@@ -0,0 +1,199 @@
+﻿#pragma once
+// 声明式故障规则表
+//
+// 每条规则：信号、比较方式、阈值、在哪些状态下有效、被哪些传感器故障屏蔽、
+// 回差（超限后要回到 阈值∓回差 才解除）、确认时间（持续超限多久才报警）、确认后是否停车。
+// evaluateFaultRules 以 SIMD 封装（simd_vec.h）一次处理多台发动机，规则表为 constexpr，
+// 各规则在编译期展开，阈值成为立即数，不需要的回差/确认计时代码被 if constexpr 去掉。
+#include "sim_core.h"
+#include "simd_vec.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+enum FaultSignal { SIGNAL_N1, SIGNAL_T, SIGNAL_FF, SIGNAL_FUEL };
+enum FaultCompare { COMPARE_GT, COMPARE_LT, COMPARE_LE };
+
+// 规则输入中的传感器故障位（每台发动机一组）
+enum RuleSensorBits {
+    RULE_N1S1 = 1,
+    RULE_N1S2 = 2,
+    RULE_EGTS1 = 4,
+    RULE_EGTS2 = 8,
+    RULE_FUELS = 16,
+    RULE_N1S_ANY = RULE_N1S1 | RULE_N1S2,
+    RULE_EGTS_ANY = RULE_EGTS1 | RULE_EGTS2
+};
+
+enum {
+    STATE_BIT_STARTING = 1 << ENGINE_STARTING,
+    STATE_BIT_RUNNING = 1 << ENGINE_RUNNING,
+    STATE_BIT_ANY = 0xF
+};
+
+struct FaultRule {
+    FaultType fault;
+    FaultSignal signal;
+    FaultCompare compare;
+    double threshold;
+    double hysteresis;     // 0 为无回差
+    double confirmSeconds; // 0 为立即确认
+    uint32_t states;       // 有效状态（1 << EngineState）
+    int32_t inhibit;       // 任一位置位时规则无效（RuleSensorBits）
+    bool shutdown;         // 确认后停车
+};
+
+// 同一信号的规则按严重程度从高到低排列，界面/日志取最先命中的一条。
+// 默认表与原来的判断逐步一致：无回差、立即确认
+constexpr FaultRule g_faultRules[] = {
+    { OVER_SPD2,  SIGNAL_N1,   COMPARE_GT, 120,  0,    0, STATE_BIT_ANY,      RULE_N1S_ANY,  true },
+    { OVER_SPD1,  SIGNAL_N1,   COMPARE_GT, 105,  0,    0, STATE_BIT_ANY,      RULE_N1S_ANY,  false },
+    { OVER_TEMP2, SIGNAL_T,    COMPARE_GT, 1000, 0,    0, STATE_BIT_STARTING, RULE_EGTS_ANY, true },
+    { OVER_TEMP1, SIGNAL_T,    COMPARE_GT, 850,  0,    0, STATE_BIT_STARTING, RULE_EGTS_ANY, false },
+    { OVER_TEMP4, SIGNAL_T,    COMPARE_GT, 1100, 0,    0, STATE_BIT_RUNNING,  RULE_EGTS_ANY, true },
+    { OVER_TEMP3, SIGNAL_T,    COMPARE_GT, 950,  0,    0, STATE_BIT_RUNNING,  RULE_EGTS_ANY, false },
+    { OVER_FF,    SIGNAL_FF,   COMPARE_GT, 50,   0,    0, STATE_BIT_ANY,      0,             false },
+    // 油量耗尽停车与低油量告警同一故障位
+    { LOW_FUEL,   SIGNAL_FUEL, COMPARE_LE, 0,    0,    0, STATE_BIT_STARTING | STATE_BIT_RUNNING, RULE_FUELS, true },
+    { LOW_FUEL,   SIGNAL_FUEL, COMPARE_LT, 1000, 0,    0, STATE_BIT_STARTING | STATE_BIT_RUNNING, RULE_FUELS, false },
+};
+constexpr size_t FAULT_RULE_COUNT = sizeof(g_faultRules) / sizeof(g_faultRules[0]);
+static_assert(FAULT_RULE_COUNT <= SIM_MAX_FAULT_RULES, "raise SIM_MAX_FAULT_RULES");
+
+// 滤波告警表（SimConfig::filteredAlerts 选用）：非停车类告警需持续超限 0.5 秒才报，
+// 报出后回到 阈值 - 回差 以下才解除，数值在阈值附近抖动时不反复报警。停车规则不变
+constexpr FaultRule g_filteredFaultRules[] = {
+    { OVER_SPD2,  SIGNAL_N1,   COMPARE_GT, 120,  0,    0,   STATE_BIT_ANY,      RULE_N1S_ANY,  true },
+    { OVER_SPD1,  SIGNAL_N1,   COMPARE_GT, 105,  1.0,  0.5, STATE_BIT_ANY,      RULE_N1S_ANY,  false },
+    { OVER_TEMP2, SIGNAL_T,    COMPARE_GT, 1000, 0,    0,   STATE_BIT_STARTING, RULE_EGTS_ANY, true },
+    { OVER_TEMP1, SIGNAL_T,    COMPARE_GT, 850,  10.0, 0.5, STATE_BIT_STARTING, RULE_EGTS_ANY, false },
+    { OVER_TEMP4, SIGNAL_T,    COMPARE_GT, 1100, 0,    0,   STATE_BIT_RUNNING,  RULE_EGTS_ANY, true },
+    { OVER_TEMP3, SIGNAL_T,    COMPARE_GT, 950,  10.0, 0.5, STATE_BIT_RUNNING,  RULE_EGTS_ANY, false },
+    { OVER_FF,    SIGNAL_FF,   COMPARE_GT, 50,   0.5,  0.5, STATE_BIT_ANY,      0,             false },
+    { LOW_FUEL,   SIGNAL_FUEL, COMPARE_LE, 0,    0,    0,   STATE_BIT_STARTING | STATE_BIT_RUNNING, RULE_FUELS, true },
+    { LOW_FUEL,   SIGNAL_FUEL, COMPARE_LT, 1000, 0,    0,   STATE_BIT_STARTING | STATE_BIT_RUNNING, RULE_FUELS, false },
+};
+static_assert(sizeof(g_filteredFaultRules) / sizeof(g_filteredFaultRules[0]) == FAULT_RULE_COUNT,
+    "both rule tables share the rule state");
+
+// 结构数组形式的输入，长度须为 SIMD 宽度的整数倍
+struct FaultRuleInputs {
+    const double* N1;
+    const double* T;
+    const double* FF;
+    const double* fuel;
+    const int32_t* state;   // EngineState
+    const int32_t* sensors; // RuleSensorBits
+};
+
+// 规则状态：ruleBits 第 r 位为第 r 条规则已确认（锁存）；timers[r] 为其确认计时（秒）
+struct FaultRuleState {
+    int32_t* ruleBits;
+    double* timers[SIM_MAX_FAULT_RULES];
+};
+
+// 结果：故障位（1 << FaultType）与需要停车的发动机
+struct FaultRuleOutputs {
+    int32_t* faultBits;
+    int32_t* shutdown; // 非 0 为本次有停车规则成立
+};
+
+// 发动机状态是否属于 States（编译期展开，只比较表中出现的状态）
+template <class V, uint32_t States>
+static inline typename V::Mask ruleStateMask(V state) {
+    typedef typename V::Mask M;
+    constexpr int first = (States & 1) ? 0 : (States & 2) ? 1 : (States & 4) ? 2 : 3;
+    M m = state == V((double)first);
+    if constexpr (first < 1 && (States & 2)) m = V::maskOr(m, state == V(1.0));
+    if constexpr (first < 2 && (States & 4)) m = V::maskOr(m, state == V(2.0));
+    if constexpr (first < 3 && (States & 8)) m = V::maskOr(m, state == V(3.0));
+    return m;
+}
+
+template <class V, const FaultRule* Rules, size_t R>
+static inline typename V::Mask evaluateFaultRule(const FaultRuleInputs& in, FaultRuleState& st, size_t i, V vdt) {
+    typedef typename V::Mask M;
+    constexpr const FaultRule& rule = Rules[R];
+
+    V value = V::load(rule.signal == SIGNAL_N1 ? &in.N1[i] : rule.signal == SIGNAL_T ? &in.T[i]
+        : rule.signal == SIGNAL_FF ? &in.FF[i] : &in.fuel[i]);
+    const V thr(rule.threshold);
+    M exceed = rule.compare == COMPARE_GT ? value > thr : rule.compare == COMPARE_LT ? value < thr : value <= thr;
+
+    // 状态与传感器屏蔽
+    M applies = V::maskNot(V::testBits(&in.sensors[i], rule.inhibit));
+    if constexpr (rule.states != STATE_BIT_ANY) {
+        applies = V::maskAnd(applies, ruleStateMask<V, rule.states>(V::loadInt32(&in.state[i])));
+    }
+    exceed = V::maskAnd(exceed, applies);
+
+    // 确认时间：持续超限的时间达到 confirmSeconds 才成立
+    M confirmed = exceed;
+    if constexpr (rule.confirmSeconds > 0) {
+        V timer = V::select(exceed, V::load(&st.timers[R][i]) + vdt, V(0.0));
+        timer.store(&st.timers[R][i]);
+        confirmed = V::maskAnd(exceed, timer >= V(rule.confirmSeconds));
+    }
+
+    // 回差：已锁存的规则在越过 阈值∓回差 之前保持
+    if constexpr (rule.hysteresis > 0) {
+        M was = V::testBits(&st.ruleBits[i], (int32_t)(1u << R));
+        M hold = rule.compare == COMPARE_GT ? value > V(rule.threshold - rule.hysteresis)
+            : value < V(rule.threshold + rule.hysteresis);
+        return V::maskOr(confirmed, V::maskAnd(V::maskAnd(was, hold), applies));
+    }
+    return confirmed;
+}
+
+// 第 R 条规则是否是其故障位的第一条（编译期）
+template <const FaultRule* Rules, size_t R>
+constexpr bool firstRuleOfFault() {
+    for (size_t k = 0; k < R; k++) {
+        if (Rules[k].fault == Rules[R].fault) return false;
+    }
+    return true;
+}
+
+// 第 K 条规则与所有同故障位的后续规则取或（编译期选出参与的规则）
+template <class V, const FaultRule* Rules, size_t K, size_t N, size_t... R>
+static inline typename V::Mask faultMask(const typename V::Mask (&latched)[N], std::index_sequence<R...>) {
+    typename V::Mask m = latched[K];
+    ((m = (R > K && Rules[R].fault == Rules[K].fault) ? V::maskOr(m, latched[R]) : m), ...);
+    return m;
+}
+
+template <class V, const FaultRule* Rules, size_t... R>
+static inline void evaluateFaultRuleSet(const FaultRuleInputs& in, FaultRuleState& st, FaultRuleOutputs& out,
+    size_t n, double dt, std::index_sequence<R...>) {
+    typedef typename V::Mask M;
+    constexpr size_t N = sizeof...(R);
+    const V vdt(dt), zero(0.0), one(1.0);
+    for (size_t i = 0; i < n; i += V::WIDTH) {
+        M latched[N] = { evaluateFaultRule<V, Rules, R>(in, st, i, vdt)... };
+
+        V ruleBits = zero, faultBits = zero, shutdown = zero;
+        ((ruleBits = ruleBits + V::select(latched[R], V((double)(1u << R)), zero)), ...);
+        ((shutdown = Rules[R].shutdown ? V::select(latched[R], one, shutdown) : shutdown), ...);
+        // 同一故障位的多条规则先取或，再累加到故障位
+        auto addFault = [&](auto r) {
+            constexpr size_t k = decltype(r)::value;
+            if constexpr (firstRuleOfFault<Rules, k>()) {
+                M m = faultMask<V, Rules, k>(latched, std::index_sequence<R...>());
+                faultBits = faultBits + V::select(m, V((double)(1u << Rules[k].fault)), zero);
+            }
+        };
+        (addFault(std::integral_constant<size_t, R>()), ...);
+
+        ruleBits.storeInt32(&st.ruleBits[i]);
+        faultBits.storeInt32(&out.faultBits[i]);
+        shutdown.storeInt32(&out.shutdown[i]);
+    }
+}
+
+// 对 n 台发动机执行整张规则表，无分支；filtered 选用滤波告警表
+template <class V>
+inline void evaluateFaultRules(const FaultRuleInputs& in, FaultRuleState& st, FaultRuleOutputs& out, size_t n, double dt,
+    bool filtered = false) {
+    if (filtered) evaluateFaultRuleSet<V, g_filteredFaultRules>(in, st, out, n, dt, std::make_index_sequence<FAULT_RULE_COUNT>());
+    else evaluateFaultRuleSet<V, g_faultRules>(in, st, out, n, dt, std::make_index_sequence<FAULT_RULE_COUNT>());
+}
@@ -0,0 +1,67 @@
+﻿#include "fixed_step.h"
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+FixedStepScheduler::FixedStepScheduler(double stepSeconds, double frameSeconds, int maxTicksPerFrame)
+    : m_step(stepSeconds), m_frame(frameSeconds), m_maxTicks(maxTicksPerFrame), m_spin(0.002) {
+    reset();
+}
+
+void FixedStepScheduler::reset() {
+    m_accum = 0;
+    m_lastFrame = 0;
+    m_started = false;
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void FixedStepScheduler::waitUntil(Clock::time_point t) {
+    // 睡眠精度受系统定时器限制，留出 m_spin 用自旋补足
+    auto margin = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_spin));
+    Clock::time_point now = Clock::now();
+    if (t - now > margin) std::this_thread::sleep_for(t - now - margin);
+    while (Clock::now() < t) std::this_thread::yield();
+}
+
+int FixedStepScheduler::waitFrame() {
+    auto frame = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_frame));
+    if (!m_started) {
+        m_started = true;
+        m_last = Clock::now();
+        m_nextFrame = m_last + frame;
+        return 0;
+    }
+
+    waitUntil(m_nextFrame);
+    Clock::time_point wake = Clock::now();
+
+    // 唤醒抖动与错过的截止时刻
+    double lateUs = std::chrono::duration<double, std::micro>(wake - m_nextFrame).count();
+    double absLate = fabs(lateUs);
+    m_stats.frames++;
+    m_stats.jitterMeanUs += (absLate - m_stats.jitterMeanUs) / m_stats.frames;
+    if (absLate > m_stats.jitterMaxUs) m_stats.jitterMaxUs = absLate;
+    if (lateUs > m_frame * 1e6) {
+        // 落后超过一帧：不再补帧，从当前时刻重新排期
+        m_stats.missedDeadlines++;
+        m_nextFrame = wake + frame;
+    }
+    else {
+        m_nextFrame += frame;
+    }
+
+    m_lastFrame = std::chrono::duration<double>(wake - m_last).count();
+    m_last = wake;
+    m_accum += m_lastFrame;
+    int ticks = (int)(m_accum / m_step);
+    if (ticks > m_maxTicks) {
+        m_stats.droppedTicks += ticks - m_maxTicks;
+        ticks = m_maxTicks;
+        m_accum = fmod(m_accum, m_step);
+    }
+    else {
+        m_accum -= ticks * m_step;
+    }
+    m_stats.ticks += ticks;
+    return ticks;
+}
@@ -0,0 +1,51 @@
+﻿#pragma once
+// 固定步长调度：物理按固定频率推进，渲染按显示频率，二者解耦
+//
+// 每帧先混合等待（先睡眠到截止前 spinMargin，再自旋到截止时刻）以减小唤醒抖动，
+// 再把实际经过的时间累加进 accumulator，按固定步长切成若干物理步；
+// 剩余不足一步的部分以 alpha() 给出，用于在前后两步之间插值绘制。
+#include <chrono>
+#include <cstdint>
+
+struct FixedStepStats {
+    uint64_t frames;
+    uint64_t ticks;
+    uint64_t missedDeadlines; // 唤醒晚于计划时刻超过一帧
+    uint64_t droppedTicks;    // 落后过多而放弃追赶的物理步
+    double jitterMeanUs;      // 唤醒时刻与计划时刻之差（绝对值）的平均
+    double jitterMaxUs;
+};
+
+class FixedStepScheduler {
+public:
+    // stepSeconds: 物理步长；frameSeconds: 帧周期；maxTicksPerFrame: 单帧最多追赶的步数
+    explicit FixedStepScheduler(double stepSeconds = 0.001, double frameSeconds = 1.0 / 60, int maxTicksPerFrame = 250);
+
+    // 等到下一帧，返回本帧应执行的物理步数
+    int waitFrame();
+    void reset();
+
+    double stepSeconds() const { return m_step; }
+    // 上一帧的实际间隔（秒）
+    double frameSeconds() const { return m_lastFrame; }
+    // 插值系数 [0, 1)：当前时刻位于最后一步之后的比例
+    double alpha() const { return m_accum / m_step; }
+    const FixedStepStats& stats() const { return m_stats; }
+    // 睡眠与自旋的分界，默认 2ms（约为系统定时器粒度）
+    void setSpinMargin(double seconds) { m_spin = seconds; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    void waitUntil(Clock::time_point t);
+
+    double m_step;
+    double m_frame;
+    int m_maxTicks;
+    double m_spin;
+    double m_accum;
+    double m_lastFrame;
+    bool m_started;
+    Clock::time_point m_last;
+    Clock::time_point m_nextFrame;
+    FixedStepStats m_stats;
+};
@@ -0,0 +1,290 @@
+﻿#include "fleet.h"
+#include "simd_vec.h"
+#include "fault_rules.h"
+#include "philox.h"
+#include <cmath>
+
+static_assert((int)FLEET_N1S1 == RULE_N1S1 && (int)FLEET_N1S2 == RULE_N1S2 && (int)FLEET_EGTS1 == RULE_EGTS1
+    && (int)FLEET_EGTS2 == RULE_EGTS2 && (int)FLEET_FUELS == RULE_FUELS, "sensor bits are shared with the rule table");
+
+// 与 rand() % 3 - 1 相同的 {-1,0,1}
+static inline double noise3(uint32_t r) {
+    return (double)(philoxRand15(r) % 3 - 1);
+}
+
+// 与 (rand() % 201 - 100) / 100.0 相同的 [-1,1]
+static inline double noise201(uint32_t r) {
+    return (philoxRand15(r) % 201 - 100) / 100.0;
+}
+
+void fleetInit(EngineFleet& f, size_t count, uint32_t seed) {
+    size_t cap = (count + 7) & ~(size_t)7; // 按最宽的 8 路补齐
+    f.count = count;
+    f.capacity = cap;
+    f.now = 0;
+    f.seed = seed;
+    f.tick = 0;
+
+    f.N1.assign(cap, 0.0);
+    f.T.assign(cap, 20.0);
+    f.FF.assign(cap, 0.0);
+    f.targetN1.assign(cap, 0.0);
+    f.targetT.assign(cap, 0.0);
+    f.targetFF.assign(cap, 0.0);
+    f.fuel.assign(cap, 3000.0);
+    f.egtBase.assign(cap, 20.0);
+    f.egtDelta.assign(cap, 0.0);
+    f.initialN1.assign(cap, 0.0);
+    f.initialT.assign(cap, 0.0);
+    f.startTime.assign(cap, 0.0);
+    f.stopTime.assign(cap, 0.0);
+    f.startEgtGain.assign(cap, 900.0);
+    f.state.assign(cap, ENGINE_OFF);
+    f.thrustAdjust.assign(cap, 0);
+    f.sensorFail.assign(cap, 0);
+
+    f.noiseWalk.assign(cap, 0.0);
+    f.noiseN1.assign(cap, 0.0);
+    f.noiseFF.assign(cap, 0.0);
+    f.noiseT.assign(cap, 0.0);
+    f.noiseRate.assign(cap, 0.0);
+    for (int k = 0; k < 4; k++) f.rngBits[k].assign(cap, 0);
+
+    f.faultBits.assign(cap, 0);
+    f.ruleBits.assign(cap, 0);
+    f.shutdown.assign(cap, 0);
+    for (size_t r = 0; r < FAULT_RULE_COUNT; r++) f.ruleTimers[r].assign(cap, 0.0);
+}
+
+// 所有发动机按规则表判断故障；停车规则成立的发动机停车
+static void fleetCheckFaults(EngineFleet& f, double dt) {
+    FaultRuleInputs in = { f.N1.data(), f.T.data(), f.FF.data(), f.fuel.data(), f.state.data(), f.sensorFail.data() };
+    FaultRuleState rs;
+    rs.ruleBits = f.ruleBits.data();
+    for (size_t r = 0; r < SIM_MAX_FAULT_RULES; r++) rs.timers[r] = r < FAULT_RULE_COUNT ? f.ruleTimers[r].data() : nullptr;
+    FaultRuleOutputs out = { f.faultBits.data(), f.shutdown.data() };
+    evaluateFaultRules<VecD>(in, rs, out, f.capacity, dt);
+
+    for (size_t i = 0; i < f.count; i++) {
+        if (f.shutdown[i] && (f.state[i] == ENGINE_STARTING || f.state[i] == ENGINE_RUNNING)) fleetStop(f, i);
+    }
+}
+
+// 生成本 tick 所有发动机的噪声：发动机 i 取计数器 (tick, 0, SIM_RNG_PANEL) 下密钥 (seed, i) 的一组 4 个数。
+// 非标定步长时 EGT 基准值按 egtWalkStep 的 n 步转移推进，其相关噪声另取计数器 (tick, 1, SIM_RNG_PANEL) 的一组
+static void fleetNoise(EngineFleet& f, const EgtWalkStep* w) {
+    uint32_t* r0 = f.rngBits[0].data();
+    uint32_t* r1 = f.rngBits[1].data();
+    uint32_t* r2 = f.rngBits[2].data();
+    uint32_t* r3 = f.rngBits[3].data();
+    philoxBatch(f.seed, 0, f.capacity, (uint32_t)f.tick, (uint32_t)(f.tick >> 32), 0, SIM_RNG_PANEL, r0, r1, r2, r3);
+
+    double* nw = f.noiseWalk.data();
+    double* nn = f.noiseN1.data();
+    double* nf = f.noiseFF.data();
+    double* nt = f.noiseT.data();
+    for (size_t i = 0; i < f.capacity; i++) {
+        nw[i] = noise201(r0[i]) * 0.005;
+        nn[i] = noise3(r1[i]);
+        nf[i] = noise3(r2[i]);
+        nt[i] = noise3(r3[i]);
+    }
+    if (!w) return;
+
+    philoxBatch(f.seed, 0, f.capacity, (uint32_t)f.tick, (uint32_t)(f.tick >> 32), 1, SIM_RNG_PANEL, r0, r1, r2, r3);
+    double* nr = f.noiseRate.data();
+    for (size_t i = 0; i < f.capacity; i++) {
+        double z0, z1;
+        philoxNormal2(r0[i], r1[i], z0, z1);
+        nw[i] = w->l11 * z0;
+        nr[i] = w->l21 * z0 + w->l22 * z1;
+    }
+}
+
+// 一个 tick 的无分支内核：各状态分支都计算，再按状态掩码选择。
+// 与 updateData 相同，按经过的标定步数 n 计算：逼近目标按 1 - 0.9^n，随机游走增量按 sqrt(n) 缩放；
+// w 为空表示标定步长，EGT 基准值按原来的离散更新
+template <class V>
+static void fleetKernel(EngineFleet& f, double dt, const EgtWalkStep* w) {
+    typedef typename V::Mask M;
+    const double n = dt / SIM_REFERENCE_DT;
+    const V now(f.now / 1e6);
+    const V vdt(dt);
+    const V zero(0.0), one(1.0);
+    const V walk(sqrt(n));
+    const V smoothing(1 - pow(0.9, n));
+    // 对数上升段在 n1 = 95 处交给稳态段，大步长时不越过该点
+    const V xRun(pow(10.0, 18000.0 / 23000.0) * (1 + 1e-9));
+    const V stOff((double)ENGINE_OFF), stStarting((double)ENGINE_STARTING);
+    const V stRunning((double)ENGINE_RUNNING), stStopping((double)ENGINE_STOPPING);
+    const V invLog5(1.0 / 0.69897000433601880479); // 1/log10(5)
+
+    for (size_t i = 0; i < f.capacity; i += V::WIDTH) {
+        V n1 = V::load(&f.N1[i]);
+        V T = V::load(&f.T[i]);
+        V ff = V::load(&f.FF[i]);
+        V st = V::loadInt32(&f.state[i]);
+        V thr = V::loadInt32(&f.thrustAdjust[i]);
+        V nN1 = V::load(&f.noiseN1[i]);
+        V nFF = V::load(&f.noiseFF[i]);
+        V nT = V::load(&f.noiseT[i]);
+
+        // EGT 表盘基准值随机游走
+        V delta, value;
+        if (!w) {
+            delta = V::load(&f.egtDelta[i]) + V::load(&f.noiseWalk[i]);
+            value = V::load(&f.egtBase[i]) + delta;
+            delta = delta * V(0.9);
+            value = value + (V(20.0) - value) * V(0.05);
+        }
+        else {
+            V v = V::load(&f.egtBase[i]) - V(20.0);
+            V d = V::load(&f.egtDelta[i]);
+            value = V(20.0) + (V(w->a) * v + V(w->c) * d) + V::load(&f.noiseWalk[i]);
+            delta = V(w->b) * d + V::load(&f.noiseRate[i]);
+        }
+        value = V::min(V::max(value, V(18.5)), V(21.5));
+        delta.store(&f.egtDelta[i]);
+        value.store(&f.egtBase[i]);
+
+        M isOff = st == stOff;
+        M isStarting = st == stStarting;
+        M isRunning = st == stRunning;
+        M isStopping = st == stStopping;
+
+        // 启动：线性增加阶段
+        M linear = n1 < V(50.0);
+        V n1Lin = n1 + V(10000.0 / 40000 * 100) * vdt + nN1 * V(0.3) * walk;
+        V ffLin = ff + V(5.0) * vdt;
+
+        // 启动：对数上升阶段
+        V x = V::min(now - V::load(&f.startTime[i]) - one, xRun);
+        V lx = vecLog10(V::max(x, one));
+        V vff = V::min(V::max(V(42.0) * lx + V(10.0), zero), V(50.0));
+        V n1Log = (V(23000.0) * lx + V(20000.0)) / V(400.0);
+        V tLog = V::load(&f.startEgtGain[i]) * lx + V(20.0);
+        M toRunning = V::maskAnd(V::maskAnd(isStarting, V::maskNot(linear)), n1Log > V(95.0));
+
+        V n1Start = V::select(linear, n1Lin, n1Log + nN1 * V(0.3));
+        V ffStart = V::select(linear, ffLin, vff + nFF * V(0.03));
+        V tStart = V::select(linear, value, tLog + nT * V(0.3));
+
+        // 稳态：随机波动或平滑逼近目标值
+        M adjusting = V::maskNot(thr == zero);
+        V tn1 = V::load(&f.targetN1[i]);
+        V tff = V::load(&f.targetFF[i]);
+        V tT = V::load(&f.targetT[i]);
+        V n1Run = V::select(adjusting, n1 + (tn1 - n1) * smoothing, n1 + nN1 * V(0.05) * walk);
+        V ffRun = V::select(adjusting, ff + (tff - ff) * smoothing, ff + nFF * V(0.05) * walk);
+        V tRun = V::select(adjusting, T + (tT - T) * smoothing, T + nT * V(0.5) * walk);
+        M settled = V::maskAnd(V::maskAnd(V::abs(tff - ffRun) < V(0.01), V::abs(tn1 - n1Run) < V(0.01)),
+            V::abs(tT - tRun) < V(0.01));
+
+        // 停车：对数衰减
+        V elapsed = now - V::load(&f.stopTime[i]);
+        V logFactor = V::min(vecLog10(V::max(elapsed, zero) + one) * invLog5, one); // 大步长时不越过终值
+        V n1Stop = V::load(&f.initialN1[i]) * (one - logFactor);
+        V tStop = V(20.0) + (V::load(&f.initialT[i]) - V(20.0)) * (one - logFactor);
+        M toOff = V::maskAnd(isStopping, n1Stop <= one);
+
+        n1 = V::select(isOff, zero, V::select(isStarting, n1Start, V::select(isRunning, n1Run, n1Stop)));
+        ff = V::select(isOff, zero, V::select(isStarting, ffStart, V::select(isRunning, ffRun, zero)));
+        T = V::select(isOff, value, V::select(isStarting, tStart, V::select(isRunning, tRun, tStop)));
+        st = V::select(toRunning, stRunning, V::select(toOff, stOff, st));
+        M clearThrust = V::maskOr(V::maskOr(isOff, isStopping), V::maskAnd(isRunning, V::maskAnd(adjusting, settled)));
+        thr = V::select(clearThrust, zero, thr);
+
+        // 燃油余量：未关车且油量传感器正常时消耗
+        M burn = V::maskAnd(V::maskNot(st == stOff), V::maskNot(V::testBits(&f.sensorFail[i], FLEET_FUELS)));
+        V fuel = V::load(&f.fuel[i]);
+        fuel = V::select(burn, V::max(fuel - ff * vdt, zero), fuel);
+
+        n1.store(&f.N1[i]);
+        T.store(&f.T[i]);
+        ff.store(&f.FF[i]);
+        fuel.store(&f.fuel[i]);
+        st.storeInt32(&f.state[i]);
+        thr.storeInt32(&f.thrustAdjust[i]);
+    }
+}
+
+void fleetStep(EngineFleet& f, double dt) {
+    SimTime step = (SimTime)llround(dt * 1e6);
+    f.now += step;
+    f.tick++;
+    double n = step / 1e6 / SIM_REFERENCE_DT;
+    EgtWalkStep w;
+    if (n != 1.0) egtWalkStep(n, w);
+    fleetNoise(f, n != 1.0 ? &w : nullptr);
+    fleetKernel<VecD>(f, step / 1e6, n != 1.0 ? &w : nullptr);
+    fleetCheckFaults(f, step / 1e6);
+}
+
+const char* fleetKernelName() {
+#if defined(__AVX512F__)
+    return "AVX-512";
+#elif defined(__AVX2__)
+    return "AVX2";
+#else
+    return "scalar";
+#endif
+}
+
+void fleetStart(EngineFleet& f, size_t i) {
+    if (f.state[i] != ENGINE_OFF) return;
+    f.state[i] = ENGINE_STARTING;
+    f.startTime[i] = f.now / 1e6;
+}
+
+void fleetStop(EngineFleet& f, size_t i) {
+    f.state[i] = ENGINE_STOPPING;
+    f.thrustAdjust[i] = 0;
+    f.initialN1[i] = f.N1[i];
+    f.initialT[i] = f.T[i];
+    f.stopTime[i] = f.now / 1e6;
+}
+
+void fleetThrust(EngineFleet& f, size_t i, int dir) {
+    if (f.state[i] != ENGINE_RUNNING || dir == 0) return;
+    Philox4x32 r = philox4x32((uint32_t)f.tick, (uint32_t)(f.tick >> 32), 0, SIM_RNG_CONTROL, f.seed, (uint32_t)i);
+    double k1 = philoxRand15(r.v[0]) % 3 * 0.01;
+    double k2 = philoxRand15(r.v[1]) % 3 * 0.01;
+    f.thrustAdjust[i] = dir > 0 ? 1 : -1;
+    if (dir > 0) {
+        f.targetN1[i] = f.N1[i] * (1.03 + k1); // 目标转速增加3%-5%
+        f.targetFF[i] = f.FF[i] + 1;
+        f.targetT[i] = f.T[i] * (1.03 + k2);
+    }
+    else {
+        f.targetN1[i] = f.N1[i] * (0.97 - k1); // 目标转速减少3%-5%
+        f.targetFF[i] = f.FF[i] - 1;
+        f.targetT[i] = f.T[i] * (0.97 - k2);
+    }
+}
+
+void fleetSetSensorFail(EngineFleet& f, size_t i, int32_t bits, bool fail) {
+    if (fail) f.sensorFail[i] |= bits;
+    else f.sensorFail[i] &= ~bits;
+}
+
+// 与 simSetFault 对应的单台发动机故障注入
+void fleetSetFault(EngineFleet& f, size_t i, FaultType ft, bool active) {
+    switch (ft) {
+    case N1S1_FAIL: fleetSetSensorFail(f, i, FLEET_N1S1, active); break;
+    case N1S2_FAIL:
+    case N1S_FAIL: fleetSetSensorFail(f, i, FLEET_N1S1 | FLEET_N1S2, active); break;
+    case EGTS1_FAIL: fleetSetSensorFail(f, i, FLEET_EGTS1, active); break;
+    case EGTS2_FAIL:
+    case EGTS_FAIL: fleetSetSensorFail(f, i, FLEET_EGTS1 | FLEET_EGTS2, active); break;
+    case FUELS_FAIL: fleetSetSensorFail(f, i, FLEET_FUELS, active); break;
+    case LOW_FUEL: f.fuel[i] = active ? 998 : 3000; break;
+    case OVER_FF: f.FF[i] = active ? 52 : 40; break;
+    case OVER_SPD1: f.N1[i] = active ? 107 : 95; break;
+    case OVER_SPD2: f.N1[i] = active ? 122 : 95; break;
+    case OVER_TEMP1: f.startEgtGain[i] = active ? 1170 : 900; if (!active) f.T[i] = 730; break;
+    case OVER_TEMP2: f.startEgtGain[i] = active ? 1500 : 900; if (!active) f.T[i] = 730; break;
+    case OVER_TEMP3: f.T[i] = active ? 952 : 730; break;
+    case OVER_TEMP4: f.T[i] = active ? 1102 : 730; break;
+    default: break;
+    }
+}
@@ -0,0 +1,74 @@
+﻿#pragma once
+// 机队模式：以结构数组(SoA)保存 N 台发动机，每个 tick 用 SIMD 批量推进
+#include "sim_core.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// 64 字节对齐分配器，保证整行缓存与对齐向量访问
+template <class T>
+struct AlignedAllocator {
+    typedef T value_type;
+    AlignedAllocator() {}
+    template <class U> AlignedAllocator(const AlignedAllocator<U>&) {}
+    T* allocate(size_t n) { return (T*)::operator new(n * sizeof(T), std::align_val_t(64)); }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(64)); }
+    template <class U> bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <class U> bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+typedef std::vector<double, AlignedAllocator<double> > FleetDoubles;
+typedef std::vector<int32_t, AlignedAllocator<int32_t> > FleetInts;
+
+// 传感器故障位
+enum FleetSensorBits {
+    FLEET_N1S1 = 1,
+    FLEET_N1S2 = 2,
+    FLEET_EGTS1 = 4,
+    FLEET_EGTS2 = 8,
+    FLEET_FUELS = 16
+};
+
+// N 台独立发动机，每台有自己的状态机和油箱
+struct EngineFleet {
+    size_t count;     // 发动机数量
+    size_t capacity;  // 按 SIMD 宽度补齐后的数组长度
+    SimTime now;
+    uint32_t seed;
+    uint64_t tick;
+
+    FleetDoubles N1, T, FF;
+    FleetDoubles targetN1, targetT, targetFF;
+    FleetDoubles fuel;
+    FleetDoubles egtBase, egtDelta;   // EGT 基准值随机游走
+    FleetDoubles initialN1, initialT; // 停止时的起点
+    FleetDoubles startTime, stopTime; // 秒
+    FleetDoubles startEgtGain;        // 启动对数段温度系数 900/1170/1500
+    FleetInts state;                  // EngineState
+    FleetInts thrustAdjust;           // -1/0/1
+    FleetInts sensorFail;             // FleetSensorBits
+
+    // 故障规则（fault_rules.h）：每步在内核之后批量判断
+    FleetInts faultBits;              // 1 << FaultType
+    FleetInts ruleBits;               // 已锁存的规则
+    FleetInts shutdown;               // 本步有停车规则成立
+    FleetDoubles ruleTimers[SIM_MAX_FAULT_RULES];
+
+    // 每个 tick 预先生成的噪声；随机数按 (seed, 发动机编号, tick) 计算，见 philox.h
+    FleetDoubles noiseWalk, noiseN1, noiseFF, noiseT;
+    FleetDoubles noiseRate;           // 非标定步长时 EGT 基准值速率的噪声
+    std::vector<uint32_t, AlignedAllocator<uint32_t> > rngBits[4];
+};
+
+void fleetInit(EngineFleet& fleet, size_t count, uint32_t seed);
+// 所有发动机推进 dt 秒
+void fleetStep(EngineFleet& fleet, double dt);
+// 当前编译使用的内核（"AVX-512" / "AVX2" / "scalar"）
+const char* fleetKernelName();
+
+// 单台发动机的控制输入
+void fleetStart(EngineFleet& fleet, size_t i);
+void fleetStop(EngineFleet& fleet, size_t i);
+void fleetThrust(EngineFleet& fleet, size_t i, int dir);
+void fleetSetSensorFail(EngineFleet& fleet, size_t i, int32_t bits, bool fail);
+void fleetSetFault(EngineFleet& fleet, size_t i, FaultType ft, bool active);
@@ -0,0 +1,307 @@
+﻿// 无界面命令行仿真：以 CPU 允许的最快速度运行 STARTING/RUNNING/STOPPING 状态机
+#include "sim_core.h"
+#include "checkpoint.h"
+#include "fleet.h"
+#include "fixed_step.h"
+#include "query_server.h"
+#include "scenario.h"
+#include "telemetry.h"
+#include "telemetry_bus.h"
+#include "telemetry_writer.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+static void printUsage(const char* prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --dt <s>        physics step in seconds (default 0.005)\n");
+    printf("  --start <s>     press START at this sim time (default 0)\n");
+    printf("  --stop <s>      press STOP at this sim time (default 600)\n");
+    printf("  --end <s>       end of simulation (default: stop + 10)\n");
+    printf("  --seed <n>      random seed (default: time, or the scenario's seed)\n");
+    printf("  --engines <n>   number of engines, 1-4 (default 2)\n");
+    printf("  --tanks <n>     number of fuel tanks, engines split evenly between them (default 1)\n");
+    printf("  --cross-feed    every engine draws from the fullest tank\n");
+    printf("  --filtered-alerts  warnings need 0.5 s above the limit and clear below limit - hysteresis\n");
+    printf("  --scenario <f>  run the timed commands in a scenario script instead of --start/--stop\n");
+    printf("  --data <file>   data output (default data.csv)\n");
+    printf("  --log <file>    fault log output (default log.txt)\n");
+    printf("  --no-output     do not write data/log files\n");
+    printf("  --flush-ms <n>  max latency before buffered output is written and synced to disk (default 100)\n");
+    printf("  --drop          drop records when the writer falls behind instead of waiting\n");
+    printf("  --sync-output   write through std::ofstream on the simulation thread\n");
+    printf("  --format <f>    csv (default) or tlm (binary columnar, faults stored inline)\n");
+    printf("  --raw           store tlm columns uncompressed\n");
+    printf("  --bus <name>    also publish every record to a shared-memory telemetry bus (see bus_tail)\n");
+    printf("  --listen <path> serve state queries and commands on a Unix socket (Linux); without\n");
+    printf("                  --start/--stop the engine is only started and stopped by clients\n");
+    printf("  --fleet <n>     step n independent engines in SoA/SIMD fleet mode\n");
+    printf("  --fast-forward <s> jump to this sim time analytically before stepping\n");
+    printf("  --save-checkpoint <s> <file>  save the whole simulation state at this sim time\n");
+    printf("  --restore <file> resume from a saved checkpoint; script commands before its time are skipped\n");
+    printf("  --realtime      pace physics to the wall clock (fixed step, 60 Hz frames)\n");
+    printf("  --trace <file>  write Chrome trace JSON of the step phases (build with -DENGINE_TRACE)\n");
+}
+
+// 机队模式：所有发动机同时启动、停车，统计吞吐量
+static int runFleet(size_t count, double dt, double startAt, double stopAt, double endAt, unsigned seed) {
+    EngineFleet fleet;
+    fleetInit(fleet, count, seed);
+
+    SimTime startUs = (SimTime)(startAt * 1e6);
+    SimTime stopUs = (SimTime)(stopAt * 1e6);
+    SimTime endUs = (SimTime)(endAt * 1e6);
+    bool started = false, stopped = false;
+    long long ticks = 0;
+
+    auto wallStart = std::chrono::steady_clock::now();
+    while (fleet.now < endUs) {
+        if (!started && fleet.now >= startUs) {
+            for (size_t i = 0; i < count; i++) fleetStart(fleet, i);
+            started = true;
+        }
+        if (!stopped && fleet.now >= stopUs) {
+            for (size_t i = 0; i < count; i++) fleetStop(fleet, i);
+            stopped = true;
+        }
+        fleetStep(fleet, dt);
+        ticks++;
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    double fuel = 0;
+    for (size_t i = 0; i < count; i++) fuel += fleet.fuel[i];
+    printf("kernel=%s engines=%zu ticks=%lld wall=%.3fs engine-ticks/s=%.3g mean-fuel=%.1f\n",
+        fleetKernelName(), count, ticks, wall, wall > 0 ? ticks * (double)count / wall : 0.0,
+        count ? fuel / count : 0.0);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    double dt = 0.005;
+    double startAt = 0, stopAt = 600, endAt = -1;
+    unsigned seed = (unsigned)time(NULL);
+    const char* dataPath = "data.csv";
+    const char* logPath = "log.txt";
+    bool output = true;
+    bool syncOutput = false;
+    AsyncWriterOptions writerOpt;
+    long fleetSize = 0;
+    bool realtime = false;
+    double fastForward = 0;
+    const char* tracePath = nullptr;
+    const char* scenarioPath = nullptr;
+    const char* busName = nullptr;
+    double checkpointAt = -1;
+    const char* checkpointPath = nullptr;
+    const char* restorePath = nullptr;
+    const char* listenPath = nullptr;
+    bool startStopGiven = false;
+    bool seedGiven = false;
+    int engines = 0, tanks = 0; // 0 为脚本中的值（默认双发单油箱）
+    bool crossFeed = false;
+    bool filteredAlerts = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--dt") && hasValue) dt = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--start") && hasValue) {
+            startAt = atof(argv[++i]);
+            startStopGiven = true;
+        }
+        else if (!strcmp(argv[i], "--stop") && hasValue) {
+            stopAt = atof(argv[++i]);
+            startStopGiven = true;
+        }
+        else if (!strcmp(argv[i], "--end") && hasValue) endAt = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && hasValue) {
+            seed = (unsigned)strtoul(argv[++i], NULL, 10);
+            seedGiven = true;
+        }
+        else if (!strcmp(argv[i], "--engines") && hasValue) engines = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--tanks") && hasValue) tanks = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--cross-feed")) crossFeed = true;
+        else if (!strcmp(argv[i], "--filtered-alerts")) filteredAlerts = true;
+        else if (!strcmp(argv[i], "--scenario") && hasValue) scenarioPath = argv[++i];
+        else if (!strcmp(argv[i], "--data") && hasValue) dataPath = argv[++i];
+        else if (!strcmp(argv[i], "--log") && hasValue) logPath = argv[++i];
+        else if (!strcmp(argv[i], "--no-output")) output = false;
+        else if (!strcmp(argv[i], "--flush-ms") && hasValue) writerOpt.maxLatencyMs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--drop")) writerOpt.dropWhenFull = true;
+        else if (!strcmp(argv[i], "--sync-output")) syncOutput = true;
+        else if (!strcmp(argv[i], "--format") && hasValue) writerOpt.binary = !strcmp(argv[++i], "tlm");
+        else if (!strcmp(argv[i], "--raw")) writerOpt.compress = false;
+        else if (!strcmp(argv[i], "--bus") && hasValue) busName = argv[++i];
+        else if (!strcmp(argv[i], "--listen") && hasValue) listenPath = argv[++i];
+        else if (!strcmp(argv[i], "--fleet") && hasValue) fleetSize = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--realtime")) realtime = true;
+        else if (!strcmp(argv[i], "--fast-forward") && hasValue) fastForward = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--save-checkpoint") && i + 2 < argc) {
+            checkpointAt = atof(argv[++i]);
+            checkpointPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--restore") && hasValue) restorePath = argv[++i];
+        else if (!strcmp(argv[i], "--trace") && hasValue) tracePath = argv[++i];
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (endAt < 0) endAt = stopAt + 10;
+    if (writerOpt.binary) syncOutput = false;
+    if (dt <= 0) {
+        fprintf(stderr, "dt must be positive\n");
+        return 1;
+    }
+
+    if (fleetSize > 0) return runFleet((size_t)fleetSize, dt, startAt, stopAt, endAt, seed);
+
+    // 控制输入统一走命令队列：脚本，或由 --start/--stop 生成的两条命令
+    Scenario scenario;
+    if (scenarioPath) {
+        std::string error;
+        if (!scenarioLoad(scenarioPath, scenario, error)) {
+            fprintf(stderr, "%s: %s\n", scenarioPath, error.c_str());
+            return 1;
+        }
+        dt = scenario.dt;
+        if (!seedGiven) seed = scenario.seed;
+    }
+    else {
+        // 查询服务的客户端控制启停时，不自动按 START/STOP
+        if (!listenPath || startStopGiven) {
+            scenario.events.push_back({ (SimTime)(startAt * 1e6), SCENARIO_START, NO_FAULT });
+            scenario.events.push_back({ (SimTime)(stopAt * 1e6), SCENARIO_STOP, NO_FAULT });
+        }
+        scenario.end = (SimTime)(endAt * 1e6);
+    }
+    if (engines) scenario.engines = engines;
+    if (tanks) scenario.tanks = tanks;
+    if (crossFeed) scenario.crossFeed = true;
+
+    SimConfig config;
+    if (!simConfigMake(config, scenario.engines, scenario.tanks, scenario.crossFeed, scenario.tankFuel)) {
+        fprintf(stderr, "engines must be 1-%d and tanks 1-%d\n", (int)SIM_MAX_ENGINES, (int)SIM_MAX_TANKS);
+        return 1;
+    }
+    config.filteredAlerts = filteredAlerts;
+    EngineSim sim;
+    if (restorePath) {
+        // 构型、种子与时刻都来自检查点
+        if (!simLoadCheckpoint(sim, restorePath)) {
+            fprintf(stderr, "%s: not a valid checkpoint for this build\n", restorePath);
+            return 1;
+        }
+        config = sim.config;
+    }
+    else {
+        simInit(sim, config);
+        simSeed(sim, seed);
+    }
+    for (const ScenarioEvent& ev : scenario.events) {
+        if (ev.engine >= config.engineCount) {
+            fprintf(stderr, "fault on engine %d, but only %d engines\n", ev.engine + 1, config.engineCount);
+            return 1;
+        }
+    }
+    // 检查点在执行完当时到期的命令之后保存，恢复时这些命令不再执行
+    ScenarioQueue commands;
+    for (const ScenarioEvent& ev : scenario.events) {
+        if (!restorePath || ev.at > sim.now) commands.push(ev);
+    }
+    writerOpt.engineCount = config.engineCount;
+
+    CsvTelemetrySink csv;
+    AsyncTelemetrySink async;
+    if (output) {
+        bool ok = syncOutput ? csv.open(dataPath, logPath, config.engineCount) : async.open(dataPath, logPath, writerOpt);
+        if (!ok) {
+            fprintf(stderr, "cannot open %s / %s\n", dataPath, logPath);
+            return 1;
+        }
+        sim.sinks.push_back(syncOutput ? (TelemetrySink*)&csv : &async);
+    }
+    TelemetryBusSink bus;
+    if (busName) {
+        if (!bus.open(busName, config.engineCount)) {
+            fprintf(stderr, "cannot create telemetry bus %s\n", busName);
+            return 1;
+        }
+        sim.sinks.push_back(&bus);
+    }
+    QueryServer server;
+    if (listenPath) {
+        if (!server.start(listenPath, config.engineCount)) {
+            fprintf(stderr, "cannot listen on %s\n", listenPath);
+            return 1;
+        }
+        sim.sinks.push_back(&server);
+    }
+
+    SimTime endUs = scenarioEnd(scenario);
+    long long steps = 0;
+
+    FixedStepScheduler scheduler(dt, 1.0 / 60);
+    TRACE_THREAD_NAME("simulation");
+    auto wallStart = std::chrono::steady_clock::now();
+    SimTime ffUs = std::min((SimTime)(fastForward * 1e6), endUs);
+    SimTime checkpointUs = checkpointPath ? (SimTime)(checkpointAt * 1e6) : -1;
+    while (sim.now < endUs) {
+        if (sim.now < ffUs) {
+            // 快进：在命令时刻之间用 simAdvanceTo 跳过
+            if (listenPath) server.pollCommands(commands, sim.now);
+            commands.runDue(sim);
+            SimTime next = commands.nextAt();
+            steps += simAdvanceTo(sim, next >= 0 && next < ffUs ? next : ffUs);
+            continue;
+        }
+        // 实时模式每帧执行调度器给出的步数，否则尽快执行
+        int ticks = 1;
+        if (realtime) {
+            TRACE_ZONE("waitFrame");
+            ticks = scheduler.waitFrame();
+        }
+        for (int i = 0; i < ticks && sim.now < endUs; i++) {
+            if (listenPath) server.pollCommands(commands, sim.now);
+            commands.runDue(sim);
+            if (checkpointUs >= 0 && sim.now >= checkpointUs) {
+                if (!simSaveCheckpoint(sim, checkpointPath)) fprintf(stderr, "cannot write %s\n", checkpointPath);
+                checkpointUs = -1;
+            }
+            TRACE_ZONE("simStep");
+            simStep(sim, dt);
+            steps++;
+        }
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    if (output) {
+        csv.close();
+        async.close();
+    }
+    bus.close();
+    server.stop();
+    if (listenPath && server.dropped()) printf("query server: %llu records dropped\n", (unsigned long long)server.dropped());
+    if (tracePath && !traceWrite(tracePath)) {
+        fprintf(stderr, traceEnabled() ? "cannot write %s\n" : "built without ENGINE_TRACE, %s not written\n", tracePath);
+    }
+    if (output && !syncOutput) {
+        printf("telemetry: written=%llu dropped=%llu backpressured=%llu write_failures=%llu\n",
+            (unsigned long long)async.written(), (unsigned long long)async.dropped(),
+            (unsigned long long)async.backpressured(), (unsigned long long)async.writeFailures());
+    }
+    if (realtime) {
+        const FixedStepStats& st = scheduler.stats();
+        printf("scheduler: frames=%llu ticks=%llu missed=%llu dropped=%llu jitter mean=%.1fus max=%.1fus\n",
+            (unsigned long long)st.frames, (unsigned long long)st.ticks, (unsigned long long)st.missedDeadlines,
+            (unsigned long long)st.droppedTicks, st.jitterMeanUs, st.jitterMaxUs);
+    }
+    printf("steps=%lld sim=%.3fs wall=%.3fs speedup=%.0fx fuel=%.1f state=%d\n",
+        steps, sim.now / 1e6, wall, wall > 0 ? sim.now / 1e6 / wall : 0.0,
+        simTotalFuel(sim), (int)sim.state.state);
+    return 0;
+}
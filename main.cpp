@@ -1,6 +1,9 @@
 ﻿#define _CRT_SECURE_NO_WARNINGS
 #include <graphics.h>
 #include <conio.h>
+#include <mmsystem.h>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <ctime>
 #include <cstdio>
@@ -11,878 +14,576 @@
 #include <fstream>
 #include <vector>
 #include <random>
-
-// 引擎状态枚举
-enum EngineState {
-    ENGINE_OFF,
-    ENGINE_STARTING,
-    ENGINE_RUNNING,
-    ENGINE_STOPPING
-};
-
-// 异常类型（14种异常描述）
-enum FaultType {
-    NO_FAULT = 0,
-
-    // 传感器异常类
-    N1S1_FAIL,   // 单个转速传感器全故障
-    N1S2_FAIL,   // 单发转速传感器全故障
-    EGTS1_FAIL,  // 单个EGT传感器全故障
-    EGTS2_FAIL,  // 单发EGT传感器全故障
-    N1S_FAIL,    // 双发转速传感器全故障
-    EGTS_FAIL,   // 双发EGT传感器全故障
-
-    // 燃油类异常
-    LOW_FUEL,
-    FUELS_FAIL,
-    OVER_FF,   // 燃油流速超过 50
-    // 转速异常
-    OVER_SPD1, // N1>105
-    OVER_SPD2, // N1>120
-    // 温度异常
-    OVER_TEMP1, // 启动中T>850
-    OVER_TEMP2, // 启动中T>1000
-    OVER_TEMP3, // 稳态中T>950
-    OVER_TEMP4  // 稳态中T>1100
-};
-
-// 告警信息
-struct AlertInfo {
-    FaultType type;
-    std::string text;
-    COLORREF color;
-    DWORD last_trigger_time;
-};
-
-// 告警框（按钮）
-struct FaultDisplay {
-    std::string text;
-    int x, y, w, h; // 位置
-    FaultType ft;
-    bool isActive = false; // 按钮激活状态，默认为未激活
+#include <thread>
+#include "sim_core.h"
+#include "fixed_step.h"
+#include "mpsc_queue.h"
+#include "panel.h"
+#include "scenario.h"
+#include "seqlock.h"
+#include "spsc_ring.h"
+#include "telemetry_bus.h"
+#include "telemetry_writer.h"
+#include "telemetry_replay.h"
+#include "trace.h"
+#include "trend_history.h"
+
+#pragma comment(lib, "winmm.lib")
+
+// 输入、仿真、渲染各占一个线程：
+//   输入线程阻塞等待窗口消息，把按钮/告警框点击放入无锁命令队列 g_inputCommands；
+//   仿真线程按固定步长推进，每步之前取出并执行命令，每批步之后发布状态快照 g_snapshot；
+//   主线程（渲染）按帧率复制最新快照绘制。
+// 三者互不等待，绘制再慢 STOP 也在下一个物理步生效。
+
+// 全局运行标志（输入线程收到关窗消息时置位）
+static std::atomic<bool> g_quit(false);
+
+// 仿真线程独占
+static EngineSim g_sim;
+static AsyncTelemetrySink g_telemetry;
+static TelemetryBusSink g_bus;         // 共享内存遥测总线（main.exe --bus engine）
+static const char* g_busName = nullptr;
+
+// 趋势图的数据：仿真线程每步放入无锁环形缓冲区（满时丢弃），渲染线程每帧取出追加到 g_history
+class TrendFeed : public TelemetrySink {
+public:
+    TrendFeed() : m_ring(16384) {}
+    void onSample(const TelemetrySample& s) override {
+        m_ring.push(s);
+    }
+    void onFault(int64_t, FaultType) override {}
+    size_t popBatch(TelemetrySample* out, size_t max) { return m_ring.popBatch(out, max); }
+
+private:
+    SpscRing<TelemetrySample> m_ring;
 };
-
-// 全局运行标志
-static bool g_quit = false;
-
-// 左、右引擎数据
-struct EngineData {
-    double N1;    // 转速百分比, 0~125
-    double T;     // 温度 ℃, -5~1200
-    double FF;    // Fuel Flow 燃油流速 0~50
-    bool n1Sensor1Fail;
-    bool n1Sensor2Fail;
-    bool egtSensor1Fail;
-    bool egtSensor2Fail;
-    double targetN1;
-    double targetT;
-    double targetFF;
-};
-
-// 燃油数据
-struct FuelData {
-    double C; // 燃油余量 0~20000
-    bool fuelSensorFail;
+static TrendFeed g_trendFeed;
+
+// 物理默认 1kHz（--hz 修改），由仿真线程按步调度；界面默认 60 帧（--fps），表盘在前后两步之间插值
+static FixedStepScheduler g_physics(0.001, 0.001);
+static FixedStepScheduler g_frames(1.0 / 60, 1.0 / 60);
+
+// 仿真线程每批物理步之后发布的快照
+struct PanelSnapshot {
+    SimState sim;
+    TelemetrySample prev;  // 最后一步之前的数值，用于插值
+    int64_t stepNs;        // 最后一步完成的时刻（steady_clock 纳秒）
+    double stepSeconds;
+    FixedStepStats stats;  // 物理调度统计
 };
+static SeqlockSnapshot<PanelSnapshot> g_snapshot;
+static PanelSnapshot g_view; // 渲染线程正在绘制的快照（回放时直接装入回放状态）
+
+// 点击产生的命令（任意线程可放入，仿真线程取出后按当时的仿真时刻执行）
+static MpscQueue<ScenarioEvent> g_inputCommands(256);
+// 回放按键（输入线程放入，渲染线程取出）
+static MpscQueue<int> g_replayKeys(64);
+
+// 回放模式（main.exe --replay data.tlm）
+static bool g_replayMode = false;
+static TlmReplay g_replay;
+static ReplayClock g_replayClock;
+
+// 渲染线程独占：遥测历史与趋势图的时间跨度（main.exe --trend <分钟>，默认 10 分钟）；回放不画趋势图
+static TrendHistory g_history;
+static double g_trendSeconds = 600;
+
+// 仿真线程的控制命令队列：场景脚本（main.exe --scenario test.txt）与取出的点击命令都放入这里，在物理步之前执行
+static ScenarioQueue g_commands;
+static long long g_scenarioSeed = -1; // 脚本指定的随机种子，-1 为按时间
+
+// 追踪输出（main.exe --trace frame.json，需以 ENGINE_TRACE 编译）
+static const char* g_tracePath = nullptr;
+
+static int g_width = PANEL_WIDTH;
+static int g_height = PANEL_HEIGHT;
+
+// EasyX 实现的绘图接口，画到当前工作图像（窗口或离屏图层）
+class EasyXRenderer : public PanelRenderer {
+public:
+    void line(int x0, int y0, int x1, int y1, PanelColor c) override {
+        setlinecolor(toColorRef(c));
+        ::line(x0, y0, x1, y1);
+    }
+    void arc(int cx, int cy, int r, double startAngle, double endAngle, PanelColor c) override {
+        setlinecolor(toColorRef(c));
+        ::arc(cx - r, cy - r, cx + r, cy + r, startAngle, endAngle);
+    }
+    void fillPie(int cx, int cy, int r, double startAngle, double endAngle, PanelColor c) override {
+        setlinecolor(toColorRef(c));
+        setfillcolor(toColorRef(c));
+        ::fillpie(cx - r, cy - r, cx + r, cy + r, startAngle, endAngle);
+    }
+    void fillRect(int left, int top, int right, int bottom, PanelColor c) override {
+        setfillcolor(toColorRef(c));
+        solidrectangle(left, top, right, bottom);
+    }
+    void fillRoundRect(int left, int top, int right, int bottom, int corner, PanelColor c) override {
+        setfillcolor(toColorRef(c));
+        solidroundrect(left, top, right, bottom, corner, corner);
+    }
+    void text(int x, int y, int height, PanelColor c, const char* s) override {
+        settextstyle(height, 0, "Consolas");
+        settextcolor(toColorRef(c));
+        setbkmode(TRANSPARENT);
+        outtextxy(x, y, s);
+    }
 
-// 程序状态
-struct ProgramState {
-    EngineState state;
-    bool started;
-    bool stabilized;
-    bool stopped;
-    bool run_light_on;   // run灯状态
-    bool start_light_on; // start灯状态
-    bool state_changed; // 状态是否刚刚改变
-    // 推力调整按钮计数
-    double thrustAdjust;
+private:
+    static COLORREF toColorRef(PanelColor c) { return RGB((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF); }
 };
+static EasyXRenderer g_gdi;
 
-// 全局变量
-static ProgramState g_state;
-static EngineData g_leftEngine, g_rightEngine;
-static FuelData g_fuel;
-static DWORD g_startTime;
-static DWORD g_stopTime;
-static std::ofstream g_dataFile;
-static std::ofstream g_logFile;
-
-static int g_width = 600;
-static int g_height = 650;
-
-// 按钮的坐标和尺寸
-struct Button {
+// 保留式绘制（默认）：不变的部分预先画在离屏图层上，每帧只重画显示内容变化了的区域，
+// 也只把这些区域刷到窗口。main.exe --full-redraw 恢复每帧整窗重画
+struct PanelRegion {
     int x, y, w, h;
-    std::string text;
+    char key[128]; // 上次绘制的显示内容（按显示精度格式化），不变则不重画
+};
+enum {
+    REGION_N1_LEFT, REGION_N1_RIGHT, REGION_EGT_LEFT, REGION_EGT_RIGHT,
+    REGION_FUEL, REGION_START_LIGHT, REGION_RUN_LIGHT, REGION_ALERTS, REGION_INFO, REGION_TRENDS,
+    REGION_COUNT
 };
-static Button btnStart = { 250, 300, 80, 40, "START" };
-static Button btnStop = { 350, 300, 80, 40, "STOP" };
-static Button btnUp = { 450, 200, 30, 30, "▲" };
-static Button btnDown = { 450, 240, 30, 30, "▼" };
-
-// 状态告警框的布局
-const int g_faultX = 50;
-const int g_faultY = 350;
-static std::vector<FaultDisplay> g_faultDisplays = {
-    {"N1S1Fail",   g_faultX,g_faultY,80,25,N1S1_FAIL},
-    {"N1S2Fail",   g_faultX + 100,g_faultY,80,25,N1S2_FAIL},
-    {"EGTS1Fail",  g_faultX + 200,g_faultY,80,25,EGTS1_FAIL},
-    {"EGTS2Fail",  g_faultX + 300,g_faultY,80,25,EGTS2_FAIL},
-    {"N1SFail",    g_faultX,g_faultY + 30,80,25,N1S_FAIL},
-    {"EGTSFail",   g_faultX + 100,g_faultY + 30,80,25,EGTS_FAIL},
-    {"LowFuel",    g_faultX + 200,g_faultY + 30,80,25,LOW_FUEL},
-    {"FuelSFail",  g_faultX + 300,g_faultY + 30,80,25,FUELS_FAIL},
-    {"OverSpd1",   g_faultX,g_faultY + 60,80,25,OVER_SPD1},
-    {"OverSpd2",   g_faultX + 100,g_faultY + 60,80,25,OVER_SPD2},
-    {"OverFF",     g_faultX + 200,g_faultY + 60,80,25,OVER_FF},
-    {"OverTemp1",  g_faultX,g_faultY + 90,80,25,OVER_TEMP1},
-    {"OverTemp2",  g_faultX + 100,g_faultY + 90,80,25,OVER_TEMP2},
-    {"OverTemp3",  g_faultX + 200,g_faultY + 90,80,25,OVER_TEMP3},
-    {"OverTemp4",  g_faultX + 300,g_faultY + 90,80,25,OVER_TEMP4}
+static PanelRegion g_regions[REGION_COUNT] = {
+    // 表盘：圆心左 61、右 69（5 位读数）、上 31（圆弧起点与读数）、下 61
+    { 39, 69, 131, 93 }, { 239, 69, 131, 93 }, { 39, 169, 131, 93 }, { 239, 169, 131, 93 },
+    { 440, 78, 160, 55 },  // 燃油流速与余量
+    { 50, 300, 61, 26 }, { 120, 300, 61, 26 }, // START/RUN 灯
+    { 50, 500, 451, 121 }, // 告警文本框
+    { 0, 625, 600, 25 },   // 底部调度统计/回放进度
+    { PANEL_TREND_X, PANEL_TREND_Y, PANEL_TREND_W, 4 * PANEL_TREND_H + 3 * PANEL_TREND_GAP } // 趋势图
 };
+static PanelRegion g_faultRegions[PANEL_FAULT_BOX_COUNT]; // 与 g_panelFaultBoxes 一一对应
+static IMAGE g_layerOff; // 静态图层：告警框未激活、状态灯灭
+static IMAGE g_layerOn;  // 告警框激活、状态灯亮
+static bool g_fullRedraw = false;
+static bool g_panelValid = false; // 窗口内容与各区域的 key 一致
+static std::vector<const PanelRegion*> g_dirty; // 本帧重画过、需要刷到窗口的区域
+static bool g_dirtyAll = false;
+static char g_infoText[128];
+static std::chrono::steady_clock::time_point g_infoNext; // 调度统计每 250ms 刷新一次
+static char g_trendText[32];
+static std::chrono::steady_clock::time_point g_trendNext; // 趋势图同样每 250ms 刷新一次
+
+static int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-// 告警记录(5秒内同一种不重复记录)
-static std::vector<AlertInfo> g_alerts;
+// 本帧显示的数值：快照的上一步与最后一步之间，按最后一步之后经过的时间插值（回放不插值）
+void panelSample(TelemetrySample& s) {
+    simMakeSample(g_view.sim, s);
+    if (g_replayMode) return;
+    double a = (steadyNs() - g_view.stepNs) * 1e-9 / g_view.stepSeconds;
+    if (a < 0) a = 0;
+    if (a > 1) a = 1;
+    const TelemetrySample& p = g_view.prev;
+    for (int i = 0; i < s.engineCount; i++) {
+        s.N1[i] = p.N1[i] + (s.N1[i] - p.N1[i]) * a;
+        s.T[i] = p.T[i] + (s.T[i] - p.T[i]) * a;
+        s.FF[i] = p.FF[i] + (s.FF[i] - p.FF[i]) * a;
+    }
+    s.fuel = p.fuel + (s.fuel - p.fuel) * a;
+}
 
-// 角度转换：N1与T的指示范围为0°~210°
-// 假定0%对应0°，满量程(如N1=125)对应210°。
-inline double valueToAngle(double val, double maxVal = 125.0) {
-    if (val < 0) val = 0;
-    if (val > maxVal) val = maxVal;
-    double ratio = val / maxVal;
-    return 210.0 * ratio;
+// 回放进度文本
+void formatReplayInfo(char* buf) {
+    int64_t pos = (int64_t)g_replayClock.positionMs / 1000, end = g_replay.endMs() / 1000;
+    sprintf(buf, "REPLAY %02d:%02d:%02d / %02d:%02d:%02d  x%g%s",
+        (int)(pos / 3600), (int)(pos / 60 % 60), (int)(pos % 60),
+        (int)(end / 3600), (int)(end / 60 % 60), (int)(end % 60),
+        g_replayClock.speed, g_replayClock.paused ? "  PAUSED" : "");
 }
 
-inline double valueToAngleT(double val, double maxVal = 1200.0) {
-    // EGT同理0~1200°C -> 0~210°
-    if (val < -5) val = -5;
-    if (val > 1200) val = 1200;
-    double ratio = (val + 5) / (1200 + 5); // shift to start from 0
-    return 210.0 * ratio;
+// 绘制回放进度
+void drawReplayInfo(const char* text) {
+    g_gdi.text(50, 628, 15, panelRgb(255, 255, 0), text);
 }
 
-// 根据异常类型返回颜色
-COLORREF getColorForFault(FaultType ft, bool sensorValueInvalid = false) {
-    // 根据异常严重程度返回颜色
-    // 无效值用灰色表示
-    // 警告值红色，警戒值琥珀色，正常白色
-    switch (ft) {
-    case N1S1_FAIL:
-    case EGTS1_FAIL:
-        return RGB(255, 255, 255); //白色警告（传感器单个故障）
-    case EGTS2_FAIL:
-    case N1S2_FAIL: // 单发传感器全废，算警戒
-    case LOW_FUEL:
-    case OVER_FF:
-    case OVER_SPD1:
-    case OVER_TEMP1:
-    case OVER_TEMP3:
-        return RGB(255, 140, 0); // 琥珀色
-    case N1S_FAIL:
-    case EGTS_FAIL:
-    case FUELS_FAIL:
-    case OVER_SPD2:
-    case OVER_TEMP2:
-    case OVER_TEMP4:
-        return RGB(255, 0, 0); // 红色
-    default:
-        if (sensorValueInvalid)
-            return RGB(128, 128, 128); //灰色
-        return RGB(255, 255, 255); //正常白
-    }
+// 物理调度统计（取自快照）：物理频率、错过的截止时刻、唤醒抖动
+void formatSchedulerInfo(char* buf) {
+    const FixedStepStats& st = g_view.stats;
+    sprintf(buf, "%.0fHz  ticks %llu  missed %llu  dropped %llu  jitter %.0f/%.0fus",
+        1.0 / g_view.stepSeconds, (unsigned long long)st.ticks, (unsigned long long)st.missedDeadlines,
+        (unsigned long long)st.droppedTicks, st.jitterMeanUs, st.jitterMaxUs);
 }
 
-// 根据故障类型获取文本
-std::string faultTypeToString(FaultType ft) {
-    switch (ft) {
-    case N1S1_FAIL: return "One N1 Sensor Fail";
-    case N1S2_FAIL: return "One Engine N1 Sensor Fail";
-    case EGTS1_FAIL: return "One EGT Sensor Fail";
-    case EGTS2_FAIL: return "One Engine EGT Sensor Fail";
-    case N1S_FAIL: return "All N1 Sensor Fail";
-    case EGTS_FAIL: return "All EGT Sensor Fail";
-    case LOW_FUEL: return "Low Fuel 1000";
-    case FUELS_FAIL: return "Fuel Sensor Fail";
-    case OVER_FF: return "Over Fuel Flow 50";
-    case OVER_SPD1: return "Over Speed 105";
-    case OVER_SPD2: return "Over Speed 120";
-    case OVER_TEMP1: return "Over Temperature 850 when STARTING";
-    case OVER_TEMP2: return "Over Temperature 1000 when STARTING";
-    case OVER_TEMP3: return "Over Temperature 950 when RUNNING";
-    case OVER_TEMP4: return "Over Temperature 1100 when RUNNING";
-    default: return "";
-    }
+void drawSchedulerInfo(const char* text) {
+    g_gdi.text(50, 630, 12, panelRgb(128, 128, 128), text);
 }
 
-// 将当前故障记录到 log 文件
-void logFault(FaultType ft) {
-    if (ft == NO_FAULT) return;
-    DWORD now = GetTickCount();
-    for (auto& a : g_alerts) {
-        if (a.type == ft) {
-            // 若5s内已记录过，则不重复记录
-            if (now - a.last_trigger_time < 5001) return;
-            a.last_trigger_time = now;
-            break;
-        }
+// 初始化
+void initData() {
+    simInit(g_sim);
+    simSeed(g_sim, g_scenarioSeed >= 0 ? (uint32_t)g_scenarioSeed : (uint32_t)time(NULL));
+    if (g_replayMode) return;
+
+    // 数据与日志由后台线程写出，不占用界面/仿真线程
+    g_telemetry.open("data.csv", "log.txt");
+    g_sim.sinks.push_back(&g_telemetry);
+    g_sim.sinks.push_back(&g_trendFeed);
+    if (g_busName) {
+        if (g_bus.open(g_busName)) g_sim.sinks.push_back(&g_bus);
+        else fprintf(stderr, "cannot create telemetry bus %s\n", g_busName);
     }
-
-    // 找不到则新加入
-    AlertInfo ai;
-    ai.type = ft;
-    ai.text = faultTypeToString(ft);
-    ai.color = getColorForFault(ft);
-    ai.last_trigger_time = now;
-    g_alerts.push_back(ai);
-
-    // 写入log
-    DWORD runningTime = now - g_startTime;
-    g_logFile << runningTime << "ms: " << ai.text << std::endl;
-    g_logFile.flush();
 }
 
-// 绘制表盘背景和指针
-void drawGauge(int centerX, int centerY, double angle, double value, bool isEGT, FaultType ft = NO_FAULT) {
-    int radius = 60;
-    double sweepRad = angle * 3.1415926 / 180.0;
-    // 根据故障类型或异常判断颜色
-    COLORREF col = RGB(255, 255, 255);
-    // 若有故障则颜色变化
-    if (ft != NO_FAULT) {
-        col = getColorForFault(ft);
-    }
-    setlinecolor(WHITE);
-    line(centerX, centerY, centerX + radius, centerY);
-    arc(centerX - radius, centerY - radius, centerX + radius, centerY + radius, -3.66519137, 0);
-    setbkmode(TRANSPARENT);
-    settextstyle(20, 0, "Consolas");
-    settextcolor(col);
-    // 绘制数值文本
-    char buf[32];
-    if (ft != NO_FAULT) {
-        // 如果该故障导致无效值，用"--"
-        if (ft == N1S2_FAIL || ft == N1S_FAIL || ft == EGTS2_FAIL || ft == EGTS_FAIL) {
-            sprintf(buf, "--");
-            outtextxy(centerX + 10, centerY - 20, buf);
-            return;
-        }
-        else {
-            if (isEGT) sprintf(buf, "%d", (int)value);
-            else sprintf(buf, "%.1f", value);
+// 回放按键（渲染线程取出执行）：空格暂停，↑↓ 变速，←→ 前后跳 10 秒，Home 回到开头
+void checkReplayKeys() {
+    int key;
+    while (g_replayKeys.pop(key)) {
+        double pos = g_replayClock.positionMs;
+        if (key == VK_SPACE) g_replayClock.paused = !g_replayClock.paused;
+        if (key == VK_UP && g_replayClock.speed < 1024) g_replayClock.speed *= 2;
+        if (key == VK_DOWN && g_replayClock.speed > 1.0 / 16) g_replayClock.speed /= 2;
+        if (key == VK_LEFT) pos -= 10000;
+        if (key == VK_RIGHT) pos += 10000;
+        if (key == VK_HOME) pos = (double)g_replay.beginMs();
+        if (pos != g_replayClock.positionMs) {
+            g_replayClock.seek(pos, g_replay.endMs());
+            alertClear(g_sim.alerts); // 跳转后告警重新累计
+            simResetFaultRules(g_sim);
         }
     }
-    else {
-        if (isEGT) sprintf(buf, "%d", (int)value);
-        else sprintf(buf, "%.1f", value);
-    }
-    outtextxy(centerX + 10, centerY - 20, buf);
-    //扇形
-    if ((int)angle == 0) return;
-    setlinecolor(col);
-    setfillcolor(col);
-    fillpie(centerX - radius, centerY - radius, centerX + radius, centerY + radius, -sweepRad, 0);
-}
-// 绘制按钮
-void drawButton(const Button& btn, bool pressed = false) {
-    setlinecolor(WHITE);
-    setfillcolor(pressed ? RGB(200, 200, 200) : RGB(100, 100, 255));
-    solidrectangle(btn.x, btn.y, btn.x + btn.w, btn.y + btn.h);
-    settextstyle(20, 0, "Consolas");
-    settextcolor(BLACK);
-    setbkmode(TRANSPARENT);
-    outtextxy(btn.x + 5, btn.y + 5, btn.text.c_str());
 }
-// 绘制状态
-void drawStatusBoxes() {
-    // 若start灯亮，画蓝色背景
-    // run灯亮，画绿色背景
-    // 若不亮，画深色背景
-    int xstart = 50, ystart = 300;
-    settextstyle(20, 0, "Consolas");
-    setbkmode(OPAQUE);
-
-    setfillcolor(g_state.start_light_on ? RGB(0, 0, 255) : RGB(50, 50, 50));
-    solidrectangle(xstart, ystart, xstart + 60, ystart + 25);
-    settextcolor(BLACK);
-    setbkmode(TRANSPARENT);
-    outtextxy(xstart + 5, ystart + 2, "START");
-
-    setfillcolor(g_state.run_light_on ? RGB(0, 255, 0) : RGB(50, 50, 50));
-    solidrectangle(xstart + 70, ystart, xstart + 70 + 60, ystart + 25);
-    settextcolor(BLACK);
-    setbkmode(TRANSPARENT);
-    outtextxy(xstart + 75, ystart + 2, "RUN");
+
+// 回放一步（渲染线程，没有仿真线程）：取记录值，重新做故障检查与告警，结果装入 g_view
+void stepReplay(double dt) {
+    g_replayClock.advance(dt, g_replay.endMs());
+    TelemetrySample s;
+    if (!g_replay.sampleAt((int64_t)g_replayClock.positionMs, s)) return;
+    g_sim.now = (SimTime)(g_replayClock.positionMs * 1000);
+    g_sim.startTime = g_sim.now - s.timeMs * 1000;
+    simLoadSample(g_sim, s);
+    checkFault(g_sim);
+    simExpireAlerts(g_sim);
+    g_view.sim = g_sim;
 }
-// 绘制燃油流速
-void drawFFInfo(double ff, FaultType ft) {
-    int x = 500, y = 100;
-    settextstyle(20, 0, "Consolas");
-    setbkmode(TRANSPARENT);
-
-    COLORREF col = WHITE;
-    settextcolor(col);
-    outtextxy(x - 50, y - 20, "Fuel Flow:");
-    char buf[32];
-    if (ft == OVER_FF) {
-        col = getColorForFault(ft);
-        settextcolor(col);
-        sprintf(buf, "%.0f", ff);
-    }
-    else {
-        sprintf(buf, "%.0f", ff);
+
+// 取出仿真线程送来的记录追加到历史（渲染线程）
+void drainTrends() {
+    static TelemetrySample batch[256];
+    size_t n;
+    while ((n = g_trendFeed.popBatch(batch, 256)) > 0) {
+        for (size_t i = 0; i < n; i++) g_history.append(batch[i]);
     }
-    outtextxy(x + 50, y - 20, buf);
 }
-// 绘制燃油余量
-void drawFuelInfo(double c, FaultType ft) {
-    int x = 500, y = 100;
-    settextstyle(20, 0, "Consolas");
-    setbkmode(TRANSPARENT);
-    char buf[32];
-    COLORREF col = WHITE;
-    settextcolor(col);
-    outtextxy(x - 50, y + 10, "Fuel:");
-    if (ft == FUELS_FAIL) {
-        col = getColorForFault(ft);
-        settextcolor(col);
-        sprintf(buf, "--");
-    }
-    else if (ft == LOW_FUEL) {
-        col = getColorForFault(ft);
-        settextcolor(col);
-        sprintf(buf, "%.0f", c);
-    }
-    else {
-        sprintf(buf, "%.0f", c);
-    }
-    outtextxy(x, y + 10, buf);
+
+// 点击命令放入队列；队列满（仿真线程停顿）时丢弃这次点击
+static void pushCommand(ScenarioOp op, FaultType ft) {
+    if (!g_inputCommands.push({ 0, op, ft })) fprintf(stderr, "command queue full, click dropped\n");
 }
 
-// 绘制警告框
-void drawFaultDisplays() {
-    for (auto& fd : g_faultDisplays) {
-        COLORREF col = fd.isActive ? WHITE : RGB(128, 128, 128); // 激活亮黄，未激活灰色
-        setfillcolor(RGB(50, 50, 50));
-        solidrectangle(fd.x, fd.y, fd.x + fd.w, fd.y + fd.h);
-        settextstyle(15, 0, "Consolas");
-        setbkmode(TRANSPARENT);
-        settextcolor(col);
-        outtextxy(fd.x + 5, fd.y + 5, fd.text.c_str());
+// 鼠标点击按钮（输入线程）
+void checkMouse(const ExMessage& msg) {
+    // START/STOP/▲/▼ 按钮
+    static const ScenarioOp BUTTON_OPS[PANEL_BUTTON_COUNT] = {
+        SCENARIO_START, SCENARIO_STOP, SCENARIO_THRUST_UP, SCENARIO_THRUST_DOWN
+    };
+    int btn = panelButtonAt(msg.x, msg.y);
+    if (btn >= 0) pushCommand(BUTTON_OPS[btn], NO_FAULT);
+    int box = panelFaultBoxAt(msg.x, msg.y);
+    if (box >= 0) {
+        // 按最新快照中的注入状态切换告警框对应的故障
+        static PanelSnapshot snap;
+        FaultType ft = g_panelFaultBoxes[box].ft;
+        bool active = !(g_snapshot.read(snap) && simFaultInjected(snap.sim, ft));
+        pushCommand(active ? SCENARIO_FAULT_ON : SCENARIO_FAULT_OFF, ft);
     }
 }
 
-// 绘制警示文本框
-void drawTextArea() {
-    // 绘制背景框
-    setfillcolor(RGB(50, 50, 50));  // 设置背景色
-    solidroundrect(50, 500, 500, 620, 10, 10);  // 绘制背景框
-
-    // 设置文字样式和颜色
-    settextstyle(20, 0, "Consolas");
-    setbkmode(TRANSPARENT);
-
-    DWORD now = GetTickCount();
-    int yOffset = 510; // 初始文字显示的 Y 坐标
-
-    // 遍历当前的告警信息
-    std::vector<AlertInfo> activeAlerts;
-
-    // 遍历并过滤超时的告警
-    for (auto& alert : g_alerts) {
-        if (now - alert.last_trigger_time < 5000) {
-            activeAlerts.push_back(alert);
+// 输入线程：阻塞等待窗口消息，只做命中判断与入队
+void inputThread() {
+    TRACE_THREAD_NAME("input");
+    while (!g_quit) {
+        ExMessage msg = getmessage(EX_MOUSE | EX_KEY | EX_WINDOW);
+        if (msg.message == WM_CLOSE) g_quit = true;
+        else if (g_replayMode) {
+            if (msg.message == WM_KEYDOWN) g_replayKeys.push(msg.vkcode);
+        }
+        else if (msg.message == WM_LBUTTONDOWN) {
+            TRACE_ZONE("checkMouse");
+            checkMouse(msg);
         }
     }
+}
 
-    // 清除所有已经过期的告警
-    g_alerts = activeAlerts;
-
-    // 绘制剩余的告警
-    for (const auto& alert : g_alerts) {
-        // 设置文字颜色
-        settextcolor(alert.color);
-
-        // 显示告警文字
-        outtextxy(60, yOffset, alert.text.c_str());
-
-        // 调整下一个告警的 Y 坐标，避免覆盖
-        yOffset += 25;
+// 发布快照
+static void publishSnapshot(const TelemetrySample& prev) {
+    static PanelSnapshot snap;
+    snap.sim = g_sim;
+    snap.prev = prev;
+    snap.stepNs = steadyNs();
+    snap.stepSeconds = g_physics.stepSeconds();
+    snap.stats = g_physics.stats();
+    g_snapshot.publish(snap);
+}
 
-        // 如果超出背景框范围，则停止绘制
-        if (yOffset > 590) break;
+// 仿真线程：每个物理步之前取出点击命令，按当前仿真时刻排入命令队列再执行，所以点击最迟在下一步生效
+void simThread() {
+    TRACE_THREAD_NAME("sim");
+    TelemetrySample prev;
+    simMakeSample(g_sim, prev);
+    publishSnapshot(prev);
+    while (!g_quit) {
+        int ticks = g_physics.waitFrame();
+        TRACE_ZONE("physics");
+        for (int i = 0; i < ticks; i++) {
+            ScenarioEvent ev;
+            while (g_inputCommands.pop(ev)) {
+                ev.at = g_sim.now;
+                g_commands.push(ev);
+            }
+            g_commands.runDue(g_sim);
+            simMakeSample(g_sim, prev);
+            simStep(g_sim, g_physics.stepSeconds());
+        }
+        if (ticks > 0) publishSnapshot(prev);
     }
 }
 
+// 绘制主界面（整窗重画）
+void drawUI() {
+    // 当前数据、故障状态、告警框、按钮、状态灯与告警文本
+    TelemetrySample s;
+    panelSample(s);
+    drawPanelFrame(g_gdi, g_view.sim, s);
+    if (!g_replayMode) drawTrends(g_gdi, g_history, g_trendSeconds, g_view.sim.config);
 
-// 检查故障并绘制数据
-FaultType checkFuelFault() {
-    if (g_fuel.fuelSensorFail) {
-        return FUELS_FAIL;
+    char info[128];
+    if (g_replayMode) {
+        formatReplayInfo(info);
+        drawReplayInfo(info);
     }
-    else if (g_fuel.C < 1000 && (g_state.state == ENGINE_RUNNING || g_state.state == ENGINE_STARTING)) {
-        if (g_fuel.C <= 0) {
-            g_state.state = ENGINE_STOPPING;
-            g_stopTime = GetTickCount();
-            g_state.thrustAdjust = 0;
-        }
-        return LOW_FUEL;
+    else {
+        formatSchedulerInfo(info);
+        drawSchedulerInfo(info);
     }
-    return NO_FAULT;
+    g_dirtyAll = true;
 }
-FaultType checkN1Fault(const EngineData& engine) {
-    if (engine.n1Sensor1Fail && engine.n1Sensor2Fail) {
-        return N1S2_FAIL;
-    }
-    else if (engine.n1Sensor1Fail || engine.n1Sensor2Fail) {
-        return N1S1_FAIL;
-    }
 
-    if (engine.N1 > 120) {
-        g_state.state = ENGINE_STOPPING;
-        g_stopTime = GetTickCount();
-        g_state.thrustAdjust = 0;
-        return OVER_SPD2;
+// 预先画好静态图层：表盘刻度、按钮、文本框背景，以及告警框与状态灯的两种外观
+void buildPanelLayers() {
+    for (int on = 0; on < 2; on++) {
+        IMAGE& layer = on ? g_layerOn : g_layerOff;
+        layer.Resize(g_width, g_height);
+        SetWorkingImage(&layer);
+        g_gdi.fillRect(0, 0, g_width, g_height, PANEL_BLACK);
+        drawGaugeDial(g_gdi, 100, 100);
+        drawGaugeDial(g_gdi, 300, 100);
+        drawGaugeDial(g_gdi, 100, 200);
+        drawGaugeDial(g_gdi, 300, 200);
+        for (const PanelButton& btn : g_panelButtons) drawButton(g_gdi, btn);
+        for (const PanelFaultBox& box : g_panelFaultBoxes) drawFaultBox(g_gdi, box, on != 0);
+        drawStatusBoxes(g_gdi, on != 0, on != 0);
+        drawTextBackground(g_gdi);
     }
-    else if (engine.N1 > 105) {
-        return OVER_SPD1;
+    SetWorkingImage();
+
+    for (int i = 0; i < PANEL_FAULT_BOX_COUNT; i++) {
+        const PanelFaultBox& box = g_panelFaultBoxes[i];
+        g_faultRegions[i] = PanelRegion{ box.x, box.y, box.w + 1, box.h + 1 };
     }
-    return NO_FAULT;
+    g_panelValid = false;
 }
-FaultType checkTemperatureFault(const EngineData& engine) {
-    if (engine.egtSensor1Fail && engine.egtSensor2Fail) {
-        return EGTS2_FAIL; // 单发EGT传感器全部故障
-    }
-    else if (engine.egtSensor1Fail || engine.egtSensor2Fail) {
-        return EGTS1_FAIL; // 单个EGT传感器故障
-    }
 
-    if (g_state.state == ENGINE_STARTING) {
-        if (engine.T > 1000) {
-            g_state.state = ENGINE_STOPPING;
-            g_stopTime = GetTickCount();
-            g_state.thrustAdjust = 0;
-            return OVER_TEMP2;
-        }
-        else if (engine.T > 850) {
-            return OVER_TEMP1;
-        }
-    }
-    else if (g_state.state == ENGINE_RUNNING) {
-        if (engine.T > 1100) {
-            g_state.state = ENGINE_STOPPING;
-            g_stopTime = GetTickCount();
-            g_state.thrustAdjust = 0;
-            return OVER_TEMP4;
-        }
-        else if (engine.T > 950) {
-            return OVER_TEMP3;
-        }
-    }
-    return NO_FAULT;
+// 显示内容与上次不同时，从图层恢复该区域的底图并记为脏区，返回 true 由调用者画上新内容
+static bool regionUpdate(PanelRegion& r, const char* key, const IMAGE& layer) {
+    if (!strcmp(r.key, key)) return false;
+    snprintf(r.key, sizeof(r.key), "%s", key);
+    putimage(r.x, r.y, r.w, r.h, &layer, r.x, r.y);
+    g_dirty.push_back(&r);
+    return true;
 }
-void checkFault() {
-    // 燃油故障
-    FaultType fuelFault = checkFuelFault();
-    drawFuelInfo(g_fuel.C, fuelFault);
-    if (fuelFault != NO_FAULT) {
-        logFault(fuelFault);
-    }
 
-    if (g_leftEngine.FF > 50 || g_rightEngine.FF > 50) {
-        drawFFInfo((g_leftEngine.FF + g_rightEngine.FF) * 0.5, OVER_FF);
-        logFault(OVER_FF);
-    }
-    else drawFFInfo((g_leftEngine.FF + g_rightEngine.FF) * 0.5, NO_FAULT);
+// 表盘读数按显示文本与颜色比较，扇形按 0.5° 取整（半径 60 时约半个像素）
+static void updateGauge(int region, int centerX, int centerY, double angle, double value, bool isEGT, FaultType ft) {
+    char text[32], key[128];
+    PanelColor col;
+    bool pie = gaugeReading(text, value, isEGT, ft, col) && (int)angle != 0;
+    sprintf(key, "%s %06x %d", text, (unsigned)col, pie ? (int)(angle * 2) + 1 : 0);
+    if (regionUpdate(g_regions[region], key, g_layerOff)) drawGaugeValue(g_gdi, centerX, centerY, angle, value, isEGT, ft);
+}
 
-    // 左N1
-    FaultType leftN1Fault = checkN1Fault(g_leftEngine);
-    drawGauge(100, 100, valueToAngle(g_leftEngine.N1), g_leftEngine.N1, false, leftN1Fault);
-    if (leftN1Fault != NO_FAULT) {
-        logFault(leftN1Fault);
-    }
-    // 右N1
-    FaultType rightN1Fault = checkN1Fault(g_rightEngine);
-    drawGauge(300, 100, valueToAngle(g_rightEngine.N1), g_rightEngine.N1, false, rightN1Fault);
-    if (rightN1Fault != NO_FAULT) {
-        logFault(rightN1Fault);
-    }
-    // 左EGT
-    FaultType leftTempFault = checkTemperatureFault(g_leftEngine);
-    drawGauge(100, 200, valueToAngleT(g_leftEngine.T), g_leftEngine.T, true, leftTempFault);
-    if (leftTempFault != NO_FAULT) {
-        logFault(leftTempFault);
-    }
-    // 右EGT
-    FaultType rightTempFault = checkTemperatureFault(g_rightEngine);
-    drawGauge(300, 200, valueToAngleT(g_rightEngine.T), g_rightEngine.T, true, rightTempFault);
-    if (rightTempFault != NO_FAULT) {
-        logFault(rightTempFault);
+// 绘制主界面（保留式）：只重画显示内容变化了的区域
+void drawPanel() {
+    if (!g_panelValid) {
+        putimage(0, 0, &g_layerOff);
+        for (auto& r : g_regions) r.key[0] = 0;
+        for (auto& r : g_faultRegions) r.key[0] = 0;
+        g_dirtyAll = true;
+        g_panelValid = true;
+    }
+
+    const SimFaults& f = g_view.sim.faults;
+    TelemetrySample s;
+    panelSample(s);
+    updateGauge(REGION_N1_LEFT, 100, 100, valueToAngle(s.N1[SIM_LEFT]), s.N1[SIM_LEFT], false, f.n1[SIM_LEFT]);
+    updateGauge(REGION_N1_RIGHT, 300, 100, valueToAngle(s.N1[SIM_RIGHT]), s.N1[SIM_RIGHT], false, f.n1[SIM_RIGHT]);
+    updateGauge(REGION_EGT_LEFT, 100, 200, valueToAngleT(s.T[SIM_LEFT]), s.T[SIM_LEFT], true, f.egt[SIM_LEFT]);
+    updateGauge(REGION_EGT_RIGHT, 300, 200, valueToAngleT(s.T[SIM_RIGHT]), s.T[SIM_RIGHT], true, f.egt[SIM_RIGHT]);
+
+    char key[128];
+    double ff = (s.FF[SIM_LEFT] + s.FF[SIM_RIGHT]) * 0.5;
+    if (f.fuel == FUELS_FAIL) sprintf(key, "%.0f %d --", ff, f.ff == OVER_FF);
+    else sprintf(key, "%.0f %d %.0f %d", ff, f.ff == OVER_FF, s.fuel, f.fuel == LOW_FUEL);
+    if (regionUpdate(g_regions[REGION_FUEL], key, g_layerOff)) {
+        drawFuelInfo(g_gdi, s.fuel, f.fuel);
+        drawFFInfo(g_gdi, ff, f.ff);
+    }
+
+    // 告警框与状态灯只有两种外观，直接从对应图层复制
+    for (int i = 0; i < PANEL_FAULT_BOX_COUNT; i++) {
+        bool active = simFaultInjected(g_view.sim, g_panelFaultBoxes[i].ft);
+        regionUpdate(g_faultRegions[i], active ? "on" : "off", active ? g_layerOn : g_layerOff);
+    }
+    bool startOn = g_view.sim.state.start_light_on, runOn = g_view.sim.state.run_light_on;
+    regionUpdate(g_regions[REGION_START_LIGHT], startOn ? "on" : "off", startOn ? g_layerOn : g_layerOff);
+    regionUpdate(g_regions[REGION_RUN_LIGHT], runOn ? "on" : "off", runOn ? g_layerOn : g_layerOff);
+
+    // 文本框最多显示 4 条告警
+    int len = sprintf(key, "-"), shown = 0;
+    for (const auto& alert : g_view.sim.alerts) {
+        if (shown++ == 4) break;
+        len += sprintf(key + len, " %d", (int)alert.type);
+    }
+    if (regionUpdate(g_regions[REGION_ALERTS], key, g_layerOff)) drawAlertText(g_gdi, g_view.sim.alerts);
+
+    if (g_replayMode) {
+        formatReplayInfo(key);
+        if (regionUpdate(g_regions[REGION_INFO], key, g_layerOff)) drawReplayInfo(key);
     }
+    else {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= g_infoNext) {
+            formatSchedulerInfo(g_infoText);
+            g_infoNext = now + std::chrono::milliseconds(250);
+        }
+        if (regionUpdate(g_regions[REGION_INFO], g_infoText, g_layerOff)) drawSchedulerInfo(g_infoText);
 
-    // 两发转速传感器全失败
-    if (g_leftEngine.n1Sensor1Fail && g_leftEngine.n1Sensor2Fail &&
-        g_rightEngine.n1Sensor1Fail && g_rightEngine.n1Sensor2Fail) {
-        drawGauge(100, 100, valueToAngle(g_leftEngine.N1), g_leftEngine.N1, false, N1S_FAIL);
-        drawGauge(300, 100, valueToAngle(g_rightEngine.N1), g_rightEngine.N1, false, N1S_FAIL);
-        logFault(N1S_FAIL);
-        g_state.state = ENGINE_STOPPING;
-        g_state.thrustAdjust = 0;
-        if (g_leftEngine.N1 <= 1) {
-            g_state.state = ENGINE_OFF; // 切换到关闭状态
-            g_state.run_light_on = false; // 关闭运行灯
-            g_state.state_changed = true;
+        // 按已追加的步数判断有无新数据
+        if (now >= g_trendNext) {
+            sprintf(g_trendText, "%llu", (unsigned long long)g_history.samples());
+            g_trendNext = now + std::chrono::milliseconds(250);
         }
-    }
-    // 两发EGT都失败
-    if (g_leftEngine.egtSensor1Fail && g_leftEngine.egtSensor2Fail &&
-        g_rightEngine.egtSensor1Fail && g_rightEngine.egtSensor2Fail) {
-        drawGauge(100, 200, valueToAngleT(g_leftEngine.T), g_leftEngine.T, true, EGTS_FAIL);
-        drawGauge(300, 200, valueToAngleT(g_rightEngine.T), g_rightEngine.T, true, EGTS_FAIL);
-        logFault(EGTS_FAIL);
-        g_state.state = ENGINE_STOPPING;
-        g_state.thrustAdjust = 0;
-        if (g_leftEngine.N1 <= 1) {
-            g_state.state = ENGINE_OFF; // 切换到关闭状态
-            g_state.run_light_on = false; // 关闭运行灯
-            g_state.state_changed = true;
+        if (regionUpdate(g_regions[REGION_TRENDS], g_trendText, g_layerOff)) {
+            drawTrends(g_gdi, g_history, g_trendSeconds, g_view.sim.config);
         }
     }
 }
 
-// 初始化
-void initData() {
-    srand((unsigned)time(NULL));
-    g_state.state = ENGINE_OFF;
-    g_state.started = false;
-    g_state.stabilized = false;
-    g_state.stopped = true;
-    g_state.run_light_on = false;
-    g_state.start_light_on = false;
-    g_state.thrustAdjust = 0;
-
-    g_leftEngine = { 0,20,0,false,false,false,false };
-    g_rightEngine = { 0,20,0,false,false,false,false };
-    g_fuel = { 3000,false };
-
-    g_startTime = GetTickCount();
-
-    g_dataFile.open("data.csv", std::ios::out);
-    g_dataFile << "Time(ms),N1_left,N1_right,T_left,T_right,FF_left,FF_right,Fuel\n";
-    g_logFile.open("log.txt", std::ios::out);
+// 把本帧重画过的区域刷到窗口；没有变化的帧不刷新
+void presentPanel() {
+    if (g_dirtyAll) FlushBatchDraw();
+    else {
+        for (const PanelRegion* r : g_dirty) FlushBatchDraw(r->x, r->y, r->x + r->w - 1, r->y + r->h - 1);
+    }
+    g_dirty.clear();
+    g_dirtyAll = false;
 }
 
-// 数据更新逻辑
-void updateData() {
-    DWORD now = GetTickCount(); // 5ms一次
-    double t = (now - g_startTime) / 1000.0; // seconds
-    static double lastC = g_fuel.C;
-    static DWORD lastUpdate = now;
-    double dt = (now - lastUpdate) / 1000.0;
-    lastUpdate = now;
-
-    static double value = 20.0; // 表盘基准值
-    static double delta = 0.0;  // 当前变化速率
-    static double damping = 0.9; // 阻尼系数（越接近 1 越平滑）
-    delta += ((rand() % 201 - 100) / 100.0) * 0.005; // 随机速率调整
-    value += delta;
-    delta *= damping; // 阻尼减速
-    value += (20.0 - value) * 0.05; // 回归基准值
-    if (value > 21.5) value = 21.5;
-    if (value < 18.5) value = 18.5;
-
-    // 根据状态决定N,T,V变化
-    if (g_state.state == ENGINE_OFF) {
-        g_state.thrustAdjust == 0;
-        g_state.start_light_on = false;
-        g_state.run_light_on = false;
-        g_leftEngine.N1 = 0;g_rightEngine.N1 = 0;
-        g_leftEngine.FF = 0;g_rightEngine.FF = 0;
-        g_leftEngine.T = value;
-        g_rightEngine.T = g_leftEngine.T + ((rand() % 201 - 100) / 100.0) * 0.005;
-    }
-    else if (g_state.state == ENGINE_STARTING) {
-        // 线性增加阶段
-        if (g_leftEngine.N1 < 50 || g_rightEngine.N1 < 50) {
-            g_leftEngine.N1 += 10000.0 / 40000 * dt * 100 + (rand() % 3 - 1) * 0.3;
-            g_rightEngine.N1 = g_leftEngine.N1;
-            g_leftEngine.FF += 5.0 * dt;
-            g_rightEngine.FF = g_leftEngine.FF;
-            g_leftEngine.T = value;
-            g_rightEngine.T = g_leftEngine.T + ((rand() % 201 - 100) / 100.0) * 0.005;
-        }
-        else {
-            // 对数上升阶段
-            double x = t - 1;
-            double V = 42 * log10(x > 1 ? x : 1) + 10;
-            if (V < 0) V = 0;if (V > 50)V = 50;
-            double N = 23000 * log10(x > 1 ? x : 1) + 20000; //实际转速N，这里N1 = N/40000*100
-            double n1 = N / 400.0;
-            if (n1 > 95) {
-                g_state.state = ENGINE_RUNNING;
-                g_state.stabilized = true;
-                g_state.start_light_on = false;
-                g_state.run_light_on = true;
+int main(int argc, char** argv) {
+    double hz = 1000, fps = 60;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--replay") && hasValue) {
+            if (!g_replay.open(argv[++i])) {
+                fprintf(stderr, "cannot replay %s\n", argv[i]);
+                return 1;
             }
-            double v = (g_faultDisplays[12].isActive == true)? 1500 : ((g_faultDisplays[11].isActive == true)? 1170 : 900);
-            double T = v * log10(x > 1 ? x : 1) + 20;
-            g_leftEngine.N1 = n1 + (rand() % 3 - 1) * 0.3; g_rightEngine.N1 = n1 + (rand() % 3 - 1) * 0.3;
-            g_leftEngine.FF = V + (rand() % 3 - 1) * 0.03; g_rightEngine.FF = V + (rand() % 3 - 1) * 0.03;
-            g_leftEngine.T = T + (rand() % 3 - 1) * 0.3; g_rightEngine.T = T + (rand() % 3 - 1) * 0.3;
+            g_replayMode = true;
+            g_replayClock.seek((double)g_replay.beginMs(), g_replay.endMs());
         }
-    }
-    else if (g_state.state == ENGINE_RUNNING) {
-        // 稳态阶段
-        if (g_state.thrustAdjust == 0) { // 增加推力
-            g_leftEngine.N1 += (rand() % 3 - 1) * 0.05;
-            g_rightEngine.N1 = g_leftEngine.N1 + (rand() % 3 - 1) * 0.03;
-            g_leftEngine.FF += (rand() % 3 - 1) * 0.05;
-            g_rightEngine.FF = g_leftEngine.FF + (rand() % 3 - 1) * 0.03;
-            g_leftEngine.T += (rand() % 3 - 1) * 0.5;
-            g_rightEngine.T = g_leftEngine.T + (rand() % 3 - 1) * 0.03;
+        else if (!strcmp(argv[i], "--hz") && hasValue) {
+            hz = atof(argv[++i]);
         }
-        else {
-            // 平滑过渡到目标值
-            double smoothingFactor = 0.1; // 平滑变化的因子，越小越慢
-
-            // 转速逐步逼近目标值
-            g_leftEngine.N1 += (g_leftEngine.targetN1 - g_leftEngine.N1) * smoothingFactor;
-            g_rightEngine.N1 = g_leftEngine.N1 + ((rand() % 3 - 1) * 0.05); // 小幅随机波动
-
-            // 燃油流速逐步逼近目标值
-            g_leftEngine.FF += (g_leftEngine.targetFF - g_leftEngine.FF) * smoothingFactor;
-            g_rightEngine.FF = g_leftEngine.FF + ((rand() % 3 - 1) * 0.03);
-
-            // 温度逐步逼近目标值
-            g_leftEngine.T += (g_leftEngine.targetT - g_leftEngine.T) * smoothingFactor;
-            g_rightEngine.T = g_leftEngine.T + ((rand() % 3 - 1) * 0.5);
-
-            if (abs(g_leftEngine.targetFF - g_leftEngine.FF) < 0.01
-                && abs(g_leftEngine.targetN1 - g_leftEngine.N1) < 0.01
-                && abs(g_leftEngine.targetT - g_leftEngine.T) < 0.01) g_state.thrustAdjust = 0;
+        else if (!strcmp(argv[i], "--fps") && hasValue) {
+            fps = atof(argv[++i]); // 帧率上限，与物理频率无关
         }
-    }
-    else if (g_state.state == ENGINE_STOPPING) {
-        g_state.thrustAdjust = 0;
-        // 燃油流速直接归零
-        g_leftEngine.FF = 0;
-        g_rightEngine.FF = 0;
-
-        // 初始化停止状态时的初始值
-        static double initialN1 = 0.0; // 停止时的转速起点
-        static double initialT = 0.0;  // 停止时的温度起点
-
-        if (g_state.state_changed) {
-            g_state.state_changed = false; // 防止多次初始化
-            initialN1 = g_leftEngine.N1;   // 记录当前转速
-            initialT = g_leftEngine.T;     // 记录当前温度
-            g_stopTime = now;              // 记录停止开始时间
+        else if (!strcmp(argv[i], "--full-redraw")) {
+            g_fullRedraw = true;
         }
-
-        double elapsedTime = (now - g_stopTime) / 1000.0;
-        double logFactor = log10(elapsedTime + 1) / log10(4 + 1); // 对数归一化
-
-        // 转速下降
-        g_leftEngine.N1 = initialN1 * (1 - logFactor); // 从初始值下降
-        g_rightEngine.N1 = g_leftEngine.N1;
-
-        // 温度下降
-        g_leftEngine.T = 20 + (initialT - 20) * (1 - logFactor); // 从初始值下降到 20
-        g_rightEngine.T = g_leftEngine.T;
-
-        // 停止条件
-        if (g_leftEngine.N1 <= 1.0) {
-            g_state.state = ENGINE_OFF; // 切换到关闭状态
-            g_state.run_light_on = false; // 关闭运行灯
-            g_state.state_changed = true;
+        else if (!strcmp(argv[i], "--trace") && hasValue) {
+            g_tracePath = argv[++i];
         }
-    }
-
-    // 燃油余量C = 上一时刻C - FF*dt, FF为总流量(简单处理)
-    double avgFF = (g_leftEngine.FF + g_rightEngine.FF) * 0.5;
-    if (!g_fuel.fuelSensorFail && g_state.state != ENGINE_OFF) {
-        g_fuel.C -= avgFF * dt;
-        if (g_fuel.C < 0) g_fuel.C = 0;
-    }
-
-    // 若N1下降至95以下，run灯熄灭，回升后再次亮起
-    if (g_state.stabilized && (g_leftEngine.N1 < 95 && g_rightEngine.N1 < 95)) {
-        g_state.run_light_on = false;
-    }
-    else if (g_state.stabilized && (g_leftEngine.N1 >= 95 || g_rightEngine.N1 >= 95)) {
-        g_state.run_light_on = true;
-    }
-
-    // 写入数据文件
-    g_dataFile << (now - g_startTime) << ","
-        << g_leftEngine.N1 << "," << g_rightEngine.N1 << ","
-        << g_leftEngine.T << "," << g_rightEngine.T << ","
-        << g_leftEngine.FF << "," << g_rightEngine.FF << ","
-        << g_fuel.C << "\n";
-    g_dataFile.flush();
-}
-
-// 检查鼠标点击按钮
-void checkMouse() {
-    ExMessage msg;
-    while (peekmessage(&msg)) {
-        if (msg.message == WM_LBUTTONDOWN) {
-            int mx = msg.x, my = msg.y;
-            // 检测stop按钮
-            if (g_state.state == ENGINE_STARTING || ENGINE_RUNNING) {
-                if (mx > btnStop.x && mx<btnStop.x + btnStop.w && my>btnStop.y && my < btnStop.y + btnStop.h) {
-                    g_state.state = ENGINE_STOPPING;
-                    g_stopTime = GetTickCount();
-                    g_state.state_changed = true;
-                    // Stop优先级最高
-                }
-            }
-            // 检测start按钮
-            if (g_state.state == ENGINE_OFF) {
-                if (mx > btnStart.x && mx<btnStart.x + btnStart.w && my>btnStart.y && my < btnStart.y + btnStart.h) {
-                    g_state.state = ENGINE_STARTING;
-                    g_state.started = true;
-                    g_state.start_light_on = true;
-                    g_state.run_light_on = false;
-                    g_startTime = GetTickCount(); //重新计时
-                    g_state.state_changed = true;
-                }
-            }
-            if (g_state.state == ENGINE_RUNNING) {
-                // 增加推力
-                if (mx > btnUp.x && mx<btnUp.x + btnUp.w && my>btnUp.y && my < btnUp.y + btnUp.h) {
-                    g_state.thrustAdjust = 1;
-                    g_leftEngine.targetN1 = g_leftEngine.N1 * (1.03 + ((rand() % 3) * 0.01)); // 目标转速增加3%-5%
-                    g_rightEngine.targetN1 = g_leftEngine.targetN1; // 同步右引擎
-                    g_leftEngine.targetFF = g_leftEngine.FF + 1; // 燃油流速目标值增加1
-                    g_rightEngine.targetFF = g_leftEngine.targetFF;
-                    g_leftEngine.targetT = g_leftEngine.T * (1.03 + ((rand() % 3) * 0.01)); // 温度目标值增加3%-5%
-                    g_rightEngine.targetT = g_leftEngine.targetT;
-                }
-                // 减小推力
-                if (mx > btnDown.x && mx<btnDown.x + btnDown.w && my>btnDown.y && my < btnDown.y + btnDown.h) {
-                    g_state.thrustAdjust = -1;
-                    g_leftEngine.targetN1 = g_leftEngine.N1 * (0.97 - ((rand() % 3) * 0.01)); // 目标转速减少3%-5%
-                    g_rightEngine.targetN1 = g_leftEngine.targetN1; // 同步右引擎
-                    g_leftEngine.targetFF = g_leftEngine.FF - 1; // 燃油流速目标值减少1
-                    g_rightEngine.targetFF = g_leftEngine.targetFF;
-                    g_leftEngine.targetT = g_leftEngine.T * (0.97 - ((rand() % 3) * 0.01)); // 温度目标值减少3%-5%
-                    g_rightEngine.targetT = g_leftEngine.targetT;
-                }
+        else if (!strcmp(argv[i], "--bus") && hasValue) {
+            g_busName = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--trend") && hasValue) {
+            g_trendSeconds = atof(argv[++i]) * 60;
+        }
+        else if (!strcmp(argv[i], "--scenario") && hasValue) {
+            Scenario sc;
+            std::string error;
+            if (!scenarioLoad(argv[++i], sc, error)) {
+                fprintf(stderr, "%s: %s\n", argv[i], error.c_str());
+                return 1;
             }
-            for (auto& fd : g_faultDisplays) {
-                if (mx > fd.x && mx < fd.x + fd.w && my > fd.y && my < fd.y + fd.h) {
-                    // 切换按钮状态
-                    fd.isActive = !fd.isActive;
-
-                    // 根据激活状态设置故障效果
-                    if (fd.isActive) {
-                        if (fd.ft == N1S1_FAIL) g_leftEngine.n1Sensor1Fail = true;
-                        if (fd.ft == N1S2_FAIL) g_leftEngine.n1Sensor1Fail = g_leftEngine.n1Sensor2Fail = true;
-                        if (fd.ft == EGTS1_FAIL) g_leftEngine.egtSensor1Fail = true;
-                        if (fd.ft == EGTS2_FAIL) g_leftEngine.egtSensor1Fail = g_leftEngine.egtSensor2Fail = true;
-                        if (fd.ft == N1S_FAIL) {
-                            g_leftEngine.n1Sensor1Fail = true;
-                            g_leftEngine.n1Sensor2Fail = true;
-                            g_rightEngine.n1Sensor1Fail = true;
-                            g_rightEngine.n1Sensor2Fail = true;
-                            g_stopTime = GetTickCount();
-                        }
-                        if (fd.ft == EGTS_FAIL) {
-                            g_leftEngine.egtSensor1Fail = true;
-                            g_leftEngine.egtSensor2Fail = true;
-                            g_rightEngine.egtSensor1Fail = true;
-                            g_rightEngine.egtSensor2Fail = true;
-                            g_stopTime = GetTickCount();
-                        }
-                        if (fd.ft == FUELS_FAIL) g_fuel.fuelSensorFail = true;
-
-                        if (fd.ft == LOW_FUEL) g_fuel.C = 998;
-                        if (fd.ft == OVER_FF) g_leftEngine.FF = g_rightEngine.FF = 52;
-                        if (fd.ft == OVER_SPD1) g_leftEngine.N1 = g_rightEngine.N1 = 107;
-                        if (fd.ft == OVER_SPD2) g_leftEngine.N1 = g_rightEngine.N1 = 122;
-                        if (fd.ft == OVER_TEMP3) g_leftEngine.T = g_rightEngine.T = 952;
-                        if (fd.ft == OVER_TEMP4) g_leftEngine.T = g_rightEngine.T = 1102;
-                    }
-                    else {
-                        // 取消故障效果（假设重置为正常状态）
-                        if (fd.ft == N1S1_FAIL) g_leftEngine.n1Sensor1Fail = false;
-                        if (fd.ft == N1S2_FAIL) g_leftEngine.n1Sensor1Fail = g_leftEngine.n1Sensor2Fail = false;
-                        if (fd.ft == EGTS1_FAIL) g_leftEngine.egtSensor1Fail = false;
-                        if (fd.ft == EGTS2_FAIL) g_leftEngine.egtSensor1Fail = g_leftEngine.egtSensor2Fail = false;
-                        if (fd.ft == N1S_FAIL) {
-                            g_leftEngine.n1Sensor1Fail = false;
-                            g_leftEngine.n1Sensor2Fail = false;
-                            g_rightEngine.n1Sensor1Fail = false;
-                            g_rightEngine.n1Sensor2Fail = false;
-                        }
-                        if (fd.ft == EGTS_FAIL) {
-                            g_leftEngine.egtSensor1Fail = false;
-                            g_leftEngine.egtSensor2Fail = false;
-                            g_rightEngine.egtSensor1Fail = false;
-                            g_rightEngine.egtSensor2Fail = false;
-                        }
-                        if (fd.ft == FUELS_FAIL) g_fuel.fuelSensorFail = false;
-
-                        if (fd.ft == LOW_FUEL) g_fuel.C = 3000; // 重置为正常油量
-                        if (fd.ft == OVER_FF) g_leftEngine.FF = g_rightEngine.FF = 40;
-                        if (fd.ft == OVER_SPD1 || fd.ft == OVER_SPD2) g_leftEngine.N1 = g_rightEngine.N1 = 95; // 正常转速
-                        if (fd.ft == OVER_TEMP1 || fd.ft == OVER_TEMP2 || fd.ft == OVER_TEMP3 || fd.ft == OVER_TEMP4)
-                            g_leftEngine.T = g_rightEngine.T = 730; // 正常温度
-                    }
-                }
+            // 面板只有双发单油箱；其他构型用 engine_headless / scenarios 运行
+            if (sc.engines != SIM_DEFAULT_ENGINES || sc.tanks != 1) {
+                fprintf(stderr, "%s: the panel shows %d engines and one tank\n", argv[i], (int)SIM_DEFAULT_ENGINES);
+                return 1;
             }
-        }
-        else if (msg.message == WM_CLOSE) {
-            g_quit = true;
+            g_scenarioSeed = sc.seed;
+            g_commands.pushAll(sc);
         }
     }
-}
-
-// 绘制主界面
-void drawUI() {
-    setfillcolor(BLACK);
-    solidrectangle(0, 0, g_width, g_height);
-
-    // 当前故障检查并绘制数据
-    checkFault();
-    // 绘制告警框
-    drawFaultDisplays();
-    // 绘制四个按钮
-    drawButton(btnStart);
-    drawButton(btnStop);
-    drawButton(btnUp);
-    drawButton(btnDown);
-
-    // 绘制状态start/run灯
-    drawStatusBoxes();
-
-    // 绘制底部文本框
-    drawTextArea();
-}
-
-int main() {
+    if (hz <= 0) hz = 1000;
+    if (fps <= 0) fps = 60;
+    if (g_trendSeconds <= 0) g_trendSeconds = 600;
+    g_physics = FixedStepScheduler(1.0 / hz, 1.0 / hz);
+    g_history.reset(g_physics.stepSeconds());
+    g_frames = FixedStepScheduler(1.0 / fps, 1.0 / fps);
+    timeBeginPeriod(1); // Sleep 精度提高到 1ms
     initgraph(g_width, g_height);
     initData();
     SetWorkingImage();
     setbkcolor(BLACK);
     cleardevice();
+    buildPanelLayers();
 
     // 双缓冲
     BeginBatchDraw();
-    DWORD frame_start;
+    TRACE_THREAD_NAME("main");
+    g_view.sim = g_sim;
+    std::thread input(inputThread);
+    std::thread sim;
+    if (!g_replayMode) sim = std::thread(simThread);
 
     while (!g_quit) {
-        frame_start = GetTickCount();
-        checkMouse();
-        updateData();
-        drawUI();
-        EndBatchDraw();
-        Sleep(5);
-        BeginBatchDraw();
+        {
+            TRACE_ZONE("waitFrame");
+            g_frames.waitFrame();
+        }
+        TRACE_ZONE("frame");
+        if (g_replayMode) {
+            TRACE_ZONE("replay");
+            checkReplayKeys();
+            stepReplay(g_frames.frameSeconds());
+        }
+        else {
+            drainTrends();
+            if (!g_snapshot.read(g_view)) continue;
+        }
+        {
+            TRACE_ZONE("drawUI");
+            if (g_fullRedraw) drawUI();
+            else drawPanel();
+        }
+        TRACE_ZONE("present");
+        presentPanel();
     }
 
-    g_dataFile.close();
-    g_logFile.close();
+    // 输入线程在收到关窗消息后已退出循环
+    input.join();
+    if (sim.joinable()) sim.join();
+    timeEndPeriod(1);
+    g_telemetry.close();
+    g_bus.close();
     closegraph();
+    if (g_tracePath && !traceWrite(g_tracePath)) {
+        fprintf(stderr, traceEnabled() ? "cannot write %s\n" : "built without ENGINE_TRACE, %s not written\n", g_tracePath);
+    }
     return 0;
 }
@@ -0,0 +1,27 @@
+﻿#pragma once
+// 只读内存映射文件（Windows: CreateFileMapping，其它: mmap）
+#include <cstddef>
+#include <cstdint>
+
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    bool open(const char* path);
+    void close();
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const uint8_t* m_data;
+    size_t m_size;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_fd;
+#endif
+};
@@ -0,0 +1,75 @@
+﻿#pragma once
+// 多生产者/单消费者无锁有界队列（Vyukov 有界队列的单消费者版本）
+//
+// 每个槽位带一个序号：等于写入位置表示空闲，等于写入位置 + 1 表示已写好。
+// 生产者之间只用一次 CAS 争抢写入位置，写完后发布序号；消费者不做原子读改写。
+// 满时 push 返回 false，不阻塞。
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+template <class T>
+class MpscQueue {
+public:
+    // 容量向上取整为 2 的幂
+    explicit MpscQueue(size_t capacity = 1024) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        m_cells = std::vector<Cell>(n);
+        for (size_t i = 0; i < n; i++) m_cells[i].seq.store(i, std::memory_order_relaxed);
+        m_mask = n - 1;
+    }
+
+    size_t capacity() const { return m_cells.size(); }
+
+    // 任意线程调用；满时返回 false
+    bool push(const T& v) {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = m_cells[pos & m_mask];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                // 槽位空闲，抢到写入位置后再写
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = v;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false; // 消费者还没取走上一轮的数据
+            }
+            else {
+                pos = m_head.load(std::memory_order_relaxed); // 被其他生产者抢先
+            }
+        }
+    }
+
+    // 消费者调用；一次取出至多 max 条。已抢到位置但尚未写完的数据留到下次
+    size_t popBatch(T* out, size_t max) {
+        size_t n = 0;
+        while (n < max) {
+            Cell& c = m_cells[m_tail & m_mask];
+            if (c.seq.load(std::memory_order_acquire) != m_tail + 1) break;
+            out[n++] = c.value;
+            c.seq.store(m_tail + m_mask + 1, std::memory_order_release);
+            m_tail++;
+        }
+        return n;
+    }
+
+    bool pop(T& out) { return popBatch(&out, 1) == 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+    std::vector<Cell> m_cells;
+    size_t m_mask;
+    // 生产者共享的写入位置与消费者的读取位置分处不同缓存行
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) size_t m_tail = 0;
+};
@@ -0,0 +1,250 @@
+﻿#include "panel.h"
+#include <cstdio>
+
+// 按钮的坐标和尺寸
+const PanelButton g_panelButtons[PANEL_BUTTON_COUNT] = {
+    { 250, 300, 80, 40, "START" },
+    { 350, 300, 80, 40, "STOP" },
+    { 450, 200, 30, 30, "▲" },
+    { 450, 240, 30, 30, "▼" }
+};
+
+// 状态告警框的布局
+static const int g_faultX = 50;
+static const int g_faultY = 350;
+const PanelFaultBox g_panelFaultBoxes[PANEL_FAULT_BOX_COUNT] = {
+    {"N1S1Fail",   g_faultX,g_faultY,80,25,N1S1_FAIL},
+    {"N1S2Fail",   g_faultX + 100,g_faultY,80,25,N1S2_FAIL},
+    {"EGTS1Fail",  g_faultX + 200,g_faultY,80,25,EGTS1_FAIL},
+    {"EGTS2Fail",  g_faultX + 300,g_faultY,80,25,EGTS2_FAIL},
+    {"N1SFail",    g_faultX,g_faultY + 30,80,25,N1S_FAIL},
+    {"EGTSFail",   g_faultX + 100,g_faultY + 30,80,25,EGTS_FAIL},
+    {"LowFuel",    g_faultX + 200,g_faultY + 30,80,25,LOW_FUEL},
+    {"FuelSFail",  g_faultX + 300,g_faultY + 30,80,25,FUELS_FAIL},
+    {"OverSpd1",   g_faultX,g_faultY + 60,80,25,OVER_SPD1},
+    {"OverSpd2",   g_faultX + 100,g_faultY + 60,80,25,OVER_SPD2},
+    {"OverFF",     g_faultX + 200,g_faultY + 60,80,25,OVER_FF},
+    {"OverTemp1",  g_faultX,g_faultY + 90,80,25,OVER_TEMP1},
+    {"OverTemp2",  g_faultX + 100,g_faultY + 90,80,25,OVER_TEMP2},
+    {"OverTemp3",  g_faultX + 200,g_faultY + 90,80,25,OVER_TEMP3},
+    {"OverTemp4",  g_faultX + 300,g_faultY + 90,80,25,OVER_TEMP4}
+};
+
+int panelButtonAt(int x, int y) {
+    for (int i = 0; i < PANEL_BUTTON_COUNT; i++) {
+        const PanelButton& b = g_panelButtons[i];
+        if (x > b.x && x < b.x + b.w && y > b.y && y < b.y + b.h) return i;
+    }
+    return -1;
+}
+
+int panelFaultBoxAt(int x, int y) {
+    for (int i = 0; i < PANEL_FAULT_BOX_COUNT; i++) {
+        const PanelFaultBox& b = g_panelFaultBoxes[i];
+        if (x > b.x && x < b.x + b.w && y > b.y && y < b.y + b.h) return i;
+    }
+    return -1;
+}
+
+// 假定0%对应0°，满量程(如N1=125)对应210°。
+double valueToAngle(double val, double maxVal) {
+    if (val < 0) val = 0;
+    if (val > maxVal) val = maxVal;
+    double ratio = val / maxVal;
+    return 210.0 * ratio;
+}
+
+double valueToAngleT(double val, double /*maxVal*/) {
+    // EGT同理0~1200°C -> 0~210°
+    if (val < -5) val = -5;
+    if (val > 1200) val = 1200;
+    double ratio = (val + 5) / (1200 + 5); // shift to start from 0
+    return 210.0 * ratio;
+}
+
+PanelColor faultColor(FaultType ft, bool sensorValueInvalid) {
+    // 根据异常严重程度返回颜色
+    // 无效值用灰色表示
+    // 警告值红色，警戒值琥珀色，正常白色
+    switch (ft) {
+    case N1S1_FAIL:
+    case EGTS1_FAIL:
+        return panelRgb(255, 255, 255); //白色警告（传感器单个故障）
+    case EGTS2_FAIL:
+    case N1S2_FAIL: // 单发传感器全废，算警戒
+    case LOW_FUEL:
+    case OVER_FF:
+    case OVER_SPD1:
+    case OVER_TEMP1:
+    case OVER_TEMP3:
+        return panelRgb(255, 140, 0); // 琥珀色
+    case N1S_FAIL:
+    case EGTS_FAIL:
+    case FUELS_FAIL:
+    case OVER_SPD2:
+    case OVER_TEMP2:
+    case OVER_TEMP4:
+        return panelRgb(255, 0, 0); // 红色
+    default:
+        if (sensorValueInvalid)
+            return panelRgb(128, 128, 128); //灰色
+        return panelRgb(255, 255, 255); //正常白
+    }
+}
+
+bool gaugeReading(char* buf, double value, bool isEGT, FaultType ft, PanelColor& col) {
+    // 根据故障类型或异常判断颜色
+    col = ft != NO_FAULT ? faultColor(ft) : PANEL_WHITE;
+    if (ft == N1S2_FAIL || ft == N1S_FAIL || ft == EGTS2_FAIL || ft == EGTS_FAIL) {
+        sprintf(buf, "--");
+        return false;
+    }
+    if (isEGT) sprintf(buf, "%d", (int)value);
+    else sprintf(buf, "%.1f", value);
+    return true;
+}
+
+// 表盘刻度：基准线与 0~210° 圆弧
+void drawGaugeDial(PanelRenderer& r, int centerX, int centerY) {
+    int radius = 60;
+    r.line(centerX, centerY, centerX + radius, centerY, PANEL_WHITE);
+    r.arc(centerX, centerY, radius, -3.66519137, 0, PANEL_WHITE);
+}
+
+// 表盘读数与指针扇形
+void drawGaugeValue(PanelRenderer& r, int centerX, int centerY, double angle, double value, bool isEGT, FaultType ft) {
+    int radius = 60;
+    double sweepRad = angle * 3.1415926 / 180.0;
+    char buf[32];
+    PanelColor col;
+    bool valid = gaugeReading(buf, value, isEGT, ft, col);
+    // 绘制数值文本
+    r.text(centerX + 10, centerY - 20, 20, col, buf);
+    //扇形
+    if (!valid || (int)angle == 0) return;
+    r.fillPie(centerX, centerY, radius, -sweepRad, 0, col);
+}
+
+// 表盘背景和指针
+void drawGauge(PanelRenderer& r, int centerX, int centerY, double angle, double value, bool isEGT, FaultType ft) {
+    drawGaugeDial(r, centerX, centerY);
+    drawGaugeValue(r, centerX, centerY, angle, value, isEGT, ft);
+}
+
+void drawButton(PanelRenderer& r, const PanelButton& btn, bool pressed) {
+    r.fillRect(btn.x, btn.y, btn.x + btn.w, btn.y + btn.h, pressed ? panelRgb(200, 200, 200) : panelRgb(100, 100, 255));
+    r.text(btn.x + 5, btn.y + 5, 20, PANEL_BLACK, btn.text);
+}
+
+void drawFaultBox(PanelRenderer& r, const PanelFaultBox& box, bool active) {
+    PanelColor col = active ? PANEL_WHITE : panelRgb(128, 128, 128); // 激活亮白，未激活灰色
+    r.fillRect(box.x, box.y, box.x + box.w, box.y + box.h, panelRgb(50, 50, 50));
+    r.text(box.x + 5, box.y + 5, 15, col, box.text);
+}
+
+void drawStatusBoxes(PanelRenderer& r, bool startOn, bool runOn) {
+    // 若start灯亮，画蓝色背景
+    // run灯亮，画绿色背景
+    // 若不亮，画深色背景
+    int xstart = 50, ystart = 300;
+    r.fillRect(xstart, ystart, xstart + 60, ystart + 25, startOn ? panelRgb(0, 0, 255) : panelRgb(50, 50, 50));
+    r.text(xstart + 5, ystart + 2, 20, PANEL_BLACK, "START");
+    r.fillRect(xstart + 70, ystart, xstart + 70 + 60, ystart + 25, runOn ? panelRgb(0, 255, 0) : panelRgb(50, 50, 50));
+    r.text(xstart + 75, ystart + 2, 20, PANEL_BLACK, "RUN");
+}
+
+void drawFFInfo(PanelRenderer& r, double ff, FaultType ft) {
+    int x = 500, y = 100;
+    r.text(x - 50, y - 20, 20, PANEL_WHITE, "Fuel Flow:");
+    char buf[32];
+    sprintf(buf, "%.0f", ff);
+    r.text(x + 50, y - 20, 20, ft == OVER_FF ? faultColor(ft) : PANEL_WHITE, buf);
+}
+
+void drawFuelInfo(PanelRenderer& r, double c, FaultType ft) {
+    int x = 500, y = 100;
+    r.text(x - 50, y + 10, 20, PANEL_WHITE, "Fuel:");
+    char buf[32];
+    if (ft == FUELS_FAIL) sprintf(buf, "--");
+    else sprintf(buf, "%.0f", c);
+    r.text(x, y + 10, 20, ft == FUELS_FAIL || ft == LOW_FUEL ? faultColor(ft) : PANEL_WHITE, buf);
+}
+
+// 警示文本框背景
+void drawTextBackground(PanelRenderer& r) {
+    r.fillRoundRect(50, 500, 500, 620, 10, panelRgb(50, 50, 50));
+}
+
+// 未过期的告警（过期清理在 simStep 中完成），超出文本框的不画
+void drawAlertText(PanelRenderer& r, const AlertTable& alerts) {
+    int yOffset = 510;
+    for (const auto& alert : alerts) {
+        r.text(60, yOffset, 20, faultColor(alert.type), alert.text);
+        yOffset += 25;
+        if (yOffset > 590) break;
+    }
+}
+
+void drawPanelFrame(PanelRenderer& r, const SimState& sim, const TelemetrySample& s) {
+    r.fillRect(0, 0, PANEL_WIDTH, PANEL_HEIGHT, PANEL_BLACK);
+
+    // 当前数据和故障状态
+    const SimFaults& f = sim.faults;
+    drawFuelInfo(r, s.fuel, f.fuel);
+    drawFFInfo(r, (s.FF[SIM_LEFT] + s.FF[SIM_RIGHT]) * 0.5, f.ff);
+    // 左、右N1
+    drawGauge(r, 100, 100, valueToAngle(s.N1[SIM_LEFT]), s.N1[SIM_LEFT], false, f.n1[SIM_LEFT]);
+    drawGauge(r, 300, 100, valueToAngle(s.N1[SIM_RIGHT]), s.N1[SIM_RIGHT], false, f.n1[SIM_RIGHT]);
+    // 左、右EGT
+    drawGauge(r, 100, 200, valueToAngleT(s.T[SIM_LEFT]), s.T[SIM_LEFT], true, f.egt[SIM_LEFT]);
+    drawGauge(r, 300, 200, valueToAngleT(s.T[SIM_RIGHT]), s.T[SIM_RIGHT], true, f.egt[SIM_RIGHT]);
+
+    // 告警框按当前注入状态绘制（点击与脚本都可能改变）
+    for (const PanelFaultBox& box : g_panelFaultBoxes) drawFaultBox(r, box, simFaultInjected(sim, box.ft));
+    for (const PanelButton& btn : g_panelButtons) drawButton(r, btn);
+    drawStatusBoxes(r, sim.state.start_light_on, sim.state.run_light_on);
+
+    drawTextBackground(r);
+    drawAlertText(r, sim.alerts);
+}
+
+// 一条趋势图：量程 lo~hi 映射到图高，超出的截到边界
+static void drawTrendPlot(PanelRenderer& r, const TrendHistory& h, double spanSeconds, int top, const char* label,
+    const int* channels, const PanelColor* colors, int count, double lo, double hi) {
+    int left = PANEL_TREND_X, bottom = top + PANEL_TREND_H - 1;
+    r.fillRect(left, top, left + PANEL_TREND_W - 1, bottom, panelRgb(30, 30, 30));
+    TrendPoint points[PANEL_TREND_W];
+    auto toY = [&](float v) {
+        double k = (v - lo) / (hi - lo);
+        if (k < 0) k = 0;
+        if (k > 1) k = 1;
+        return bottom - (int)(k * (PANEL_TREND_H - 1) + 0.5);
+    };
+    for (int i = 0; i < count; i++) {
+        h.query(channels[i], spanSeconds, points, PANEL_TREND_W);
+        for (int x = 0; x < PANEL_TREND_W; x++) {
+            if (points[x].valid) r.line(left + x, toY(points[x].max), left + x, toY(points[x].min), colors[i]);
+        }
+    }
+    r.text(left + 2, top + 1, 12, panelRgb(128, 128, 128), label);
+}
+
+void drawTrends(PanelRenderer& r, const TrendHistory& h, double spanSeconds, const SimConfig& config) {
+    static const PanelColor colors[SIM_MAX_ENGINES] = {
+        PANEL_WHITE, panelRgb(0, 255, 255), panelRgb(255, 255, 0), panelRgb(255, 0, 255)
+    };
+    // 与表盘、读数相同的量程
+    static const struct { const char* label; double lo, hi; } plots[TREND_SIGNALS] = {
+        { "N1", 0, 125 }, { "EGT", -5, 1200 }, { "FF", 0, 50 }
+    };
+    int channels[SIM_MAX_ENGINES];
+    int top = PANEL_TREND_Y;
+    for (int sig = 0; sig < TREND_SIGNALS; sig++) {
+        for (int i = 0; i < config.engineCount; i++) channels[i] = trendChannel(sig, i);
+        drawTrendPlot(r, h, spanSeconds, top, plots[sig].label, channels, colors, config.engineCount, plots[sig].lo, plots[sig].hi);
+        top += PANEL_TREND_H + PANEL_TREND_GAP;
+    }
+    int fuel = TREND_FUEL;
+    PanelColor fuelColor = panelRgb(0, 255, 0);
+    drawTrendPlot(r, h, spanSeconds, top, "Fuel", &fuel, &fuelColor, 1, 0, config.tankCapacity * config.tankCount);
+}
@@ -0,0 +1,77 @@
+﻿#pragma once
+// 仪表面板的布局与绘制：不依赖图形库，全部经 PanelRenderer 接口输出。
+// main.exe 用 EasyX 实现该接口画到窗口；soft_render.h 的软件光栅器画到内存帧缓冲，可在任意平台输出图片
+#include "sim_core.h"
+#include "trend_history.h"
+#include <cstdint>
+
+// 颜色 0xRRGGBB
+typedef uint32_t PanelColor;
+constexpr PanelColor panelRgb(int r, int g, int b) { return (PanelColor)((r << 16) | (g << 8) | b); }
+constexpr PanelColor PANEL_WHITE = 0xFFFFFF;
+constexpr PanelColor PANEL_BLACK = 0x000000;
+
+// 绘图接口。坐标为像素，矩形含右下边界；角度为弧度，自 x 轴正向逆时针（与 EasyX 相同）
+class PanelRenderer {
+public:
+    virtual ~PanelRenderer() {}
+    virtual void line(int x0, int y0, int x1, int y1, PanelColor c) = 0;
+    virtual void arc(int cx, int cy, int r, double startAngle, double endAngle, PanelColor c) = 0;
+    virtual void fillPie(int cx, int cy, int r, double startAngle, double endAngle, PanelColor c) = 0;
+    virtual void fillRect(int left, int top, int right, int bottom, PanelColor c) = 0;
+    // corner 为圆角的直径
+    virtual void fillRoundRect(int left, int top, int right, int bottom, int corner, PanelColor c) = 0;
+    // 透明背景的文字，(x, y) 为左上角，height 为字高
+    virtual void text(int x, int y, int height, PanelColor c, const char* s) = 0;
+};
+
+enum { PANEL_WIDTH = 600, PANEL_HEIGHT = 650 };
+
+// 按钮
+struct PanelButton {
+    int x, y, w, h;
+    const char* text;
+};
+enum { PANEL_BTN_START, PANEL_BTN_STOP, PANEL_BTN_UP, PANEL_BTN_DOWN, PANEL_BUTTON_COUNT };
+extern const PanelButton g_panelButtons[PANEL_BUTTON_COUNT];
+
+// 告警框（点击注入/取消对应故障）
+struct PanelFaultBox {
+    const char* text;
+    int x, y, w, h;
+    FaultType ft;
+};
+enum { PANEL_FAULT_BOX_COUNT = 15 };
+extern const PanelFaultBox g_panelFaultBoxes[PANEL_FAULT_BOX_COUNT];
+
+// 命中的按钮/告警框编号，-1 为未命中
+int panelButtonAt(int x, int y);
+int panelFaultBoxAt(int x, int y);
+
+// 根据异常类型返回颜色
+PanelColor faultColor(FaultType ft, bool sensorValueInvalid = false);
+// 角度转换：N1与T的指示范围为0°~210°
+double valueToAngle(double val, double maxVal = 125.0);
+double valueToAngleT(double val, double maxVal = 1200.0);
+// 表盘读数文本与颜色；故障导致数值无效时为 "--"，返回 false（不画扇形）
+bool gaugeReading(char* buf, double value, bool isEGT, FaultType ft, PanelColor& col);
+
+// 面板各部分
+void drawGaugeDial(PanelRenderer& r, int centerX, int centerY);
+void drawGaugeValue(PanelRenderer& r, int centerX, int centerY, double angle, double value, bool isEGT, FaultType ft);
+void drawGauge(PanelRenderer& r, int centerX, int centerY, double angle, double value, bool isEGT, FaultType ft = NO_FAULT);
+void drawButton(PanelRenderer& r, const PanelButton& btn, bool pressed = false);
+void drawFaultBox(PanelRenderer& r, const PanelFaultBox& box, bool active);
+void drawStatusBoxes(PanelRenderer& r, bool startOn, bool runOn);
+void drawFFInfo(PanelRenderer& r, double ff, FaultType ft);
+void drawFuelInfo(PanelRenderer& r, double c, FaultType ft);
+void drawTextBackground(PanelRenderer& r);
+void drawAlertText(PanelRenderer& r, const AlertTable& alerts);
+
+// 整个面板（不含底部信息行）：数值取自 s（可为插值结果），故障、灯、告警与注入状态取自 sim（可为仿真线程发布的快照）
+void drawPanelFrame(PanelRenderer& r, const SimState& sim, const TelemetrySample& s);
+
+// 趋势图：告警框右侧自上而下 N1、EGT、FF、燃油四条，每个像素列画该时段的最小~最大值，各发动机一种颜色
+enum { PANEL_TREND_X = 445, PANEL_TREND_Y = 350, PANEL_TREND_W = 150, PANEL_TREND_H = 32, PANEL_TREND_GAP = 4 };
+// 最近 spanSeconds 秒的历史；发动机台数与燃油量程取自 config
+void drawTrends(PanelRenderer& r, const TrendHistory& h, double spanSeconds, const SimConfig& config);
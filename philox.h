@@ -0,0 +1,121 @@
+﻿#pragma once
+// 计数器型随机数 Philox4x32-10（Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3"）
+//
+// 输出只由 (密钥, 计数器) 决定，没有需要顺序推进的状态：
+// 密钥取 (种子, 发动机编号)，计数器取 (tick, 组号, 通道)，任意发动机、任意 tick 的
+// 随机数都可以单独算出，因此能批量、并行生成，且与线程数和计算顺序无关。
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+struct Philox4x32 {
+    uint32_t v[4];
+};
+
+// 一轮：两次 32x32->64 乘法加异或，密钥按黄金分割常数递增
+static inline void philoxRound(uint32_t& x0, uint32_t& x1, uint32_t& x2, uint32_t& x3, uint32_t& k0, uint32_t& k1) {
+    uint64_t p0 = (uint64_t)0xD2511F53u * x0;
+    uint64_t p1 = (uint64_t)0xCD9E8D57u * x2;
+    x0 = (uint32_t)(p1 >> 32) ^ x1 ^ k0;
+    x1 = (uint32_t)p1;
+    x2 = (uint32_t)(p0 >> 32) ^ x3 ^ k1;
+    x3 = (uint32_t)p0;
+    k0 += 0x9E3779B9u;
+    k1 += 0xBB67AE85u;
+}
+
+static inline Philox4x32 philox4x32(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint32_t k0, uint32_t k1) {
+    for (int round = 0; round < 10; round++) philoxRound(c0, c1, c2, c3, k0, k1);
+    Philox4x32 r = { { c0, c1, c2, c3 } };
+    return r;
+}
+
+// 取高 15 位，与 rand() 的取值范围 0~32767 相同；
+// 之后的 % 3、% 201 与原来 rand() 的分布完全一致
+static inline int philoxRand15(uint32_t x) {
+    return (int)(x >> 17);
+}
+
+// 两个 32 位随机数变为一对独立标准正态数（Box-Muller）
+static inline void philoxNormal2(uint32_t x0, uint32_t x1, double& z0, double& z1) {
+    double u1 = (x0 + 0.5) / 4294967296.0;
+    double u2 = (x1 + 0.5) / 4294967296.0;
+    double r = sqrt(-2.0 * log(u1));
+    z0 = r * cos(6.283185307179586 * u2);
+    z1 = r * sin(6.283185307179586 * u2);
+}
+
+// 向量版：每条 32 位通道一台发动机。mul_epu32 只乘偶数通道，奇数通道右移后再乘一次，
+// 两次结果按通道拼回高/低 32 位。
+#if defined(__AVX512F__)
+typedef __m512i PhiloxLanes;
+enum { PHILOX_LANES = 16 };
+static inline void philoxMulHiLo(PhiloxLanes a, PhiloxLanes m, PhiloxLanes& hi, PhiloxLanes& lo) {
+    __m512i even = _mm512_mul_epu32(a, m);
+    __m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), m);
+    hi = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+    lo = _mm512_mask_blend_epi32(0xAAAA, even, _mm512_slli_epi64(odd, 32));
+}
+static inline PhiloxLanes philoxSet(uint32_t v) { return _mm512_set1_epi32((int)v); }
+static inline PhiloxLanes philoxXor(PhiloxLanes a, PhiloxLanes b) { return _mm512_xor_si512(a, b); }
+static inline PhiloxLanes philoxAdd(PhiloxLanes a, PhiloxLanes b) { return _mm512_add_epi32(a, b); }
+static inline PhiloxLanes philoxLaneIndex() {
+    return _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+}
+static inline void philoxStore(uint32_t* p, PhiloxLanes v) { _mm512_storeu_si512((void*)p, v); }
+#elif defined(__AVX2__)
+typedef __m256i PhiloxLanes;
+enum { PHILOX_LANES = 8 };
+static inline void philoxMulHiLo(PhiloxLanes a, PhiloxLanes m, PhiloxLanes& hi, PhiloxLanes& lo) {
+    __m256i even = _mm256_mul_epu32(a, m);
+    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+    lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+}
+static inline PhiloxLanes philoxSet(uint32_t v) { return _mm256_set1_epi32((int)v); }
+static inline PhiloxLanes philoxXor(PhiloxLanes a, PhiloxLanes b) { return _mm256_xor_si256(a, b); }
+static inline PhiloxLanes philoxAdd(PhiloxLanes a, PhiloxLanes b) { return _mm256_add_epi32(a, b); }
+static inline PhiloxLanes philoxLaneIndex() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+static inline void philoxStore(uint32_t* p, PhiloxLanes v) { _mm256_storeu_si256((__m256i*)p, v); }
+#endif
+
+// 批量：编号 firstId 起的 n 台发动机在同一计数器下各取一组 4 个数，按列输出
+static inline void philoxBatch(uint32_t seed, uint32_t firstId, size_t n,
+    uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3,
+    uint32_t* out0, uint32_t* out1, uint32_t* out2, uint32_t* out3) {
+    size_t i = 0;
+#if defined(__AVX2__) || defined(__AVX512F__)
+    const PhiloxLanes m0 = philoxSet(0xD2511F53u), m1 = philoxSet(0xCD9E8D57u);
+    const PhiloxLanes w0 = philoxSet(0x9E3779B9u), w1 = philoxSet(0xBB67AE85u);
+    for (; i + PHILOX_LANES <= n; i += PHILOX_LANES) {
+        PhiloxLanes x0 = philoxSet(c0), x1 = philoxSet(c1), x2 = philoxSet(c2), x3 = philoxSet(c3);
+        PhiloxLanes k0 = philoxSet(seed);
+        PhiloxLanes k1 = philoxAdd(philoxSet(firstId + (uint32_t)i), philoxLaneIndex());
+        for (int round = 0; round < 10; round++) {
+            PhiloxLanes hi0, lo0, hi1, lo1;
+            philoxMulHiLo(x0, m0, hi0, lo0);
+            philoxMulHiLo(x2, m1, hi1, lo1);
+            x0 = philoxXor(philoxXor(hi1, x1), k0);
+            x1 = lo1;
+            x2 = philoxXor(philoxXor(hi0, x3), k1);
+            x3 = lo0;
+            k0 = philoxAdd(k0, w0);
+            k1 = philoxAdd(k1, w1);
+        }
+        philoxStore(out0 + i, x0);
+        philoxStore(out1 + i, x1);
+        philoxStore(out2 + i, x2);
+        philoxStore(out3 + i, x3);
+    }
+#endif
+    for (; i < n; i++) {
+        Philox4x32 r = philox4x32(c0, c1, c2, c3, seed, firstId + (uint32_t)i);
+        out0[i] = r.v[0];
+        out1[i] = r.v[1];
+        out2[i] = r.v[2];
+        out3[i] = r.v[3];
+    }
+}
@@ -0,0 +1,365 @@
+﻿#include "query_server.h"
+#include "telemetry.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// 历史数据保留的步数（1kHz 时约 1 分钟）
+enum { QUERY_HISTORY = 1 << 16 };
+// 服务线程取记录的周期：订阅推送的延迟上限
+enum { QUERY_POLL_MS = 2 };
+// 单个客户端待发送数据的上限：超过后不再推送 tick/告警行、截断 history、暂停读取新请求
+constexpr size_t QUERY_MAX_PENDING = 1 << 22;
+enum { QUERY_MAX_LINE = 1024 };
+
+QueryServer::QueryServer()
+    : m_listenFd(-1), m_epollFd(-1), m_wakeFd(-1), m_engineCount(SIM_DEFAULT_ENGINES), m_running(false),
+      m_records(1 << 14), m_dropped(0), m_commands(256), m_historyCount(0), m_hasSample(false) {
+    memset(&m_latest, 0, sizeof(m_latest));
+    alertClear(m_alerts);
+}
+
+QueryServer::~QueryServer() {
+    stop();
+}
+
+void QueryServer::onSample(const TelemetrySample& s) {
+    if (!m_records.push({ s, NO_FAULT })) m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void QueryServer::onFault(int64_t timeMs, FaultType ft) {
+    Record r;
+    memset(&r, 0, sizeof(r));
+    r.s.timeMs = timeMs;
+    r.ft = ft;
+    if (!m_records.push(r)) m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void QueryServer::pollCommands(ScenarioQueue& queue, SimTime now) {
+    ScenarioEvent ev;
+    while (m_commands.pop(ev)) {
+        ev.at = now;
+        queue.push(ev);
+    }
+}
+
+// 逗号分隔的各发动机数值
+static void appendValues(std::string& out, const char* name, const double* v, int n) {
+    char buf[64];
+    out += ' ';
+    out += name;
+    if (n == 0) out += "=-";
+    for (int i = 0; i < n; i++) {
+        snprintf(buf, sizeof(buf), "%c%g", i ? ',' : '=', v[i]);
+        out += buf;
+    }
+}
+
+void QueryServer::formatState(std::string& out) {
+    const TelemetrySample& s = m_latest;
+    char buf[128];
+    snprintf(buf, sizeof(buf), "state t=%lld state=%s fuel=%g", (long long)s.timeMs,
+        m_hasSample ? engineStateName(s.state) : "NONE", s.fuel);
+    out += buf;
+    int n = m_hasSample ? s.engineCount : 0;
+    appendValues(out, "N1", s.N1, n);
+    appendValues(out, "T", s.T, n);
+    appendValues(out, "FF", s.FF, n);
+    out += " alerts=";
+    if (m_alerts.count == 0) out += '-';
+    bool first = true;
+    for (const AlertInfo& a : m_alerts) {
+        if (!first) out += ',';
+        out += faultTypeName(a.type);
+        first = false;
+    }
+    out += '\n';
+}
+
+// 取出仿真线程的记录：更新最新值、历史与告警表，并推送给订阅者
+void QueryServer::drainRecords() {
+    Record batch[256];
+    char line[512];
+    size_t n;
+    while ((n = m_records.popBatch(batch, 256)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            const Record& r = batch[i];
+            if (r.ft != NO_FAULT) {
+                alertTrigger(m_alerts, r.ft, r.s.timeMs * 1000);
+                int len = snprintf(line, sizeof(line), "alert %lld %s\n", (long long)r.s.timeMs, faultTypeName(r.ft));
+                for (Client* c : m_clients) {
+                    if (c->every > 0 && !c->closing && c->out.size() <= QUERY_MAX_PENDING) c->out.append(line, len);
+                }
+                continue;
+            }
+            m_latest = r.s;
+            m_hasSample = true;
+            m_history[m_historyCount++ % QUERY_HISTORY] = r.s;
+            alertExpire(m_alerts, r.s.timeMs * 1000);
+            int len = -1;
+            for (Client* c : m_clients) {
+                if (c->every <= 0 || c->closing || c->phase++ % c->every != 0) continue;
+                if (c->out.size() > QUERY_MAX_PENDING) continue; // 客户端读得太慢，丢弃本行
+                if (len < 0) {
+                    memcpy(line, "tick ", 5);
+                    len = 5 + formatCsvRow(line + 5, sizeof(line) - 5, r.s);
+                }
+                c->out.append(line, len);
+            }
+        }
+    }
+}
+
+void QueryServer::sendHistory(Client& c, double seconds, long every) {
+    uint64_t count = std::min(m_historyCount, (uint64_t)QUERY_HISTORY);
+    int64_t from = m_latest.timeMs - (int64_t)(seconds * 1000);
+    // 从最新一条向前找到起点
+    uint64_t first = m_historyCount;
+    while (first > m_historyCount - count && m_history[(first - 1) % QUERY_HISTORY].timeMs >= from) first--;
+    char line[512];
+    long sent = 0;
+    // 超过上限时截断，"ok <行数>" 给出实际发出的行数
+    for (uint64_t k = first; k < m_historyCount && c.out.size() <= QUERY_MAX_PENDING; k += every) {
+        memcpy(line, "hist ", 5);
+        int len = 5 + formatCsvRow(line + 5, sizeof(line) - 5, m_history[k % QUERY_HISTORY]);
+        c.out.append(line, len);
+        sent++;
+    }
+    snprintf(line, sizeof(line), "ok %ld\n", sent);
+    c.out += line;
+}
+
+void QueryServer::handleLine(Client& c, const std::string& line) {
+    std::string cmd = line.substr(0, line.find(' '));
+    std::string arg = cmd.size() < line.size() ? line.substr(cmd.size() + 1) : "";
+    if (cmd.empty()) return;
+    if (cmd == "state") {
+        formatState(c.out);
+    }
+    else if (cmd == "subscribe") {
+        char* end;
+        long every = strtol(arg.c_str(), &end, 10);
+        if (arg.empty() || *end || every < 0) c.out += "error subscribe takes a step count\n";
+        else {
+            c.every = every;
+            c.phase = 0;
+            c.out += "ok\n";
+        }
+    }
+    else if (cmd == "history") {
+        double seconds = 0;
+        long every = 1;
+        int n = sscanf(arg.c_str(), "%lf %ld", &seconds, &every);
+        if (n < 1 || seconds < 0 || every <= 0) c.out += "error history takes seconds and an optional step count\n";
+        else sendHistory(c, seconds, every);
+    }
+    else if (cmd == "quit") {
+        c.out += "ok\n";
+        c.closing = true;
+    }
+    else {
+        // 其余为控制命令，语法与场景脚本相同
+        ScenarioEvent ev = { 0, SCENARIO_START, NO_FAULT };
+        int repeat;
+        std::string error;
+        if (!scenarioParseCommand(line, ev, repeat, error)) c.out += "error " + error + "\n";
+        else if (ev.engine >= m_engineCount) c.out += "error engine " + std::to_string(ev.engine + 1) + " not in this configuration\n";
+        else {
+            bool queued = true;
+            for (int i = 0; i < repeat && queued; i++) queued = m_commands.push(ev);
+            c.out += queued ? "ok\n" : "error command queue full\n";
+        }
+    }
+}
+
+#if defined(__linux__)
+bool QueryServer::start(const char* path, int engineCount) {
+    stop();
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) return false;
+    strcpy(addr.sun_path, path);
+
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    unlink(path);
+    bool ok = m_listenFd >= 0 && m_epollFd >= 0 && m_wakeFd >= 0
+        && bind(m_listenFd, (sockaddr*)&addr, sizeof(addr)) == 0 && listen(m_listenFd, 64) == 0;
+    if (ok) {
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = &m_listenFd;
+        ok = epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &ev) == 0;
+        ev.data.ptr = &m_wakeFd;
+        ok = ok && epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev) == 0;
+    }
+    m_path = path;
+    if (!ok) {
+        stop();
+        return false;
+    }
+    m_engineCount = engineCount;
+    m_history.assign(QUERY_HISTORY, TelemetrySample());
+    m_historyCount = 0;
+    m_running = true;
+    m_thread = std::thread(&QueryServer::serverLoop, this);
+    return true;
+}
+
+void QueryServer::stop() {
+    if (m_thread.joinable()) {
+        m_running = false;
+        uint64_t one = 1;
+        if (write(m_wakeFd, &one, sizeof(one)) < 0) {} // 失败时服务线程在下一次超时退出
+        m_thread.join();
+    }
+    for (Client* c : m_clients) {
+        close(c->fd);
+        delete c;
+    }
+    m_clients.clear();
+    if (m_listenFd >= 0) {
+        close(m_listenFd);
+        unlink(m_path.c_str());
+    }
+    if (m_epollFd >= 0) close(m_epollFd);
+    if (m_wakeFd >= 0) close(m_wakeFd);
+    m_listenFd = m_epollFd = m_wakeFd = -1;
+}
+
+void QueryServer::acceptClients() {
+    for (;;) {
+        int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN：没有更多连接
+        Client* c = new Client{ fd, "", "", 0, 0, false };
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = c;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            delete c;
+            continue;
+        }
+        m_clients.push_back(c);
+    }
+}
+
+// 还能否接收新请求：关闭中或待发送数据超过上限时不再读
+static bool clientAccepting(bool closing, size_t pending) {
+    return !closing && pending <= QUERY_MAX_PENDING;
+}
+
+void QueryServer::readClient(Client& c) {
+    char buf[4096];
+    // 每读一段就处理完整的行；停止接收后数据留在套接字中，in 最多多出一段
+    while (clientAccepting(c.closing, c.out.size())) {
+        ssize_t n = read(c.fd, buf, sizeof(buf));
+        if (n > 0) {
+            c.in.append(buf, n);
+            handleInput(c);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0 || errno != EAGAIN) {
+            // 对方已关闭或出错：不再应答
+            c.closing = true;
+            c.out.clear();
+        }
+        break;
+    }
+    updateEvents(c);
+}
+
+void QueryServer::handleInput(Client& c) {
+    size_t pos;
+    while (clientAccepting(c.closing, c.out.size()) && (pos = c.in.find('\n')) != std::string::npos) {
+        std::string line = c.in.substr(0, pos);
+        c.in.erase(0, pos + 1);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        handleLine(c, line);
+    }
+    if (!c.closing && c.in.find('\n') == std::string::npos && c.in.size() > QUERY_MAX_LINE) {
+        c.out += "error line too long\n";
+        c.closing = true;
+    }
+    if (c.closing) c.in.clear();
+}
+
+// 按当前状态设置关注的事件：有待发送数据时等 EPOLLOUT，能接收请求时才等 EPOLLIN
+void QueryServer::updateEvents(Client& c) {
+    epoll_event ev;
+    ev.events = (clientAccepting(c.closing, c.out.size()) ? (uint32_t)(EPOLLIN | EPOLLRDHUP) : 0u)
+        | (c.out.empty() ? 0u : (uint32_t)EPOLLOUT);
+    ev.data.ptr = &c;
+    epoll_ctl(m_epollFd, EPOLL_CTL_MOD, c.fd, &ev);
+}
+
+// 尽量写出待发送数据，写不完时等待 EPOLLOUT
+void QueryServer::writeClient(Client& c) {
+    size_t done = 0;
+    while (done < c.out.size()) {
+        ssize_t n = send(c.fd, c.out.data() + done, c.out.size() - done, MSG_NOSIGNAL);
+        if (n > 0) done += n;
+        else if (n < 0 && errno == EINTR) continue;
+        else {
+            if (n < 0 && errno != EAGAIN) {
+                c.closing = true;
+                done = c.out.size();
+            }
+            break;
+        }
+    }
+    c.out.erase(0, done);
+    // 降到上限以下后先处理暂停期间已收到的请求
+    handleInput(c);
+    updateEvents(c);
+}
+
+void QueryServer::serverLoop() {
+    TRACE_THREAD_NAME("query");
+    epoll_event events[64];
+    while (m_running) {
+        int n = epoll_wait(m_epollFd, events, 64, QUERY_POLL_MS);
+        TRACE_ZONE("query");
+        for (int i = 0; i < n; i++) {
+            void* p = events[i].data.ptr;
+            if (p == &m_listenFd) acceptClients();
+            else if (p == &m_wakeFd) continue;
+            else if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) readClient(*(Client*)p);
+        }
+        drainRecords();
+        // 有待发送数据的客户端写一次；已关闭且写完的客户端移除
+        for (size_t k = 0; k < m_clients.size();) {
+            Client* c = m_clients[k];
+            if (!c->out.empty()) writeClient(*c);
+            if (c->closing && c->out.empty()) {
+                close(c->fd); // 关闭时自动从 epoll 中移除
+                delete c;
+                m_clients[k] = m_clients.back();
+                m_clients.pop_back();
+            }
+            else {
+                k++;
+            }
+        }
+    }
+}
+#else
+bool QueryServer::start(const char*, int) {
+    return false;
+}
+
+void QueryServer::stop() {}
+#endif
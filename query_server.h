@@ -0,0 +1,89 @@
+﻿#pragma once
+// 本机查询服务（Linux）：在 Unix 域套接字上提供行协议，供脚本与工具查询和控制运行中的仿真
+//
+// 每行一条请求，应答也按行：
+//   state                          当前状态：state t=<ms> state=<名称> fuel=<f> N1=<a,b> T=<..> FF=<..> alerts=<名称,..|->
+//   subscribe <n>                  每 n 步推送一行 "tick <data.csv 行>"，新告警推送 "alert <ms> <名称>"；0 取消
+//   history <秒> [n]               最近若干秒的数据，每 n 步一行 "hist <data.csv 行>"，以 "ok <行数>" 结束
+//   start | stop | thrust up|down [xN] | fault <名称> [发动机] | clear <名称> [发动机]
+//                                  与场景脚本相同的命令，即界面按钮与告警框的效果
+//   quit                           关闭连接
+// 成功应答 "ok"，失败 "error <原因>"。
+//
+// 服务线程用非阻塞套接字与 epoll 同时服务任意多个客户端。仿真线程只做两件事：作为输出接口把
+// 每步记录放入无锁环形缓冲区（满时丢弃并计数），以及每步之前从无锁命令队列取出客户端命令；
+// 两者都不等待服务线程，客户端再多、再慢也不会推迟物理步。推送不及的订阅者丢弃 tick 行，不断开。
+// 每个客户端的待发送数据有上限：超过后告警行也丢弃、history 截断，并暂停读取该客户端的新请求。
+#include "mpsc_queue.h"
+#include "scenario.h"
+#include "sim_core.h"
+#include "spsc_ring.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+class QueryServer : public TelemetrySink {
+public:
+    QueryServer();
+    ~QueryServer();
+    // 监听 path（已存在的套接字文件先删除）并启动服务线程；非 Linux 平台返回 false
+    bool start(const char* path, int engineCount);
+    void stop();
+
+    // 仿真线程每步之前调用：把客户端命令按当前仿真时刻放入 queue
+    void pollCommands(ScenarioQueue& queue, SimTime now);
+    void onSample(const TelemetrySample& s) override;
+    void onFault(int64_t timeMs, FaultType ft) override;
+
+    // 服务线程来不及取走而丢弃的记录数
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    // ft == NO_FAULT 表示数据记录，否则为告警
+    struct Record {
+        TelemetrySample s;
+        FaultType ft;
+    };
+    struct Client {
+        int fd;
+        std::string in;
+        std::string out;
+        long every;     // 订阅的抽样间隔，0 为未订阅
+        long phase;
+        bool closing;   // 写完 out 后关闭
+    };
+
+    void serverLoop();
+    void acceptClients();
+    void readClient(Client& c);
+    void writeClient(Client& c);
+    void handleInput(Client& c);
+    void updateEvents(Client& c);
+    void handleLine(Client& c, const std::string& line);
+    void drainRecords();
+    void formatState(std::string& out);
+    void sendHistory(Client& c, double seconds, long every);
+
+    int m_listenFd;
+    int m_epollFd;
+    int m_wakeFd;
+    std::string m_path;
+    int m_engineCount;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+
+    // 仿真线程 -> 服务线程
+    SpscRing<Record> m_records;
+    std::atomic<uint64_t> m_dropped;
+    // 服务线程 -> 仿真线程
+    MpscQueue<ScenarioEvent> m_commands;
+
+    // 以下只由服务线程访问
+    std::vector<Client*> m_clients;
+    std::vector<TelemetrySample> m_history; // 最近的数据（环形）
+    uint64_t m_historyCount;
+    bool m_hasSample;
+    TelemetrySample m_latest;
+    AlertTable m_alerts;
+};
@@ -0,0 +1,265 @@
+﻿#include "scenario.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+// ---- 脚本解析 ----
+
+static std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+static bool parseNumber(const std::string& s, double& v) {
+    char* end = nullptr;
+    v = strtod(s.c_str(), &end);
+    return end != s.c_str() && trim(end).empty();
+}
+
+static bool setKey(Scenario& sc, const std::string& key, const std::string& value) {
+    if (key == "crossfeed") {
+        if (value != "yes" && value != "no") return false;
+        sc.crossFeed = value == "yes";
+        return true;
+    }
+    double v;
+    if (!parseNumber(value, v)) return false;
+    if (key == "seed" && v >= 0) sc.seed = (uint32_t)v;
+    else if (key == "dt" && v > 0) sc.dt = v;
+    else if (key == "end" && v >= 0) sc.end = (SimTime)(v * 1e6);
+    else if (key == "engines" && v >= 1 && v <= SIM_MAX_ENGINES) sc.engines = (int)v;
+    else if (key == "tanks" && v >= 1 && v <= SIM_MAX_TANKS) sc.tanks = (int)v;
+    else if (key == "fuel" && v >= 0) sc.tankFuel = v;
+    else return false;
+    return true;
+}
+
+// "<命令> [参数]"，重复次数 xN 只用于推力，发动机编号只用于故障
+static bool parseCommand(std::istringstream& in, ScenarioEvent& ev, int& repeat, std::string& error) {
+    std::string cmd, arg;
+    in >> cmd;
+    repeat = 1;
+    ev.fault = NO_FAULT;
+    if (cmd == "start") ev.op = SCENARIO_START;
+    else if (cmd == "stop") ev.op = SCENARIO_STOP;
+    else if (cmd == "thrust") {
+        in >> arg;
+        if (arg == "up") ev.op = SCENARIO_THRUST_UP;
+        else if (arg == "down") ev.op = SCENARIO_THRUST_DOWN;
+        else {
+            error = "thrust takes up or down";
+            return false;
+        }
+        std::string times;
+        if (in >> times) {
+            if (times.size() < 2 || times[0] != 'x' || (repeat = atoi(times.c_str() + 1)) <= 0) {
+                error = "bad repeat '" + times + "'";
+                return false;
+            }
+        }
+    }
+    else if (cmd == "fault" || cmd == "clear") {
+        in >> arg;
+        ev.op = cmd == "fault" ? SCENARIO_FAULT_ON : SCENARIO_FAULT_OFF;
+        ev.fault = faultTypeFromName(arg.c_str());
+        if (ev.fault == NO_FAULT) {
+            error = "unknown fault '" + arg + "'";
+            return false;
+        }
+        std::string engine;
+        if (in >> engine) {
+            double v;
+            if (!parseNumber(engine, v) || v < 1 || v > SIM_MAX_ENGINES || v != (int)v) {
+                error = "bad engine '" + engine + "'";
+                return false;
+            }
+            ev.engine = (int)v - 1;
+        }
+    }
+    else {
+        error = "unknown command '" + cmd + "'";
+        return false;
+    }
+    std::string extra;
+    if (in >> extra) {
+        error = "unexpected '" + extra + "'";
+        return false;
+    }
+    return true;
+}
+
+bool scenarioParseCommand(const std::string& text, ScenarioEvent& ev, int& repeat, std::string& error) {
+    std::istringstream in(text);
+    ev.engine = -1;
+    return parseCommand(in, ev, repeat, error);
+}
+
+bool scenarioParse(const std::string& text, Scenario& out, std::string& error) {
+    out = Scenario();
+    std::istringstream lines(text);
+    std::string line;
+    int lineNo = 0;
+    SimTime last = 0;
+    std::vector<int> eventLines; // 各事件所在行，发动机编号在读完全部键后再检查
+    while (std::getline(lines, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+        line = trim(line);
+        if (line.empty()) continue;
+
+        std::string where = "line " + std::to_string(lineNo) + ": ";
+        size_t eq = line.find('=');
+        if (eq != std::string::npos) {
+            std::string key = trim(line.substr(0, eq));
+            if (!setKey(out, key, trim(line.substr(eq + 1)))) {
+                error = where + "bad value for '" + key + "'";
+                return false;
+            }
+            continue;
+        }
+
+        std::istringstream in(line);
+        std::string timeText;
+        in >> timeText;
+        bool relative = timeText[0] == '+';
+        double seconds;
+        if (!parseNumber(relative ? timeText.substr(1) : timeText, seconds) || seconds < 0) {
+            error = where + "bad time '" + timeText + "'";
+            return false;
+        }
+        ScenarioEvent ev;
+        ev.at = (SimTime)(seconds * 1e6) + (relative ? last : 0);
+        int repeat;
+        std::string why;
+        if (!parseCommand(in, ev, repeat, why)) {
+            error = where + why;
+            return false;
+        }
+        for (int i = 0; i < repeat; i++) {
+            out.events.push_back(ev);
+            eventLines.push_back(lineNo);
+        }
+        last = ev.at;
+    }
+    // engines = 可以写在事件之后
+    for (size_t k = 0; k < out.events.size(); k++) {
+        if (out.events[k].engine >= out.engines) {
+            error = "line " + std::to_string(eventLines[k]) + ": engine " + std::to_string(out.events[k].engine + 1)
+                + " not in this configuration";
+            return false;
+        }
+    }
+    return true;
+}
+
+SimConfig scenarioConfig(const Scenario& sc) {
+    SimConfig c;
+    simConfigMake(c, sc.engines, sc.tanks, sc.crossFeed, sc.tankFuel);
+    return c;
+}
+
+bool scenarioLoad(const char* path, Scenario& out, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = std::string("cannot open ") + path;
+        return false;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+    if (!scenarioParse(text.str(), out, error)) return false;
+    out.name = path;
+    return true;
+}
+
+std::string scenarioStem(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    std::string stem = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = stem.rfind('.');
+    return dot == std::string::npos || dot == 0 ? stem : stem.substr(0, dot);
+}
+
+// ---- 执行 ----
+
+void scenarioApply(EngineSim& sim, const ScenarioEvent& ev) {
+    switch (ev.op) {
+    case SCENARIO_START: simStart(sim); break;
+    case SCENARIO_STOP: simStop(sim); break;
+    case SCENARIO_THRUST_UP: simThrustUp(sim); break;
+    case SCENARIO_THRUST_DOWN: simThrustDown(sim); break;
+    case SCENARIO_FAULT_ON: simSetFault(sim, ev.fault, true, ev.engine); break;
+    case SCENARIO_FAULT_OFF: simSetFault(sim, ev.fault, false, ev.engine); break;
+    }
+}
+
+void ScenarioQueue::push(const ScenarioEvent& ev) {
+    m_heap.push(Entry{ ev, m_seq++ });
+}
+
+void ScenarioQueue::pushAll(const Scenario& sc) {
+    for (const ScenarioEvent& ev : sc.events) push(ev);
+}
+
+int ScenarioQueue::runDue(EngineSim& sim) {
+    int n = 0;
+    while (!m_heap.empty() && m_heap.top().ev.at <= sim.now) {
+        ScenarioEvent ev = m_heap.top().ev;
+        m_heap.pop();
+        scenarioApply(sim, ev);
+        n++;
+    }
+    return n;
+}
+
+SimTime ScenarioQueue::nextAt() const {
+    return m_heap.empty() ? -1 : m_heap.top().ev.at;
+}
+
+void ScenarioQueue::clear() {
+    m_heap = decltype(m_heap)();
+}
+
+// 只记录出现过哪些告警
+class ScenarioAlertMask : public TelemetrySink {
+public:
+    uint32_t mask = 0;
+    void onSample(const TelemetrySample&) override {}
+    void onFault(int64_t, FaultType ft) override { mask |= 1u << ft; }
+};
+
+SimTime scenarioEnd(const Scenario& sc) {
+    if (sc.end >= 0) return sc.end;
+    SimTime end = 0;
+    for (const ScenarioEvent& ev : sc.events) end = std::max(end, ev.at);
+    return end + 10000000;
+}
+
+void scenarioRun(EngineSim& sim, const Scenario& sc, bool fastForward, ScenarioResult& out) {
+    ScenarioQueue queue;
+    queue.pushAll(sc);
+    SimTime end = scenarioEnd(sc);
+
+    ScenarioAlertMask alerts;
+    sim.sinks.push_back(&alerts);
+    out.steps = 0;
+    while (sim.now < end) {
+        queue.runDue(sim);
+        if (fastForward) {
+            SimTime next = queue.nextAt();
+            out.steps += simAdvanceTo(sim, next < 0 ? end : std::min(next, end));
+        }
+        else {
+            simStep(sim, sc.dt);
+            out.steps++;
+        }
+    }
+    sim.sinks.pop_back();
+
+    out.end = sim.now;
+    out.fuel = simTotalFuel(sim);
+    out.state = sim.state.state;
+    out.alerts = alerts.mask;
+}
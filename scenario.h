@@ -0,0 +1,107 @@
+﻿#pragma once
+// 场景脚本：按时刻执行的控制命令，代替鼠标点击驱动仿真
+//
+// 脚本为文本，每行 "<时刻> <命令>"，时刻单位秒，"+5" 表示上一条命令之后 5 秒；
+// 开头可用 key = value 设置参数：
+//
+//   seed = 7
+//   end = 150                 # 仿真到此时刻结束（默认最后一条命令后 10 秒）
+//   engines = 4               # 构型（默认双发单油箱），见 SimConfig
+//   tanks = 2
+//   crossfeed = yes
+//   0    start
+//   30   thrust up x3         # 连按三次 ▲
+//   60   fault OVER_TEMP3     # 注入故障（告警框按钮按下）
+//   +15  clear OVER_TEMP3     # 取消故障
+//   80   fault N1S1_FAIL 3    # 只作用于 3 号发动机（从 1 数起）
+//   120  stop
+//
+// 命令经 ScenarioQueue 按 (时刻, 加入顺序) 执行，调用的就是按钮对应的 simStart/simStop/
+// simThrustUp/simThrustDown/simSetFault；界面的鼠标点击也放入同一队列。
+#include "sim_core.h"
+#include <queue>
+#include <string>
+#include <vector>
+
+enum ScenarioOp {
+    SCENARIO_START,
+    SCENARIO_STOP,
+    SCENARIO_THRUST_UP,
+    SCENARIO_THRUST_DOWN,
+    SCENARIO_FAULT_ON,
+    SCENARIO_FAULT_OFF
+};
+
+struct ScenarioEvent {
+    SimTime at;
+    ScenarioOp op;
+    FaultType fault;  // SCENARIO_FAULT_ON/OFF 时有效
+    int engine = -1;  // 故障作用的发动机（从 0 数起），-1 同界面按钮
+};
+
+struct Scenario {
+    std::string name;
+    uint32_t seed = 1;
+    double dt = SIM_REFERENCE_DT;
+    SimTime end = -1; // <0 为最后一条命令后 10 秒
+    // 构型
+    int engines = SIM_DEFAULT_ENGINES;
+    int tanks = 1;
+    bool crossFeed = false;
+    double tankFuel = 3000;
+    std::vector<ScenarioEvent> events; // 按文件顺序
+};
+
+// 脚本中的构型
+SimConfig scenarioConfig(const Scenario& sc);
+
+bool scenarioParse(const std::string& text, Scenario& out, std::string& error);
+// 解析不带时刻的一条命令（如 "thrust up x3"、"fault OVER_TEMP3 2"），repeat 为重复次数；ev.at 不变
+bool scenarioParseCommand(const std::string& text, ScenarioEvent& ev, int& repeat, std::string& error);
+bool scenarioLoad(const char* path, Scenario& out, std::string& error);
+// 脚本路径去掉目录与扩展名（批量输出的文件名前缀）
+std::string scenarioStem(const std::string& path);
+
+// 执行一条命令（与界面按钮相同的状态转换）
+void scenarioApply(EngineSim& sim, const ScenarioEvent& ev);
+
+// 命令队列：时刻相同的命令按加入顺序执行
+class ScenarioQueue {
+public:
+    void push(const ScenarioEvent& ev);
+    void pushAll(const Scenario& sc);
+    // 执行所有 at <= sim.now 的命令，返回执行条数
+    int runDue(EngineSim& sim);
+    // 下一条命令的时刻，队列空时返回 -1
+    SimTime nextAt() const;
+    bool empty() const { return m_heap.empty(); }
+    void clear();
+
+private:
+    struct Entry {
+        ScenarioEvent ev;
+        uint64_t seq;
+    };
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.ev.at != b.ev.at ? a.ev.at > b.ev.at : a.seq > b.seq;
+        }
+    };
+    std::priority_queue<Entry, std::vector<Entry>, Later> m_heap;
+    uint64_t m_seq = 0;
+};
+
+// 运行结果
+struct ScenarioResult {
+    long long steps;
+    SimTime end;
+    double fuel;
+    int state;       // EngineState
+    uint32_t alerts; // 出现过的告警（按 FaultType 位）
+};
+
+// 脚本的结束时刻（未指定 end 时为最后一条命令后 10 秒）
+SimTime scenarioEnd(const Scenario& sc);
+
+// 无界面运行整个脚本：命令之间按 dt 逐步推进；fastForward 为真时用 simAdvanceTo 跨过命令间隔
+void scenarioRun(EngineSim& sim, const Scenario& sc, bool fastForward, ScenarioResult& out);
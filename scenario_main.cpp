@@ -0,0 +1,149 @@
+﻿// 批量运行场景脚本：多个脚本（及每个脚本的多个种子）分到所有核上并行，无界面、快于实时。
+// 每次运行有自己的 EngineSim 和输出接口，线程间不共享可变状态，代替每个场景启动一个进程。
+#include "scenario.h"
+#include "telemetry_writer.h"
+#include "work_steal.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static void printUsage(const char* prog) {
+    printf("Usage: %s <scenario.txt>... [options]\n", prog);
+    printf("  --runs <n>       run each script with n consecutive seeds from its seed (default 1)\n");
+    printf("  --seed <n>       override the seed in the scripts\n");
+    printf("  --threads <n>    worker threads (default: all hardware threads)\n");
+    printf("  --fast-forward   cross the gaps between commands analytically (simAdvanceTo)\n");
+    printf("  --results <file> write one CSV row per run\n");
+    printf("  --output <dir>   write data.csv/log.txt of every run as <dir>/<script>-<seed>.csv/.log\n");
+    printf("  --pin            pin worker thread w to hardware thread w\n");
+}
+
+static void printAlerts(FILE* fp, uint32_t alerts, const char* sep) {
+    bool first = true;
+    for (int f = 1; f < FAULT_TYPE_COUNT; f++) {
+        if (!(alerts & (1u << f))) continue;
+        fprintf(fp, "%s%s", first ? "" : sep, faultTypeName((FaultType)f));
+        first = false;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<const char*> paths;
+    const char* resultsPath = nullptr;
+    const char* outputDir = nullptr;
+    long runs = 1;
+    long long seedOverride = -1;
+    int threads = 0;
+    bool fastForward = false;
+    bool pin = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--runs") && hasValue) runs = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && hasValue) seedOverride = atoll(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && hasValue) threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--fast-forward")) fastForward = true;
+        else if (!strcmp(argv[i], "--results") && hasValue) resultsPath = argv[++i];
+        else if (!strcmp(argv[i], "--output") && hasValue) outputDir = argv[++i];
+        else if (!strcmp(argv[i], "--pin")) pin = true;
+        else if (argv[i][0] != '-') paths.push_back(argv[i]);
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (paths.empty() || runs <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Scenario> scenarios(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        std::string error;
+        if (!scenarioLoad(paths[i], scenarios[i], error)) {
+            fprintf(stderr, "%s: %s\n", paths[i], error.c_str());
+            return 1;
+        }
+        if (seedOverride >= 0) scenarios[i].seed = (uint32_t)seedOverride;
+    }
+
+    // 第 k 个任务 = 脚本 k / runs 的第 k % runs 个种子
+    size_t total = scenarios.size() * (size_t)runs;
+    std::vector<ScenarioResult> results(total);
+    std::atomic<size_t> openFailures(0);
+    auto wallStart = std::chrono::steady_clock::now();
+    parallelForStealing(total, 1, threads, [&](size_t begin, size_t end, int) {
+        for (size_t k = begin; k < end; k++) {
+            const Scenario& sc = scenarios[k / runs];
+            uint32_t seed = sc.seed + (uint32_t)(k % runs);
+            EngineSim sim;
+            simInit(sim, scenarioConfig(sc));
+            simSeed(sim, seed);
+            // 后台线程整块写入，不逐行 flush；环形缓冲区取小一些，每个工作线程同时只开一个
+            AsyncTelemetrySink out;
+            if (outputDir) {
+                std::string base = std::string(outputDir) + "/" + scenarioStem(sc.name) + "-" + std::to_string(seed);
+                AsyncWriterOptions opt;
+                opt.ringCapacity = 1 << 12;
+                opt.maxLatencyMs = 0;
+                opt.engineCount = sc.engines;
+                if (out.open((base + ".csv").c_str(), (base + ".log").c_str(), opt)) sim.sinks.push_back(&out);
+                else openFailures++;
+            }
+            scenarioRun(sim, sc, fastForward, results[k]);
+            out.close();
+        }
+    }, pin);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    if (openFailures) fprintf(stderr, "%zu runs could not open their output files in %s\n", (size_t)openFailures, outputDir);
+
+    long long steps = 0;
+    double simSeconds = 0;
+    for (size_t s = 0; s < scenarios.size(); s++) {
+        double fuelSum = 0;
+        int alertRuns[FAULT_TYPE_COUNT] = {};
+        for (long r = 0; r < runs; r++) {
+            const ScenarioResult& res = results[s * runs + r];
+            fuelSum += res.fuel;
+            for (int f = 1; f < FAULT_TYPE_COUNT; f++) alertRuns[f] += (res.alerts >> f) & 1;
+            steps += res.steps;
+            simSeconds += res.end / 1e6;
+        }
+        if (runs == 1) {
+            const ScenarioResult& res = results[s];
+            printf("%s: end=%.3fs steps=%lld state=%s fuel=%.1f alerts=", scenarios[s].name.c_str(),
+                res.end / 1e6, res.steps, engineStateName(res.state), res.fuel);
+            printAlerts(stdout, res.alerts, ",");
+            printf("\n");
+        }
+        else {
+            printf("%s: runs=%ld mean-fuel=%.1f\n", scenarios[s].name.c_str(), runs, fuelSum / runs);
+            for (int f = 1; f < FAULT_TYPE_COUNT; f++) {
+                if (alertRuns[f]) printf("  %-11s %6.2f%%\n", faultTypeName((FaultType)f), 100.0 * alertRuns[f] / runs);
+            }
+        }
+    }
+    printf("threads=%d runs=%zu steps=%lld wall=%.3fs speedup=%.0fx\n", stealingThreadCount(threads), total, steps,
+        wall, wall > 0 ? simSeconds / wall : 0.0);
+
+    if (resultsPath) {
+        FILE* fp = fopen(resultsPath, "w");
+        if (!fp) {
+            fprintf(stderr, "cannot open %s\n", resultsPath);
+            return 1;
+        }
+        fprintf(fp, "Scenario,Seed,EndMs,Steps,State,Fuel,Alerts\n");
+        for (size_t k = 0; k < total; k++) {
+            const Scenario& sc = scenarios[k / runs];
+            const ScenarioResult& res = results[k];
+            fprintf(fp, "%s,%u,%lld,%lld,%s,%g,", sc.name.c_str(), sc.seed + (uint32_t)(k % runs),
+                (long long)(res.end / 1000), res.steps, engineStateName(res.state), res.fuel);
+            printAlerts(fp, res.alerts, "|");
+            fprintf(fp, "\n");
+        }
+        fclose(fp);
+    }
+    return 0;
+}
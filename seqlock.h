@@ -0,0 +1,58 @@
+﻿#pragma once
+// 单写者、多读者的双缓冲状态快照（seqlock）
+//
+// 第 n 次发布写入槽位 n & 1，该槽位的序号写入中为 2n - 1，写完为 2n，随后发布 n；
+// 读者复制第 n 次发布的槽位，复制前后序号都是 2n 才有效，所以读到的内容与编号一致且不会倒退。写者从不等待读者，读者也不阻塞写者，
+// 只有在一次复制期间写者连续发布了两次（又写回同一槽位）时读者才需重读。
+// 数据按 8 字节原子字复制（relaxed，编译为普通读写），没有数据竞争。T 须可按字节复制。
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <class T>
+class SeqlockSnapshot {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshot type must be trivially copyable");
+
+public:
+    // 写者调用
+    void publish(const T& v) {
+        uint64_t n = m_published.load(std::memory_order_relaxed) + 1;
+        Slot& s = m_slots[n & 1];
+        s.seq.store(2 * n - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        uint64_t w[WORDS] = {};
+        memcpy(w, &v, sizeof(T));
+        for (size_t i = 0; i < WORDS; i++) s.words[i].store(w[i], std::memory_order_relaxed);
+        s.seq.store(2 * n, std::memory_order_release);
+        m_published.store(n, std::memory_order_release);
+    }
+
+    // 复制最新快照，返回其编号（每发布一次加 1）；尚未发布过时返回 0，out 不变
+    uint64_t read(T& out) const {
+        for (;;) {
+            uint64_t n = m_published.load(std::memory_order_acquire);
+            if (n == 0) return 0;
+            const Slot& s = m_slots[n & 1];
+            if (s.seq.load(std::memory_order_acquire) != 2 * n) continue;
+            uint64_t w[WORDS];
+            for (size_t i = 0; i < WORDS; i++) w[i] = s.words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.seq.load(std::memory_order_relaxed) != 2 * n) continue;
+            memcpy(&out, w, sizeof(T));
+            return n;
+        }
+    }
+
+    // 最新快照的编号，可用于判断是否有新数据
+    uint64_t version() const { return m_published.load(std::memory_order_acquire); }
+
+private:
+    enum : size_t { WORDS = (sizeof(T) + 7) / 8 };
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<uint64_t> words[WORDS];
+    };
+    Slot m_slots[2];
+    alignas(64) std::atomic<uint64_t> m_published{0};
+};
@@ -0,0 +1,793 @@
+﻿#include "sim_core.h"
+#include "fault_rules.h"
+#include "philox.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// 根据故障类型获取文本
+const char* faultTypeToString(FaultType ft) {
+    switch (ft) {
+    case N1S1_FAIL: return "One N1 Sensor Fail";
+    case N1S2_FAIL: return "One Engine N1 Sensor Fail";
+    case EGTS1_FAIL: return "One EGT Sensor Fail";
+    case EGTS2_FAIL: return "One Engine EGT Sensor Fail";
+    case N1S_FAIL: return "All N1 Sensor Fail";
+    case EGTS_FAIL: return "All EGT Sensor Fail";
+    case LOW_FUEL: return "Low Fuel 1000";
+    case FUELS_FAIL: return "Fuel Sensor Fail";
+    case OVER_FF: return "Over Fuel Flow 50";
+    case OVER_SPD1: return "Over Speed 105";
+    case OVER_SPD2: return "Over Speed 120";
+    case OVER_TEMP1: return "Over Temperature 850 when STARTING";
+    case OVER_TEMP2: return "Over Temperature 1000 when STARTING";
+    case OVER_TEMP3: return "Over Temperature 950 when RUNNING";
+    case OVER_TEMP4: return "Over Temperature 1100 when RUNNING";
+    default: return "";
+    }
+}
+
+static const char* const g_faultNames[FAULT_TYPE_COUNT] = {
+    "NO_FAULT",
+    "N1S1_FAIL", "N1S2_FAIL", "EGTS1_FAIL", "EGTS2_FAIL", "N1S_FAIL", "EGTS_FAIL",
+    "LOW_FUEL", "FUELS_FAIL", "OVER_FF",
+    "OVER_SPD1", "OVER_SPD2",
+    "OVER_TEMP1", "OVER_TEMP2", "OVER_TEMP3", "OVER_TEMP4"
+};
+
+const char* faultTypeName(FaultType ft) {
+    return ft >= 0 && ft < FAULT_TYPE_COUNT ? g_faultNames[ft] : "";
+}
+
+FaultType faultTypeFromName(const char* name) {
+    for (int i = 1; i < FAULT_TYPE_COUNT; i++) {
+        if (!strcmp(name, g_faultNames[i])) return (FaultType)i;
+    }
+    return NO_FAULT;
+}
+
+static const char* const g_stateNames[] = { "OFF", "STARTING", "RUNNING", "STOPPING" };
+
+const char* engineStateName(int state) {
+    return state >= ENGINE_OFF && state <= ENGINE_STOPPING ? g_stateNames[state] : "";
+}
+
+int engineStateFromName(const char* name) {
+    for (int i = ENGINE_OFF; i <= ENGINE_STOPPING; i++) {
+        if (!strcmp(name, g_stateNames[i])) return i;
+    }
+    return -1;
+}
+
+// 第 n 个数来自计数器 (tick, n / 4, 通道) 的第 n % 4 个输出
+static uint32_t simRandBits(EngineSim& sim, SimRngChannel ch) {
+    SimRng& r = sim.rng;
+    uint32_t n = r.draws[ch]++;
+    uint32_t group = n >> 2;
+    if (r.cachedTick != r.tick || r.cachedChannel != (uint32_t)ch || r.cachedGroup != group) {
+        Philox4x32 x = philox4x32((uint32_t)r.tick, (uint32_t)(r.tick >> 32), group, ch, r.seed, r.stream);
+        for (int i = 0; i < 4; i++) r.cached[i] = x.v[i];
+        r.cachedTick = r.tick;
+        r.cachedChannel = ch;
+        r.cachedGroup = group;
+    }
+    return r.cached[n & 3];
+}
+
+static SimRngChannel engineChannel(int i) {
+    return (SimRngChannel)(SIM_RNG_ENGINE + i);
+}
+
+// 取值 0~32767，替代 rand()
+static int simRand(EngineSim& sim, SimRngChannel ch) {
+    return philoxRand15(simRandBits(sim, ch));
+}
+
+// 一对独立标准正态数
+static void simRandNormal2(EngineSim& sim, SimRngChannel ch, double& z0, double& z1) {
+    uint32_t x0 = simRandBits(sim, ch);
+    uint32_t x1 = simRandBits(sim, ch);
+    philoxNormal2(x0, x1, z0, z1);
+}
+
+// EGT 表盘基准值随机游走。以偏差 v = value - 20 与速率 d 表示，每个标定步为
+//   d' = 0.9 (d + e),  v' = 0.95 (v + d + e),  e = (rand() % 201 - 100) / 100 * 0.005
+// 即 x' = A x + B e，A = [[0.95, 0.95], [0, 0.9]]，B = [0.95, 0.9]。
+// A 的特征值 a = 0.95、b = 0.9，P = [[1, 19], [0, -1]]（P = P^-1）使 A = P diag(a, b) P，
+// 于是 n 步（n 可为小数）的转移为 A^n = [[a^n, 19 (a^n - b^n)], [0, b^n]]，
+// 累积噪声的协方差在特征坐标下为 g_i g_j σ² (1 - (λi λj)^n) / (1 - λi λj)，g = P B。
+void egtWalkStep(double n, EgtWalkStep& out) {
+    const double a = 0.95, b = 0.9;
+    const double g[2] = { 0.95 + 19 * 0.9, -0.9 };
+    const double var = (201.0 * 201.0 - 1) / 12 / 10000 * 0.005 * 0.005; // e 的方差
+    double an = pow(a, n), bn = pow(b, n);
+    out.a = an;
+    out.b = bn;
+    out.c = 19 * (an - bn);
+
+    // 特征坐标下的协方差，再变换回 (v, d)
+    double lam[2] = { a, b }, lamN[2] = { an, bn };
+    double c[2][2];
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+            double l = lam[i] * lam[j];
+            c[i][j] = g[i] * g[j] * var * (1 - lamN[i] * lamN[j]) / (1 - l);
+        }
+    }
+    double svv = c[0][0] + 19 * (c[0][1] + c[1][0]) + 361 * c[1][1];
+    double svd = -(c[0][1] + 19 * c[1][1]);
+    double sdd = c[1][1];
+    // Cholesky 分解后用两个独立正态数生成相关噪声
+    out.l11 = sqrt(svv);
+    out.l21 = out.l11 > 0 ? svd / out.l11 : 0;
+    out.l22 = sqrt(std::max(sdd - out.l21 * out.l21, 0.0));
+}
+
+static void egtBaselineWalk(EngineSim& sim, double n) {
+    double& value = sim.egtBase; // 表盘基准值
+    double& delta = sim.egtDelta;  // 当前变化速率
+    if (n == 1.0) {
+        // 标定步长：保持原来的离散更新
+        const double damping = 0.9; // 阻尼系数（越接近 1 越平滑）
+        delta += ((simRand(sim, SIM_RNG_PANEL) % 201 - 100) / 100.0) * 0.005; // 随机速率调整
+        value += delta;
+        delta *= damping; // 阻尼减速
+        value += (20.0 - value) * 0.05; // 回归基准值
+    }
+    else {
+        EgtWalkStep w;
+        egtWalkStep(n, w);
+        double v = value - 20.0, d = delta;
+        double z0, z1;
+        simRandNormal2(sim, SIM_RNG_PANEL, z0, z1);
+        value = 20.0 + (w.a * v + w.c * d) + w.l11 * z0;
+        delta = w.b * d + w.l21 * z0 + w.l22 * z1;
+    }
+    if (value > 21.5) value = 21.5;
+    if (value < 18.5) value = 18.5;
+}
+
+void simSeed(EngineSim& sim, uint32_t seed, uint32_t stream) {
+    sim.rng.seed = seed;
+    sim.rng.stream = stream;
+    sim.rng.cachedTick = ~(uint64_t)0;
+}
+
+void alertClear(AlertTable& t) {
+    for (int i = 0; i < FAULT_TYPE_COUNT; i++) {
+        AlertInfo& a = t.slots[i];
+        a.type = (FaultType)i;
+        a.text = faultTypeToString((FaultType)i);
+        a.last_trigger_time = 0;
+        a.prev = a.next = ALERT_NONE;
+        a.active = false;
+    }
+    t.head = t.tail = ALERT_NONE;
+    t.count = 0;
+}
+
+static void alertUnlink(AlertTable& t, AlertInfo& a) {
+    if (a.prev != ALERT_NONE) t.slots[a.prev].next = a.next;
+    else t.head = a.next;
+    if (a.next != ALERT_NONE) t.slots[a.next].prev = a.prev;
+    else t.tail = a.prev;
+    a.prev = a.next = ALERT_NONE;
+    a.active = false;
+    t.count--;
+}
+
+bool alertTrigger(AlertTable& t, FaultType ft, SimTime now) {
+    AlertInfo& a = t.slots[ft];
+    if (a.active) {
+        // 若5s内已记录过，则不重复记录
+        if (now - a.last_trigger_time < ALERT_HOLD_US + 1000) return false;
+        alertUnlink(t, a);
+    }
+
+    // 接到表尾
+    a.last_trigger_time = now;
+    a.active = true;
+    a.prev = t.tail;
+    a.next = ALERT_NONE;
+    if (t.tail != ALERT_NONE) t.slots[t.tail].next = (int8_t)ft;
+    else t.head = (int8_t)ft;
+    t.tail = (int8_t)ft;
+    t.count++;
+    return true;
+}
+
+void alertExpire(AlertTable& t, SimTime now) {
+    while (t.head != ALERT_NONE && now - t.slots[t.head].last_trigger_time >= ALERT_HOLD_US) {
+        alertUnlink(t, t.slots[t.head]);
+    }
+}
+
+// 将当前故障记录到告警表并通知输出
+void logFault(EngineSim& sim, FaultType ft) {
+    if (ft == NO_FAULT) return;
+    if (!alertTrigger(sim.alerts, ft, sim.now)) return;
+
+    // 写入log
+    int64_t runningTime = simElapsedMs(sim);
+    for (TelemetrySink* s : sim.sinks) s->onFault(runningTime, ft);
+}
+
+// 进入停车状态（故障触发）
+static void stopOnFault(EngineSim& sim) {
+    sim.state.state = ENGINE_STOPPING;
+    sim.stopTime = sim.now;
+    sim.state.thrustAdjust = 0;
+}
+
+// 全部发动机的传感器失效：停车，转速已降到 1 以下时直接关闭
+static void stopOnSensorLoss(EngineSim& sim, double maxN1) {
+    sim.state.state = ENGINE_STOPPING;
+    sim.state.thrustAdjust = 0;
+    if (maxN1 <= 1) {
+        sim.state.state = ENGINE_OFF; // 切换到关闭状态
+        sim.state.run_light_on = false; // 关闭运行灯
+        sim.state.state_changed = true;
+    }
+}
+
+static bool hasFault(uint32_t faultBits, FaultType ft) {
+    return (faultBits >> ft) & 1u;
+}
+
+// 检查故障
+FaultType checkFuelFault(const EngineSim& sim, uint32_t faultBits) {
+    if (simFuelSensorFail(sim)) {
+        return FUELS_FAIL;
+    }
+    return hasFault(faultBits, LOW_FUEL) ? LOW_FUEL : NO_FAULT;
+}
+FaultType checkN1Fault(const EngineData& engine, uint32_t faultBits) {
+    if (engine.n1Sensor1Fail && engine.n1Sensor2Fail) {
+        return N1S2_FAIL;
+    }
+    else if (engine.n1Sensor1Fail || engine.n1Sensor2Fail) {
+        return N1S1_FAIL;
+    }
+    if (hasFault(faultBits, OVER_SPD2)) return OVER_SPD2;
+    if (hasFault(faultBits, OVER_SPD1)) return OVER_SPD1;
+    return NO_FAULT;
+}
+FaultType checkTemperatureFault(const EngineData& engine, uint32_t faultBits) {
+    if (engine.egtSensor1Fail && engine.egtSensor2Fail) {
+        return EGTS2_FAIL; // 单发EGT传感器全部故障
+    }
+    else if (engine.egtSensor1Fail || engine.egtSensor2Fail) {
+        return EGTS1_FAIL; // 单个EGT传感器故障
+    }
+    // 启动中与稳态的规则互斥，各自按严重程度取
+    if (hasFault(faultBits, OVER_TEMP2)) return OVER_TEMP2;
+    if (hasFault(faultBits, OVER_TEMP1)) return OVER_TEMP1;
+    if (hasFault(faultBits, OVER_TEMP4)) return OVER_TEMP4;
+    if (hasFault(faultBits, OVER_TEMP3)) return OVER_TEMP3;
+    return NO_FAULT;
+}
+
+void simResetFaultRules(EngineSim& sim) {
+    memset(sim.ruleBits, 0, sizeof(sim.ruleBits));
+    memset(sim.ruleTimers, 0, sizeof(sim.ruleTimers));
+    sim.lastFaultCheck = sim.now;
+}
+
+// 第 i 台发动机本步从哪个油箱取油：交输供油时取油量传感器正常的油箱中油量最多的；
+// 全部故障时返回 0 号（其传感器故障，不计耗油）
+static int simFeedTank(const SimState& sim, int i) {
+    if (!sim.config.crossFeed) return sim.config.engineTank[i];
+    int best = -1;
+    for (int k = 0; k < sim.config.tankCount; k++) {
+        if (sim.tanks[k].fuelSensorFail) continue;
+        if (best < 0 || sim.tanks[k].C > sim.tanks[best].C) best = k;
+    }
+    return best >= 0 ? best : 0;
+}
+
+void checkFault(EngineSim& sim) {
+    SimFaults& f = sim.faults;
+    const int n = sim.config.engineCount;
+    double dt = sim.now > sim.lastFaultCheck ? (sim.now - sim.lastFaultCheck) / 1e6 : 0.0;
+    sim.lastFaultCheck = sim.now;
+
+    // 每台发动机作为规则表的一路输入，燃油取其供油油箱
+    double n1[SIM_MAX_ENGINES], T[SIM_MAX_ENGINES], ff[SIM_MAX_ENGINES], fuel[SIM_MAX_ENGINES];
+    int32_t state[SIM_MAX_ENGINES], sensors[SIM_MAX_ENGINES];
+    int32_t faultBits[SIM_MAX_ENGINES], shutdown[SIM_MAX_ENGINES];
+    for (int i = 0; i < n; i++) {
+        const EngineData& e = sim.engines[i];
+        const FuelData& tank = sim.tanks[simFeedTank(sim, i)];
+        n1[i] = e.N1;
+        T[i] = e.T;
+        ff[i] = e.FF;
+        fuel[i] = tank.C;
+        state[i] = sim.state.state;
+        sensors[i] = (e.n1Sensor1Fail ? RULE_N1S1 : 0) | (e.n1Sensor2Fail ? RULE_N1S2 : 0)
+            | (e.egtSensor1Fail ? RULE_EGTS1 : 0) | (e.egtSensor2Fail ? RULE_EGTS2 : 0)
+            | (tank.fuelSensorFail ? RULE_FUELS : 0);
+    }
+    FaultRuleInputs in = { n1, T, ff, fuel, state, sensors };
+    FaultRuleState rs;
+    rs.ruleBits = sim.ruleBits;
+    for (size_t r = 0; r < SIM_MAX_FAULT_RULES; r++) rs.timers[r] = sim.ruleTimers[r];
+    FaultRuleOutputs out = { faultBits, shutdown };
+    evaluateFaultRules<VecScalar>(in, rs, out, (size_t)n, dt, sim.config.filteredAlerts);
+    uint32_t bits = 0;
+    bool stop = false;
+    for (int i = 0; i < n; i++) {
+        bits |= (uint32_t)faultBits[i];
+        stop = stop || shutdown[i];
+    }
+
+    // 燃油故障
+    f.fuel = checkFuelFault(sim, bits);
+    logFault(sim, f.fuel);
+
+    f.ff = hasFault(bits, OVER_FF) ? OVER_FF : NO_FAULT;
+    logFault(sim, f.ff);
+
+    // 各发动机 N1
+    for (int i = 0; i < n; i++) {
+        f.n1[i] = checkN1Fault(sim.engines[i], (uint32_t)faultBits[i]);
+        logFault(sim, f.n1[i]);
+    }
+    // 各发动机 EGT
+    for (int i = 0; i < n; i++) {
+        f.egt[i] = checkTemperatureFault(sim.engines[i], (uint32_t)faultBits[i]);
+        logFault(sim, f.egt[i]);
+    }
+
+    // 停车规则（超速、超温、油量耗尽）
+    if (stop) stopOnFault(sim);
+
+    // 全部发动机的转速 / EGT 传感器都失败
+    bool allN1Fail = true, allEgtFail = true;
+    double maxN1 = 0;
+    for (int i = 0; i < n; i++) {
+        const EngineData& e = sim.engines[i];
+        allN1Fail = allN1Fail && e.n1Sensor1Fail && e.n1Sensor2Fail;
+        allEgtFail = allEgtFail && e.egtSensor1Fail && e.egtSensor2Fail;
+        maxN1 = std::max(maxN1, e.N1);
+    }
+    if (allN1Fail) {
+        for (int i = 0; i < n; i++) f.n1[i] = N1S_FAIL;
+        logFault(sim, N1S_FAIL);
+        stopOnSensorLoss(sim, maxN1);
+    }
+    if (allEgtFail) {
+        for (int i = 0; i < n; i++) f.egt[i] = EGTS_FAIL;
+        logFault(sim, EGTS_FAIL);
+        stopOnSensorLoss(sim, maxN1);
+    }
+}
+
+bool simConfigMake(SimConfig& c, int engines, int tanks, bool crossFeed, double tankCapacity) {
+    if (engines < 1 || engines > SIM_MAX_ENGINES || tanks < 1 || tanks > SIM_MAX_TANKS || tankCapacity < 0) return false;
+    c.engineCount = engines;
+    c.tankCount = tanks;
+    for (int i = 0; i < SIM_MAX_ENGINES; i++) c.engineTank[i] = (int8_t)(i < engines ? i * tanks / engines : 0);
+    c.crossFeed = crossFeed;
+    c.filteredAlerts = false;
+    c.tankCapacity = tankCapacity;
+    return true;
+}
+
+// 初始化
+void simInit(EngineSim& sim) {
+    SimConfig config;
+    simConfigMake(config, SIM_DEFAULT_ENGINES);
+    simInit(sim, config);
+}
+
+void simInit(EngineSim& sim, const SimConfig& config) {
+    sim.config = config;
+    sim.state.state = ENGINE_OFF;
+    sim.state.started = false;
+    sim.state.stabilized = false;
+    sim.state.stopped = true;
+    sim.state.run_light_on = false;
+    sim.state.start_light_on = false;
+    sim.state.state_changed = false;
+    sim.state.thrustAdjust = 0;
+
+    for (int i = 0; i < SIM_MAX_ENGINES; i++) {
+        sim.engines[i] = EngineData{};
+        sim.engines[i].N1 = 0;
+        sim.engines[i].T = 20;
+        sim.engines[i].FF = 0;
+    }
+    for (int k = 0; k < SIM_MAX_TANKS; k++) sim.tanks[k] = { k < config.tankCount ? config.tankCapacity : 0, false };
+
+    sim.now = 0;
+    sim.startTime = 0;
+    sim.stopTime = 0;
+
+    sim.egtBase = 20.0;
+    sim.egtDelta = 0.0;
+
+    memset(&sim.rng, 0, sizeof(sim.rng));
+    simSeed(sim, 1);
+    sim.injectedFaults = 0;
+    sim.faults.fuel = NO_FAULT;
+    sim.faults.ff = NO_FAULT;
+    for (int i = 0; i < SIM_MAX_ENGINES; i++) sim.faults.n1[i] = sim.faults.egt[i] = NO_FAULT;
+    simResetFaultRules(sim);
+    alertClear(sim.alerts);
+}
+
+double simTotalFuel(const SimState& sim) {
+    double total = 0;
+    for (int k = 0; k < sim.config.tankCount; k++) total += sim.tanks[k].C;
+    return total;
+}
+
+bool simFuelSensorFail(const SimState& sim) {
+    for (int k = 0; k < sim.config.tankCount; k++) {
+        if (sim.tanks[k].fuelSensorFail) return true;
+    }
+    return false;
+}
+
+// 启动对数段流量 V = 42 log10(max(x, 1)) + 10 的原函数
+static double startFlowIntegral(double x) {
+    if (x <= 1) return 10 * x;
+    return 42 / log(10.0) * (x * log(x) - x + 1) + 10 * x;
+}
+
+// 数据更新逻辑
+void updateData(EngineSim& sim, double dt) {
+    ProgramState& st = sim.state;
+    const int ne = sim.config.engineCount;
+    double t = (sim.now - sim.startTime) / 1e6; // seconds
+
+    // 所有动态都按经过的标定步数 n 精确计算：逼近目标按 1 - 0.9^n，
+    // 随机游走的增量按 sqrt(n) 缩放，步长变大时统计特性不变
+    double n = dt / SIM_REFERENCE_DT;
+    double walk = sqrt(n);
+    egtBaselineWalk(sim, n);
+    double value = sim.egtBase;
+    // 各发动机本步燃油消耗，解析段按流量积分给出，其余按 FF*dt
+    double burn[SIM_MAX_ENGINES];
+    for (int i = 0; i < ne; i++) burn[i] = -1;
+
+    // 根据状态决定N,T,V变化；各发动机的随机扰动来自各自的随机流
+    if (st.state == ENGINE_OFF) {
+        st.thrustAdjust = 0;
+        st.start_light_on = false;
+        st.run_light_on = false;
+        for (int i = 0; i < ne; i++) {
+            EngineData& e = sim.engines[i];
+            e.N1 = 0;
+            e.FF = 0;
+            e.T = value + ((simRand(sim, engineChannel(i)) % 201 - 100) / 100.0) * 0.005;
+        }
+    }
+    else if (st.state == ENGINE_STARTING) {
+        bool linear = false;
+        for (int i = 0; i < ne; i++) linear = linear || sim.engines[i].N1 < 50;
+        if (linear) {
+            // 线性增加阶段（全部发动机到 50 后一起转入对数段）
+            for (int i = 0; i < ne; i++) {
+                EngineData& e = sim.engines[i];
+                e.N1 += 10000.0 / 40000 * dt * 100 + (simRand(sim, engineChannel(i)) % 3 - 1) * 0.3 * walk;
+                burn[i] = (e.FF + 2.5 * dt) * dt; // 线性上升段的精确积分
+                e.FF += 5.0 * dt;
+                e.T = value + ((simRand(sim, engineChannel(i)) % 201 - 100) / 100.0) * 0.005;
+            }
+        }
+        else {
+            // 对数上升阶段
+            double x = t - 1;
+            // 曲线在 n1 = 95 处交给稳态段；大步长时不越过该点，稳态从同样的数值开始
+            const double xRun = pow(10.0, 18000.0 / 23000.0) * (1 + 1e-9);
+            double logBurn = startFlowIntegral(x > xRun ? xRun : x) - startFlowIntegral(std::min(x - dt, xRun));
+            if (x > xRun) {
+                logBurn += (42 * log10(xRun) + 10) * (x - std::max(x - dt, xRun));
+                x = xRun;
+            }
+            double V = 42 * log10(x > 1 ? x : 1) + 10;
+            if (V < 0) V = 0;
+            if (V > 50) V = 50;
+            double N = 23000 * log10(x > 1 ? x : 1) + 20000; //实际转速N，这里N1 = N/40000*100
+            double n1 = N / 400.0;
+            if (n1 > 95) {
+                st.state = ENGINE_RUNNING;
+                st.stabilized = true;
+                st.start_light_on = false;
+                st.run_light_on = true;
+            }
+            double v = simFaultInjected(sim, OVER_TEMP2) ? 1500 : (simFaultInjected(sim, OVER_TEMP1) ? 1170 : 900);
+            double T = v * log10(x > 1 ? x : 1) + 20;
+            for (int i = 0; i < ne; i++) {
+                EngineData& e = sim.engines[i];
+                SimRngChannel ch = engineChannel(i);
+                e.N1 = n1 + (simRand(sim, ch) % 3 - 1) * 0.3;
+                e.FF = V + (simRand(sim, ch) % 3 - 1) * 0.03;
+                e.T = T + (simRand(sim, ch) % 3 - 1) * 0.3;
+                burn[i] = logBurn;
+            }
+        }
+    }
+    else if (st.state == ENGINE_RUNNING) {
+        // 稳态阶段
+        if (st.thrustAdjust == 0) {
+            for (int i = 0; i < ne; i++) {
+                EngineData& e = sim.engines[i];
+                SimRngChannel ch = engineChannel(i);
+                e.N1 += (simRand(sim, ch) % 3 - 1) * 0.05 * walk;
+                e.FF += (simRand(sim, ch) % 3 - 1) * 0.05 * walk;
+                e.T += (simRand(sim, ch) % 3 - 1) * 0.5 * walk;
+            }
+        }
+        else {
+            // 平滑过渡到目标值
+            double smoothingFactor = 1 - pow(0.9, n); // 每个标定步逼近 10%
+            bool settled = true;
+            for (int i = 0; i < ne; i++) {
+                EngineData& e = sim.engines[i];
+                e.N1 += (e.targetN1 - e.N1) * smoothingFactor; // 转速逐步逼近目标值
+                e.FF += (e.targetFF - e.FF) * smoothingFactor; // 燃油流速逐步逼近目标值
+                e.T += (e.targetT - e.T) * smoothingFactor;    // 温度逐步逼近目标值
+                settled = settled && fabs(e.targetFF - e.FF) < 0.01
+                    && fabs(e.targetN1 - e.N1) < 0.01
+                    && fabs(e.targetT - e.T) < 0.01;
+            }
+            if (settled) st.thrustAdjust = 0;
+        }
+    }
+    else if (st.state == ENGINE_STOPPING) {
+        st.thrustAdjust = 0;
+        // 初始化停止状态时的初始值
+        if (st.state_changed) {
+            st.state_changed = false; // 防止多次初始化
+            for (int i = 0; i < ne; i++) {
+                sim.engines[i].initialN1 = sim.engines[i].N1; // 记录当前转速
+                sim.engines[i].initialT = sim.engines[i].T;   // 记录当前温度
+            }
+            sim.stopTime = sim.now;    // 记录停止开始时间
+        }
+
+        double elapsedTime = (sim.now - sim.stopTime) / 1e6;
+        double logFactor = log10(elapsedTime + 1) / log10(4 + 1); // 对数归一化
+        if (logFactor > 1) logFactor = 1; // 大步长时不越过终值
+
+        bool allStopped = true;
+        for (int i = 0; i < ne; i++) {
+            EngineData& e = sim.engines[i];
+            e.FF = 0; // 燃油流速直接归零
+            e.N1 = e.initialN1 * (1 - logFactor); // 转速从初始值下降
+            e.T = 20 + (e.initialT - 20) * (1 - logFactor); // 温度从初始值下降到 20
+            allStopped = allStopped && e.N1 <= 1.0;
+        }
+
+        // 停止条件：全部发动机停转
+        if (allStopped) {
+            st.state = ENGINE_OFF; // 切换到关闭状态
+            st.run_light_on = false; // 关闭运行灯
+            st.state_changed = true;
+        }
+    }
+
+    // 燃油余量C = 上一时刻C - FF*dt。原双发模型按两发平均流量耗油，即每台发动机计 FF/2；
+    // 从其供油油箱扣除，油量传感器故障的油箱不计
+    if (st.state != ENGINE_OFF) {
+        for (int i = 0; i < ne; i++) {
+            FuelData& tank = sim.tanks[simFeedTank(sim, i)];
+            if (tank.fuelSensorFail) continue;
+            tank.C -= 0.5 * (burn[i] >= 0 ? burn[i] : sim.engines[i].FF * dt);
+            if (tank.C < 0) tank.C = 0;
+        }
+    }
+
+    // 若全部发动机 N1 下降至95以下，run灯熄灭，回升后再次亮起
+    if (st.stabilized) {
+        bool anyAbove = false;
+        for (int i = 0; i < ne; i++) anyAbove = anyAbove || sim.engines[i].N1 >= 95;
+        st.run_light_on = anyAbove;
+    }
+
+    // 写入数据
+    TelemetrySample s;
+    simMakeSample(sim, s);
+    for (TelemetrySink* sink : sim.sinks) sink->onSample(s);
+}
+
+void simMakeSample(const SimState& sim, TelemetrySample& s) {
+    s.timeMs = simElapsedMs(sim);
+    s.engineCount = sim.config.engineCount;
+    s.sensorFlags = simFuelSensorFail(sim) ? SENSOR_FUEL : 0;
+    for (int i = 0; i < SIM_MAX_ENGINES; i++) {
+        if (i >= s.engineCount) {
+            s.N1[i] = s.T[i] = s.FF[i] = 0;
+            continue;
+        }
+        const EngineData& e = sim.engines[i];
+        s.N1[i] = e.N1;
+        s.T[i] = e.T;
+        s.FF[i] = e.FF;
+        uint32_t bits = (e.n1Sensor1Fail ? SENSOR_N1S1 : 0) | (e.n1Sensor2Fail ? SENSOR_N1S2 : 0)
+            | (e.egtSensor1Fail ? SENSOR_EGTS1 : 0) | (e.egtSensor2Fail ? SENSOR_EGTS2 : 0);
+        s.sensorFlags |= bits << (4 * i);
+    }
+    s.fuel = simTotalFuel(sim);
+    s.state = sim.state.state;
+}
+
+// 记录中只有燃油合计，回放时平均分到各油箱
+void simLoadSample(EngineSim& sim, const TelemetrySample& s) {
+    int n = std::min(s.engineCount, (int32_t)sim.config.engineCount);
+    for (int i = 0; i < n; i++) {
+        EngineData& e = sim.engines[i];
+        uint32_t bits = s.sensorFlags >> (4 * i);
+        e.N1 = s.N1[i];
+        e.T = s.T[i];
+        e.FF = s.FF[i];
+        e.n1Sensor1Fail = (bits & SENSOR_N1S1) != 0;
+        e.n1Sensor2Fail = (bits & SENSOR_N1S2) != 0;
+        e.egtSensor1Fail = (bits & SENSOR_EGTS1) != 0;
+        e.egtSensor2Fail = (bits & SENSOR_EGTS2) != 0;
+    }
+    for (int k = 0; k < sim.config.tankCount; k++) {
+        sim.tanks[k].C = s.fuel / sim.config.tankCount;
+        sim.tanks[k].fuelSensorFail = (s.sensorFlags & SENSOR_FUEL) != 0;
+    }
+    sim.state.state = (EngineState)s.state;
+    sim.state.run_light_on = s.state == ENGINE_RUNNING;
+    sim.state.start_light_on = s.state == ENGINE_STARTING;
+}
+
+void simStep(EngineSim& sim, double dt) {
+    SimTime step = (SimTime)llround(dt * 1e6);
+    sim.now += step;
+    sim.rng.tick++;
+    memset(sim.rng.draws, 0, sizeof(sim.rng.draws));
+    {
+        TRACE_ZONE("updateData");
+        updateData(sim, step / 1e6);
+    }
+    {
+        TRACE_ZONE("checkFault");
+        checkFault(sim);
+    }
+    simExpireAlerts(sim);
+}
+
+// 当前段可以一步跨过的终点（绝对时刻）；稳态等随机段返回 -1
+static SimTime simAnalyticSegmentEnd(const EngineSim& sim) {
+    const ProgramState& st = sim.state;
+    double minN1 = 1e9, maxInitialN1 = 0;
+    for (int i = 0; i < sim.config.engineCount; i++) {
+        minN1 = std::min(minN1, sim.engines[i].N1);
+        maxInitialN1 = std::max(maxInitialN1, sim.engines[i].initialN1);
+    }
+    switch (st.state) {
+    case ENGINE_OFF:
+        // 只有基准值随机游走，其 n 步转移是精确的
+        return INT64_MAX;
+    case ENGINE_STARTING:
+        if (minN1 < 50) {
+            // 线性段：N1 每秒 +25，全部到 50 转入对数段
+            return sim.now + (SimTime)ceil((50 - minN1) / 25.0 * 1e6);
+        }
+        // 对数段：N1 只是时间的函数，在 n1 = 95 处转入稳态
+        return sim.startTime + (SimTime)ceil((1 + pow(10.0, 18000.0 / 23000.0) * (1 + 1e-9)) * 1e6) + 1;
+    case ENGINE_STOPPING:
+        // 首步要记录停车起点
+        if (st.state_changed) return -1;
+        // N1 = initialN1 (1 - log5(elapsed + 1)) 全部降到 1 时转为 OFF
+        if (maxInitialN1 <= 1) return sim.now;
+        return sim.stopTime + (SimTime)ceil((pow(5.0, 1 - 1 / maxInitialN1) - 1) * 1e6) + 1;
+    default:
+        return -1;
+    }
+}
+
+long long simAdvanceTo(EngineSim& sim, SimTime target, double maxStep) {
+    const SimTime minStep = (SimTime)llround(SIM_REFERENCE_DT * 1e6);
+    const SimTime maxStepUs = std::max((SimTime)llround(maxStep * 1e6), minStep);
+    long long steps = 0;
+    while (sim.now < target) {
+        SimTime end = simAnalyticSegmentEnd(sim);
+        SimTime step = end < 0 ? maxStepUs : std::max(end - sim.now, minStep);
+        step = std::min(step, target - sim.now);
+        simStep(sim, step / 1e6);
+        steps++;
+    }
+    return steps;
+}
+
+// 清除所有已经过期的告警
+void simExpireAlerts(EngineSim& sim) {
+    alertExpire(sim.alerts, sim.now);
+}
+
+void simStart(EngineSim& sim) {
+    if (sim.state.state != ENGINE_OFF) return;
+    sim.state.state = ENGINE_STARTING;
+    sim.state.started = true;
+    sim.state.start_light_on = true;
+    sim.state.run_light_on = false;
+    sim.startTime = sim.now; //重新计时
+    sim.state.state_changed = true;
+}
+
+// Stop优先级最高
+void simStop(EngineSim& sim) {
+    sim.state.state = ENGINE_STOPPING;
+    sim.stopTime = sim.now;
+    sim.state.state_changed = true;
+}
+
+// 增加/减小推力：油门同步推动，各发动机从自己的当前值出发
+static void simThrust(EngineSim& sim, int dir) {
+    if (sim.state.state != ENGINE_RUNNING) return;
+    sim.state.thrustAdjust = dir;
+    // 目标转速、温度增加（减少）3%-5%，燃油流速目标值增加（减少）1
+    double n1Gain = 1 + dir * (0.03 + ((simRand(sim, SIM_RNG_CONTROL) % 3) * 0.01));
+    double tGain = 1 + dir * (0.03 + ((simRand(sim, SIM_RNG_CONTROL) % 3) * 0.01));
+    for (int i = 0; i < sim.config.engineCount; i++) {
+        EngineData& e = sim.engines[i];
+        e.targetN1 = e.N1 * n1Gain;
+        e.targetFF = e.FF + dir;
+        e.targetT = e.T * tGain;
+    }
+}
+
+void simThrustUp(EngineSim& sim) {
+    simThrust(sim, 1);
+}
+
+void simThrustDown(EngineSim& sim) {
+    simThrust(sim, -1);
+}
+
+bool simFaultInjected(const SimState& sim, FaultType ft) {
+    return (sim.injectedFaults >> ft) & 1u;
+}
+
+void simSetFault(EngineSim& sim, FaultType ft, bool active, int engine) {
+    const int n = sim.config.engineCount;
+    if (engine >= n) return;
+    if (active) sim.injectedFaults |= 1u << ft;
+    else sim.injectedFaults &= ~(1u << ft);
+
+    // 作用范围：未指定发动机时单发传感器故障作用于 0 号，其余作用于全部发动机
+    bool oneEngine = ft == N1S1_FAIL || ft == N1S2_FAIL || ft == EGTS1_FAIL || ft == EGTS2_FAIL;
+    int first = engine >= 0 ? engine : 0;
+    int last = engine >= 0 ? engine + 1 : (oneEngine ? 1 : n);
+    for (int i = first; i < last; i++) {
+        EngineData& e = sim.engines[i];
+        // 传感器故障：注入时置位，取消时复位
+        if (ft == N1S1_FAIL) e.n1Sensor1Fail = active;
+        if (ft == N1S2_FAIL || ft == N1S_FAIL) e.n1Sensor1Fail = e.n1Sensor2Fail = active;
+        if (ft == EGTS1_FAIL) e.egtSensor1Fail = active;
+        if (ft == EGTS2_FAIL || ft == EGTS_FAIL) e.egtSensor1Fail = e.egtSensor2Fail = active;
+
+        if (active) {
+            if (ft == OVER_FF) e.FF = 52;
+            if (ft == OVER_SPD1) e.N1 = 107;
+            if (ft == OVER_SPD2) e.N1 = 122;
+            if (ft == OVER_TEMP3) e.T = 952;
+            if (ft == OVER_TEMP4) e.T = 1102;
+        }
+        else {
+            // 取消故障效果（假设重置为正常状态）
+            if (ft == OVER_FF) e.FF = 40;
+            if (ft == OVER_SPD1 || ft == OVER_SPD2) e.N1 = 95; // 正常转速
+            if (ft == OVER_TEMP1 || ft == OVER_TEMP2 || ft == OVER_TEMP3 || ft == OVER_TEMP4)
+                e.T = 730; // 正常温度
+        }
+    }
+    if (active && (ft == N1S_FAIL || ft == EGTS_FAIL)) sim.stopTime = sim.now;
+
+    // 燃油类故障作用于全部油箱，指定发动机时只作用于其供油油箱
+    for (int k = 0; k < sim.config.tankCount; k++) {
+        if (engine >= 0 && k != sim.config.engineTank[engine]) continue;
+        FuelData& tank = sim.tanks[k];
+        if (ft == FUELS_FAIL) tank.fuelSensorFail = active;
+        if (ft == LOW_FUEL) tank.C = active ? 998 : sim.config.tankCapacity; // 取消时重置为正常油量
+    }
+}
@@ -0,0 +1,287 @@
+﻿#pragma once
+// 发动机仿真核心：不依赖 EasyX / Win32，可在任意平台无界面运行
+#include <cstdint>
+#include <vector>
+
+// 引擎状态枚举
+enum EngineState {
+    ENGINE_OFF,
+    ENGINE_STARTING,
+    ENGINE_RUNNING,
+    ENGINE_STOPPING
+};
+
+// 异常类型（14种异常描述）
+enum FaultType {
+    NO_FAULT = 0,
+
+    // 传感器异常类
+    N1S1_FAIL,   // 单个转速传感器全故障
+    N1S2_FAIL,   // 单发转速传感器全故障
+    EGTS1_FAIL,  // 单个EGT传感器全故障
+    EGTS2_FAIL,  // 单发EGT传感器全故障
+    N1S_FAIL,    // 双发转速传感器全故障
+    EGTS_FAIL,   // 双发EGT传感器全故障
+
+    // 燃油类异常
+    LOW_FUEL,
+    FUELS_FAIL,
+    OVER_FF,   // 燃油流速超过 50
+    // 转速异常
+    OVER_SPD1, // N1>105
+    OVER_SPD2, // N1>120
+    // 温度异常
+    OVER_TEMP1, // 启动中T>850
+    OVER_TEMP2, // 启动中T>1000
+    OVER_TEMP3, // 稳态中T>950
+    OVER_TEMP4, // 稳态中T>1100
+
+    FAULT_TYPE_COUNT
+};
+
+// 仿真时钟，单位微秒
+typedef int64_t SimTime;
+
+// 模型参数标定时的步长（秒）；其他步长下的动态按它换算
+constexpr double SIM_REFERENCE_DT = 0.005;
+
+// 告警信息
+struct AlertInfo {
+    FaultType type;
+    const char* text;        // 静态字符串（faultTypeToString）
+    SimTime last_trigger_time;
+    int8_t prev, next;       // 告警表链表中的前后槽位，ALERT_NONE 为无
+    bool active;
+};
+
+enum { ALERT_NONE = -1 };
+// 同一告警 5 秒内不重复记录，5 秒后过期
+constexpr SimTime ALERT_HOLD_US = 5000000;
+
+// 告警表：每种 FaultType 一个固定槽位，不做动态分配。
+// 活动告警按最近一次触发时刻串成链表；过期时间都是触发后 5 秒，
+// 所以链表顺序也是过期顺序，过期只需从表头摘除，显示也按此顺序。
+struct AlertTable {
+    AlertInfo slots[FAULT_TYPE_COUNT];
+    int8_t head, tail;
+    int count;
+
+    // 按显示顺序遍历活动告警
+    struct Iterator {
+        const AlertTable* table;
+        int slot;
+        const AlertInfo& operator*() const { return table->slots[slot]; }
+        Iterator& operator++() { slot = table->slots[slot].next; return *this; }
+        bool operator!=(const Iterator& o) const { return slot != o.slot; }
+    };
+    Iterator begin() const { return Iterator{ this, head }; }
+    Iterator end() const { return Iterator{ this, ALERT_NONE }; }
+};
+
+void alertClear(AlertTable& t);
+// 触发告警：5 秒内已记录过返回 false，否则记录（或重新计时）并返回 true
+bool alertTrigger(AlertTable& t, FaultType ft, SimTime now);
+// 摘除已满 5 秒的告警，代价与过期条数成正比
+void alertExpire(AlertTable& t, SimTime now);
+
+// 单台发动机数据（各发动机动态独立）
+struct EngineData {
+    double N1;    // 转速百分比, 0~125
+    double T;     // 温度 ℃, -5~1200
+    double FF;    // Fuel Flow 燃油流速 0~50
+    bool n1Sensor1Fail;
+    bool n1Sensor2Fail;
+    bool egtSensor1Fail;
+    bool egtSensor2Fail;
+    double targetN1;
+    double targetT;
+    double targetFF;
+    double initialN1; // 停止时的转速起点
+    double initialT;  // 停止时的温度起点
+};
+
+// 油箱数据
+struct FuelData {
+    double C; // 燃油余量 0~20000
+    bool fuelSensorFail;
+};
+
+// 程序状态
+struct ProgramState {
+    EngineState state;
+    bool started;
+    bool stabilized;
+    bool stopped;
+    bool run_light_on;   // run灯状态
+    bool start_light_on; // start灯状态
+    bool state_changed; // 状态是否刚刚改变
+    // 推力调整按钮计数
+    double thrustAdjust;
+};
+
+// 发动机与油箱数量上限；默认构型为双发单油箱，界面与 data.csv 的 left/right 列即 0、1 号发动机
+enum { SIM_LEFT = 0, SIM_RIGHT = 1, SIM_MAX_ENGINES = 4, SIM_MAX_TANKS = 4, SIM_DEFAULT_ENGINES = 2 };
+
+// 机型构型：发动机数、油箱数、每台发动机的供油油箱
+struct SimConfig {
+    int engineCount;                    // 1~SIM_MAX_ENGINES
+    int tankCount;                      // 1~SIM_MAX_TANKS
+    int8_t engineTank[SIM_MAX_ENGINES]; // 每台发动机的供油油箱
+    bool crossFeed;                     // 交输供油：各发动机从当前油量最多的油箱取油
+    bool filteredAlerts;                // 告警用带确认时间与回差的规则表（fault_rules.h）
+    double tankCapacity;                // 每个油箱的初始油量
+};
+
+// engines 台发动机按顺序均分到 tanks 个油箱；数量超出范围时返回 false
+bool simConfigMake(SimConfig& c, int engines, int tanks = 1, bool crossFeed = false, double tankCapacity = 3000);
+
+// 故障规则表（fault_rules.h）的最大条数
+enum { SIM_MAX_FAULT_RULES = 16 };
+
+// 每一步故障检查的结果，供界面绘制
+struct SimFaults {
+    FaultType fuel;
+    FaultType ff;
+    FaultType n1[SIM_MAX_ENGINES];
+    FaultType egt[SIM_MAX_ENGINES];
+};
+
+// 传感器故障标志（TelemetrySample::sensorFlags），每台发动机占 4 位
+constexpr uint32_t SENSOR_N1S1 = 1;
+constexpr uint32_t SENSOR_N1S2 = 2;
+constexpr uint32_t SENSOR_EGTS1 = 4;
+constexpr uint32_t SENSOR_EGTS2 = 8;
+constexpr uint32_t SENSOR_FUEL = 1u << 31;
+
+// 一条遥测记录（对应 data.csv 的一行，另带状态机状态与传感器故障标志）
+struct TelemetrySample {
+    int64_t timeMs; // 自启动计时起的毫秒数
+    int32_t engineCount;
+    double N1[SIM_MAX_ENGINES];
+    double T[SIM_MAX_ENGINES];
+    double FF[SIM_MAX_ENGINES];
+    double fuel;          // 各油箱合计
+    int32_t state;        // EngineState
+    uint32_t sensorFlags; // 不写入 CSV
+};
+
+// 遥测输出接口：每步一条数据记录，每次新告警一条日志
+class TelemetrySink {
+public:
+    virtual ~TelemetrySink() {}
+    virtual void onSample(const TelemetrySample& s) = 0;
+    virtual void onFault(int64_t timeMs, FaultType ft) = 0;
+};
+
+// 随机数通道：每台发动机、EGT 基准值和控制输入各有独立的随机流
+enum SimRngChannel {
+    SIM_RNG_ENGINE = 0,              // 第 i 台发动机为 SIM_RNG_ENGINE + i
+    SIM_RNG_PANEL = SIM_MAX_ENGINES, // EGT 基准值随机游走
+    SIM_RNG_CONTROL,                 // 推力按钮
+    SIM_RNG_CHANNELS
+};
+
+// 计数器型随机数（philox.h）：密钥为 (seed, stream)，计数器为 (tick, 组号, 通道)
+struct SimRng {
+    uint32_t seed;
+    uint32_t stream;                  // 实例编号，同一种子下区分多个仿真
+    uint64_t tick;                    // 已执行的 simStep 次数
+    uint32_t draws[SIM_RNG_CHANNELS]; // 本 tick 各通道已取的个数
+    // 最近算出的一组 4 个数
+    uint64_t cachedTick;
+    uint32_t cachedChannel, cachedGroup;
+    uint32_t cached[4];
+};
+
+// 一架飞机仿真的全部状态（不含输出接口）；可按字节复制，用于检查点与分支（checkpoint.h）。
+// 发动机与油箱连续存放，按 config 中的数量遍历
+struct SimState {
+    SimConfig config;
+    ProgramState state;
+    EngineData engines[SIM_MAX_ENGINES];
+    FuelData tanks[SIM_MAX_TANKS];
+    SimTime now;       // 当前仿真时刻
+    SimTime startTime; // 启动计时起点
+    SimTime stopTime;  // 停车计时起点
+
+    double egtBase;    // EGT 表盘基准值（随机游走）
+    double egtDelta;   // 基准值当前变化速率
+
+    SimRng rng;              // 本实例的随机数（多个实例可在不同线程并行）
+    uint32_t injectedFaults; // 已注入的故障（按 FaultType 位）
+    SimFaults faults;
+    // 故障规则状态：已锁存的规则位、确认计时、上次检查时刻
+    int32_t ruleBits[SIM_MAX_ENGINES];
+    double ruleTimers[SIM_MAX_FAULT_RULES][SIM_MAX_ENGINES];
+    SimTime lastFaultCheck;
+
+    // 告警记录(5秒内同一种不重复记录)
+    AlertTable alerts;
+};
+
+struct EngineSim : SimState {
+    std::vector<TelemetrySink*> sinks;
+};
+
+// 根据故障类型获取文本
+const char* faultTypeToString(FaultType ft);
+// 枚举名（如 "OVER_TEMP3"）与 FaultType 互转，未知名称返回 NO_FAULT
+const char* faultTypeName(FaultType ft);
+FaultType faultTypeFromName(const char* name);
+// 状态名（"OFF"/"STARTING"/"RUNNING"/"STOPPING"），未知名称返回 -1
+const char* engineStateName(int state);
+int engineStateFromName(const char* name);
+
+// 按构型初始化，默认为双发单油箱
+void simInit(EngineSim& sim);
+void simInit(EngineSim& sim, const SimConfig& config);
+// 设置随机种子与实例编号；同一 (seed, stream) 的运行逐位可复现
+void simSeed(EngineSim& sim, uint32_t seed, uint32_t stream = 0);
+// 推进 dt 秒：更新数据、检查故障、过期告警
+void simStep(EngineSim& sim, double dt);
+// 快进到 target：解析段（OFF、启动线性段与对数段、停车衰减）一步跨到段末，
+// 稳态等随机段按不超过 maxStep 秒的步长推进；动态与 dt 无关，结果与逐步推进统计一致。
+// 故障检查与遥测记录只在每步末尾进行。返回执行的步数。
+long long simAdvanceTo(EngineSim& sim, SimTime target, double maxStep = 0.1);
+
+// 控制输入（对应 START/STOP/▲/▼ 按钮）
+void simStart(EngineSim& sim);
+void simStop(EngineSim& sim);
+void simThrustUp(EngineSim& sim);
+void simThrustDown(EngineSim& sim);
+// 注入或取消故障（对应告警框按钮）。engine < 0 时与界面相同：传感器故障作用于 0 号发动机，
+// N1S_FAIL/EGTS_FAIL 作用于全部发动机，超限类故障改写全部发动机；否则只作用于第 engine 台
+void simSetFault(EngineSim& sim, FaultType ft, bool active, int engine = -1);
+bool simFaultInjected(const SimState& sim, FaultType ft);
+// 各油箱燃油合计
+double simTotalFuel(const SimState& sim);
+// 是否有油箱的油量传感器故障
+bool simFuelSensorFail(const SimState& sim);
+
+// 以下为 simStep 的组成部分
+void updateData(EngineSim& sim, double dt);
+// EGT 基准值随机游走的 n 个标定步（n 可为小数）。以偏差 v = value - 20 与速率 d 表示：
+//   v' = a v + c d + l11 z0,  d' = b d + l21 z0 + l22 z1，z0、z1 为独立标准正态数
+struct EgtWalkStep {
+    double a, b, c;
+    double l11, l21, l22;
+};
+void egtWalkStep(double n, EgtWalkStep& out);
+// 按规则表求出各发动机的故障位，记录告警，停车规则成立时停车
+void checkFault(EngineSim& sim);
+// 由故障位（1 << FaultType）取各组最严重的一项，不改变仿真状态
+FaultType checkFuelFault(const EngineSim& sim, uint32_t faultBits);
+FaultType checkN1Fault(const EngineData& engine, uint32_t faultBits);
+FaultType checkTemperatureFault(const EngineData& engine, uint32_t faultBits);
+// 清除规则的锁存与确认计时（回放跳转后调用）
+void simResetFaultRules(EngineSim& sim);
+void logFault(EngineSim& sim, FaultType ft);
+void simExpireAlerts(EngineSim& sim);
+
+// 回放：把记录的数值和状态装入 sim，只做故障检查与告警，不推进物理
+void simLoadSample(EngineSim& sim, const TelemetrySample& s);
+void simMakeSample(const SimState& sim, TelemetrySample& s);
+
+inline int64_t simElapsedMs(const SimState& sim) {
+    return (sim.now - sim.startTime) / 1000;
+}
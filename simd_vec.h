@@ -0,0 +1,186 @@
+﻿#pragma once
+// 轻量 SIMD 封装：同一份内核代码可编译为标量 / AVX2 / AVX-512 版本
+// 编译时按 __AVX512F__ / __AVX2__ 选择（MSVC 用 /arch:AVX2 或 /arch:AVX512）
+#include <cstdint>
+#include <cstring>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// 标量版本（1路）
+struct VecScalar {
+    typedef bool Mask;
+    enum { WIDTH = 1 };
+    double v;
+
+    VecScalar() {}
+    VecScalar(double x) : v(x) {}
+    static VecScalar load(const double* p) { return VecScalar(*p); }
+    void store(double* p) const { *p = v; }
+    static VecScalar loadInt32(const int32_t* p) { return VecScalar((double)*p); }
+    void storeInt32(int32_t* p) const { *p = (int32_t)v; }
+    // 任一指定位为 1 的通道
+    static Mask testBits(const int32_t* p, int32_t bits) { return (*p & bits) != 0; }
+
+    friend VecScalar operator+(VecScalar a, VecScalar b) { return a.v + b.v; }
+    friend VecScalar operator-(VecScalar a, VecScalar b) { return a.v - b.v; }
+    friend VecScalar operator*(VecScalar a, VecScalar b) { return a.v * b.v; }
+    friend VecScalar operator/(VecScalar a, VecScalar b) { return a.v / b.v; }
+    friend Mask operator<(VecScalar a, VecScalar b) { return a.v < b.v; }
+    friend Mask operator>(VecScalar a, VecScalar b) { return a.v > b.v; }
+    friend Mask operator<=(VecScalar a, VecScalar b) { return a.v <= b.v; }
+    friend Mask operator>=(VecScalar a, VecScalar b) { return a.v >= b.v; }
+    friend Mask operator==(VecScalar a, VecScalar b) { return a.v == b.v; }
+    static VecScalar min(VecScalar a, VecScalar b) { return a.v < b.v ? a : b; }
+    static VecScalar max(VecScalar a, VecScalar b) { return a.v > b.v ? a : b; }
+    static VecScalar abs(VecScalar a) { return a.v < 0 ? -a.v : a.v; }
+    static VecScalar select(Mask m, VecScalar a, VecScalar b) { return m ? a : b; }
+    static Mask maskAnd(Mask a, Mask b) { return a & b; }
+    static Mask maskOr(Mask a, Mask b) { return a | b; }
+    static Mask maskNot(Mask a) { return !a; }
+    static bool any(Mask m) { return m; }
+    // 拆分 x = m * 2^e，m∈[1,2)
+    static void frexp12(VecScalar x, VecScalar& m, VecScalar& e) {
+        uint64_t bits;
+        memcpy(&bits, &x.v, 8);
+        e.v = (double)((int)((bits >> 52) & 0x7ff) - 1023);
+        bits = (bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull;
+        memcpy(&m.v, &bits, 8);
+    }
+};
+
+#if defined(__AVX2__)
+// AVX2 版本（4路 double）
+struct VecAvx2 {
+    typedef __m256d Mask;
+    enum { WIDTH = 4 };
+    __m256d v;
+
+    VecAvx2() {}
+    VecAvx2(__m256d x) : v(x) {}
+    VecAvx2(double x) : v(_mm256_set1_pd(x)) {}
+    static VecAvx2 load(const double* p) { return _mm256_loadu_pd(p); }
+    void store(double* p) const { _mm256_storeu_pd(p, v); }
+    static VecAvx2 loadInt32(const int32_t* p) {
+        return _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)p));
+    }
+    void storeInt32(int32_t* p) const { _mm_storeu_si128((__m128i*)p, _mm256_cvttpd_epi32(v)); }
+    static Mask testBits(const int32_t* p, int32_t bits) {
+        __m128i x = _mm_and_si128(_mm_loadu_si128((const __m128i*)p), _mm_set1_epi32(bits));
+        __m128i zero = _mm_cmpeq_epi32(x, _mm_setzero_si128());
+        // 32位掩码扩展为64位通道后取反
+        __m256i wide = _mm256_cvtepi32_epi64(zero);
+        return _mm256_castsi256_pd(_mm256_xor_si256(wide, _mm256_set1_epi64x(-1)));
+    }
+
+    friend VecAvx2 operator+(VecAvx2 a, VecAvx2 b) { return _mm256_add_pd(a.v, b.v); }
+    friend VecAvx2 operator-(VecAvx2 a, VecAvx2 b) { return _mm256_sub_pd(a.v, b.v); }
+    friend VecAvx2 operator*(VecAvx2 a, VecAvx2 b) { return _mm256_mul_pd(a.v, b.v); }
+    friend VecAvx2 operator/(VecAvx2 a, VecAvx2 b) { return _mm256_div_pd(a.v, b.v); }
+    friend Mask operator<(VecAvx2 a, VecAvx2 b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ); }
+    friend Mask operator>(VecAvx2 a, VecAvx2 b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ); }
+    friend Mask operator<=(VecAvx2 a, VecAvx2 b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ); }
+    friend Mask operator>=(VecAvx2 a, VecAvx2 b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ); }
+    friend Mask operator==(VecAvx2 a, VecAvx2 b) { return _mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ); }
+    static VecAvx2 min(VecAvx2 a, VecAvx2 b) { return _mm256_min_pd(a.v, b.v); }
+    static VecAvx2 max(VecAvx2 a, VecAvx2 b) { return _mm256_max_pd(a.v, b.v); }
+    static VecAvx2 abs(VecAvx2 a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v); }
+    static VecAvx2 select(Mask m, VecAvx2 a, VecAvx2 b) { return _mm256_blendv_pd(b.v, a.v, m); }
+    static Mask maskAnd(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+    static Mask maskOr(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+    static Mask maskNot(Mask a) { return _mm256_xor_pd(a, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))); }
+    static bool any(Mask m) { return _mm256_movemask_pd(m) != 0; }
+    static void frexp12(VecAvx2 x, VecAvx2& m, VecAvx2& e) {
+        __m256i bits = _mm256_castpd_si256(x.v);
+        // 指数转 double：借助 2^52 魔数避免 AVX2 缺少的 int64->double 指令
+        __m256i ex = _mm256_srli_epi64(bits, 52);
+        __m256d magic = _mm256_castsi256_pd(_mm256_or_si256(ex, _mm256_set1_epi64x(0x4330000000000000ll)));
+        e.v = _mm256_sub_pd(magic, _mm256_set1_pd(4503599627370496.0 + 1023.0));
+        __m256i mant = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFll)),
+            _mm256_set1_epi64x(0x3FF0000000000000ll));
+        m.v = _mm256_castsi256_pd(mant);
+    }
+};
+#endif
+
+#if defined(__AVX512F__)
+// AVX-512 版本（8路 double）
+struct VecAvx512 {
+    typedef __mmask8 Mask;
+    enum { WIDTH = 8 };
+    __m512d v;
+
+    VecAvx512() {}
+    VecAvx512(__m512d x) : v(x) {}
+    VecAvx512(double x) : v(_mm512_set1_pd(x)) {}
+    static VecAvx512 load(const double* p) { return _mm512_loadu_pd(p); }
+    void store(double* p) const { _mm512_storeu_pd(p, v); }
+    static VecAvx512 loadInt32(const int32_t* p) {
+        return _mm512_cvtepi32_pd(_mm256_loadu_si256((const __m256i*)p));
+    }
+    void storeInt32(int32_t* p) const { _mm256_storeu_si256((__m256i*)p, _mm512_cvttpd_epi32(v)); }
+    static Mask testBits(const int32_t* p, int32_t bits) {
+        __m512i x = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)p));
+        return _mm512_test_epi64_mask(x, _mm512_set1_epi64(bits));
+    }
+
+    friend VecAvx512 operator+(VecAvx512 a, VecAvx512 b) { return _mm512_add_pd(a.v, b.v); }
+    friend VecAvx512 operator-(VecAvx512 a, VecAvx512 b) { return _mm512_sub_pd(a.v, b.v); }
+    friend VecAvx512 operator*(VecAvx512 a, VecAvx512 b) { return _mm512_mul_pd(a.v, b.v); }
+    friend VecAvx512 operator/(VecAvx512 a, VecAvx512 b) { return _mm512_div_pd(a.v, b.v); }
+    friend Mask operator<(VecAvx512 a, VecAvx512 b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ); }
+    friend Mask operator>(VecAvx512 a, VecAvx512 b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ); }
+    friend Mask operator<=(VecAvx512 a, VecAvx512 b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_LE_OQ); }
+    friend Mask operator>=(VecAvx512 a, VecAvx512 b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_GE_OQ); }
+    friend Mask operator==(VecAvx512 a, VecAvx512 b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_EQ_OQ); }
+    static VecAvx512 min(VecAvx512 a, VecAvx512 b) { return _mm512_min_pd(a.v, b.v); }
+    static VecAvx512 max(VecAvx512 a, VecAvx512 b) { return _mm512_max_pd(a.v, b.v); }
+    static VecAvx512 abs(VecAvx512 a) { return _mm512_abs_pd(a.v); }
+    static VecAvx512 select(Mask m, VecAvx512 a, VecAvx512 b) { return _mm512_mask_blend_pd(m, b.v, a.v); }
+    static Mask maskAnd(Mask a, Mask b) { return (Mask)(a & b); }
+    static Mask maskOr(Mask a, Mask b) { return (Mask)(a | b); }
+    static Mask maskNot(Mask a) { return (Mask)~a; }
+    static bool any(Mask m) { return m != 0; }
+    static void frexp12(VecAvx512 x, VecAvx512& m, VecAvx512& e) {
+        e.v = _mm512_getexp_pd(x.v);
+        m.v = _mm512_getmant_pd(x.v, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_src);
+    }
+};
+#endif
+
+// 当前编译目标可用的最宽向量
+#if defined(__AVX512F__)
+typedef VecAvx512 VecD;
+#elif defined(__AVX2__)
+typedef VecAvx2 VecD;
+#else
+typedef VecScalar VecD;
+#endif
+
+// 自然对数（fdlibm 算法，误差 <1ulp，仅处理正的正规数）
+template <class V>
+inline V vecLog(V x) {
+    V m, e;
+    V::frexp12(x, m, e);
+    // 把尾数调整到 [sqrt(2)/2, sqrt(2))
+    typename V::Mask big = m > V(1.4142135623730951);
+    m = V::select(big, m * V(0.5), m);
+    e = V::select(big, e + V(1.0), e);
+
+    V f = m - V(1.0);
+    V s = f / (V(2.0) + f);
+    V z = s * s;
+    V w = z * z;
+    V t1 = w * (V(3.999999999940941908e-01) + w * (V(2.222219843214978396e-01) + w * V(1.531383769920937332e-01)));
+    V t2 = z * (V(6.666666666666735130e-01) + w * (V(2.857142874366239149e-01)
+        + w * (V(1.818357216161805012e-01) + w * V(1.479819860511658591e-01))));
+    V R = t2 + t1;
+    V hfsq = V(0.5) * f * f;
+    return e * V(6.93147180369123816490e-01)
+        - ((hfsq - (s * (hfsq + R) + e * V(1.90821492927058770002e-10))) - f);
+}
+
+template <class V>
+inline V vecLog10(V x) {
+    return vecLog(x) * V(0.43429448190325182765);
+}
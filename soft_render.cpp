@@ -0,0 +1,410 @@
+﻿#include "soft_render.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// ---- 点阵字体 ----
+
+// 5x7 点阵：每个字形 5 列，每列低位为最上一行。ASCII 32~126，另加按钮用的 ▲ ▼
+enum { GLYPH_ASCII = 95, GLYPH_UP = GLYPH_ASCII, GLYPH_DOWN, GLYPH_COUNT };
+static const uint8_t FONT5X7[GLYPH_COUNT][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14}, //  !"#
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00}, // $%&'
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x08,0x2A,0x1C,0x2A,0x08}, {0x08,0x08,0x3E,0x08,0x08}, // ()*+
+    {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02}, // ,-./
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31}, // 0123
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03}, // 4567
+    {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00}, // 89:;
+    {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06}, // <=>?
+    {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22}, // @ABC
+    {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x49,0x49,0x7A}, // DEFG
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41}, // HIJK
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x0C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E}, // LMNO
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31}, // PQRS
+    {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F}, // TUVW
+    {0x63,0x14,0x08,0x14,0x63}, {0x07,0x08,0x70,0x08,0x07}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x7F,0x41,0x41,0x00}, // XYZ[
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x7F,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40}, // \]^_
+    {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20}, // `abc
+    {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x0C,0x52,0x52,0x52,0x3E}, // defg
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00}, // hijk
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38}, // lmno
+    {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20}, // pqrs
+    {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C}, // tuvw
+    {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00}, // xyz{
+    {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x08,0x04,0x08,0x10,0x08},                              // |}~
+    {0x40,0x70,0x7C,0x70,0x40}, {0x01,0x07,0x1F,0x07,0x01}                                                           // ▲▼
+};
+
+// 取下一个字符（UTF-8）的字形编号，没有的字符画成 '?'
+static int nextGlyph(const char*& s) {
+    unsigned char c = (unsigned char)*s++;
+    if (c >= 32 && c < 127) return c - 32;
+    // ▲ U+25B2 = E2 96 B2，▼ U+25BC = E2 96 BC
+    if (c == 0xE2 && (unsigned char)s[0] == 0x96 && ((unsigned char)s[1] == 0xB2 || (unsigned char)s[1] == 0xBC)) {
+        int g = (unsigned char)s[1] == 0xB2 ? GLYPH_UP : GLYPH_DOWN;
+        s += 2;
+        return g;
+    }
+    while ((*s & 0xC0) == 0x80) s++;
+    return '?' - 32;
+}
+
+// ---- 光栅化 ----
+
+// 0xRRGGBB 转为帧缓冲像素（小端下内存依次为 R、G、B、A）
+static uint32_t toPixel(PanelColor c) {
+    return 0xFF000000u | ((c & 0xFF) << 16) | (c & 0xFF00) | ((c >> 16) & 0xFF);
+}
+
+// 角度差规范到 (0, 2π]，起止相同为空
+static double sweepOf(double startAngle, double endAngle) {
+    const double TWO_PI = 6.283185307179586;
+    double sweep = endAngle - startAngle;
+    if (sweep == 0) return 0;
+    sweep -= TWO_PI * std::floor(sweep / TWO_PI);
+    return sweep == 0 ? TWO_PI : sweep;
+}
+
+SoftRenderer::SoftRenderer(int width, int height)
+    : m_width(width), m_height(height), m_pixels((size_t)width * height, toPixel(PANEL_BLACK)) {
+}
+
+void SoftRenderer::plot(int x, int y, uint32_t px) {
+    if (x >= 0 && x < m_width && y >= 0 && y < m_height) m_pixels[(size_t)y * m_width + x] = px;
+}
+
+// 一行 [x0, x1] 填同一颜色（调用者已裁剪）
+void SoftRenderer::span(int y, int x0, int x1, uint32_t px) {
+    uint32_t* row = &m_pixels[(size_t)y * m_width];
+    int x = x0;
+#if defined(__AVX2__)
+    __m256i v = _mm256_set1_epi32((int)px);
+    for (; x + 8 <= x1 + 1; x += 8) _mm256_storeu_si256((__m256i*)(row + x), v);
+#endif
+    for (; x <= x1; x++) row[x] = px;
+}
+
+void SoftRenderer::line(int x0, int y0, int x1, int y1, PanelColor c) {
+    uint32_t px = toPixel(c);
+    int dx = std::abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -std::abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    for (;;) {
+        plot(x0, y0, px);
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void SoftRenderer::arc(int cx, int cy, int r, double startAngle, double endAngle, PanelColor c) {
+    uint32_t px = toPixel(c);
+    double sweep = sweepOf(startAngle, endAngle);
+    // 步长约半个像素，相邻点不留空隙
+    int steps = std::max(8, (int)(sweep * r * 2));
+    for (int k = 0; k <= steps; k++) {
+        double a = startAngle + sweep * k / steps;
+        plot(cx + (int)std::lround(r * std::cos(a)), cy - (int)std::lround(r * std::sin(a)), px);
+    }
+}
+
+// 逐行取圆内的一段，再按角度判断每个像素是否在扇形内：
+// d0、d1 为起止方向，p 在 d0 逆时针方向且 d1 在 p 逆时针方向（叉积均非负）即在扇形内；
+// 扫过超过 180° 时取补集（补扇形不到 180°）
+void SoftRenderer::fillPie(int cx, int cy, int r, double startAngle, double endAngle, PanelColor c) {
+    uint32_t px = toPixel(c);
+    double sweep = sweepOf(startAngle, endAngle);
+    if (sweep == 0) return;
+    bool wide = sweep > 3.141592653589793;
+    float d0x = (float)std::cos(startAngle), d0y = (float)std::sin(startAngle);
+    float d1x = (float)std::cos(startAngle + sweep), d1y = (float)std::sin(startAngle + sweep);
+
+    for (int y = std::max(cy - r, 0); y <= std::min(cy + r, m_height - 1); y++) {
+        int dy = y - cy;
+        double h2 = (r + 0.5) * (r + 0.5) - (double)dy * dy;
+        if (h2 < 0) continue;
+        int half = (int)std::sqrt(h2);
+        int x0 = std::max(cx - half, 0), x1 = std::min(cx + half, m_width - 1);
+        float my = (float)-dy; // 数学坐标，y 向上
+        uint32_t* row = &m_pixels[(size_t)y * m_width];
+        int x = x0;
+#if defined(__AVX2__)
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256 vmy = _mm256_set1_ps(my);
+        const __m256 vd0x = _mm256_set1_ps(d0x), vd0y = _mm256_set1_ps(d0y);
+        const __m256 vd1x = _mm256_set1_ps(d1x), vd1y = _mm256_set1_ps(d1y);
+        const __m256i vpx = _mm256_set1_epi32((int)px);
+        for (; x + 8 <= x1 + 1; x += 8) {
+            __m256 mx = _mm256_add_ps(_mm256_set1_ps((float)(x - cx)), lane);
+            __m256 c0 = _mm256_sub_ps(_mm256_mul_ps(vd0x, vmy), _mm256_mul_ps(vd0y, mx));
+            __m256 c1 = _mm256_sub_ps(_mm256_mul_ps(mx, vd1y), _mm256_mul_ps(vmy, vd1x));
+            __m256 in0 = _mm256_cmp_ps(c0, zero, _CMP_GE_OQ), in1 = _mm256_cmp_ps(c1, zero, _CMP_GE_OQ);
+            __m256 in = wide ? _mm256_or_ps(in0, in1) : _mm256_and_ps(in0, in1);
+            __m256i old = _mm256_loadu_si256((const __m256i*)(row + x));
+            _mm256_storeu_si256((__m256i*)(row + x), _mm256_blendv_epi8(old, vpx, _mm256_castps_si256(in)));
+        }
+#endif
+        for (; x <= x1; x++) {
+            float mx = (float)(x - cx);
+            float c0 = d0x * my - d0y * mx, c1 = mx * d1y - my * d1x;
+            bool in = wide ? (c0 >= 0 || c1 >= 0) : (c0 >= 0 && c1 >= 0);
+            if (in) row[x] = px;
+        }
+    }
+}
+
+void SoftRenderer::fillRect(int left, int top, int right, int bottom, PanelColor c) {
+    uint32_t px = toPixel(c);
+    int x0 = std::max(left, 0), x1 = std::min(right, m_width - 1);
+    if (x0 > x1) return;
+    for (int y = std::max(top, 0); y <= std::min(bottom, m_height - 1); y++) span(y, x0, x1, px);
+}
+
+void SoftRenderer::fillRoundRect(int left, int top, int right, int bottom, int corner, PanelColor c) {
+    uint32_t px = toPixel(c);
+    double rr = corner * 0.5;
+    for (int y = std::max(top, 0); y <= std::min(bottom, m_height - 1); y++) {
+        // 圆角所在的行按圆弧内缩
+        double dy = 0;
+        if (y < top + rr) dy = top + rr - (y + 0.5);
+        else if (y > bottom - rr) dy = (y + 0.5) - (bottom + 1 - rr);
+        int inset = dy > 0 ? (int)(rr - std::sqrt(std::max(0.0, rr * rr - dy * dy)) + 0.5) : 0;
+        int x0 = std::max(left + inset, 0), x1 = std::min(right - inset, m_width - 1);
+        if (x0 <= x1) span(y, x0, x1, px);
+    }
+}
+
+// 按面积采样把 5x7 点阵缩放到字高 height：纵向字高 10 个点、行高 8 点；
+// 横向字距取 0.48 倍字高（与 Consolas 相近），字距 6 点
+const GlyphAtlas& SoftRenderer::atlas(int height) {
+    for (const GlyphAtlas& a : m_atlases) {
+        if (a.height == height) return a;
+    }
+    GlyphAtlas a;
+    a.height = height;
+    a.cellW = std::max(1, (int)(0.48 * height + 0.5));
+    double sx = a.cellW / 6.0, sy = height / 10.0; // 每点的像素数
+    a.cellH = std::max(1, (int)(8 * sy + 0.5));
+    a.top = (int)(1.5 * sy + 0.5);
+    a.alpha.assign((size_t)GLYPH_COUNT * a.cellW * a.cellH, 0);
+    for (int g = 0; g < GLYPH_COUNT; g++) {
+        uint8_t* out = &a.alpha[(size_t)g * a.cellW * a.cellH];
+        for (int py = 0; py < a.cellH; py++) {
+            for (int px = 0; px < a.cellW; px++) {
+                // 像素 [px, px+1) x [py, py+1) 在点阵中的范围与各亮点的重叠面积
+                double x0 = px / sx, x1 = (px + 1) / sx, y0 = py / sy, y1 = (py + 1) / sy;
+                double cover = 0;
+                for (int fx = (int)x0; fx < 5 && fx < x1; fx++) {
+                    for (int fy = (int)y0; fy < 7 && fy < y1; fy++) {
+                        if (!((FONT5X7[g][fx] >> fy) & 1)) continue;
+                        cover += (std::min(x1, fx + 1.0) - std::max(x0, (double)fx)) *
+                            (std::min(y1, fy + 1.0) - std::max(y0, (double)fy));
+                    }
+                }
+                out[py * a.cellW + px] = (uint8_t)std::min(255.0, cover * sx * sy * 255 + 0.5);
+            }
+        }
+    }
+    m_atlases.push_back(std::move(a));
+    return m_atlases.back();
+}
+
+void SoftRenderer::text(int x, int y, int height, PanelColor c, const char* s) {
+    const GlyphAtlas& a = atlas(height);
+    unsigned cr = (c >> 16) & 0xFF, cg = (c >> 8) & 0xFF, cb = c & 0xFF;
+    while (*s) {
+        const uint8_t* glyph = &a.alpha[(size_t)nextGlyph(s) * a.cellW * a.cellH];
+        for (int gy = 0; gy < a.cellH; gy++) {
+            int py = y + a.top + gy;
+            if (py < 0 || py >= m_height) continue;
+            uint32_t* row = &m_pixels[(size_t)py * m_width];
+            for (int gx = 0; gx < a.cellW; gx++) {
+                unsigned k = glyph[gy * a.cellW + gx];
+                int px = x + gx;
+                if (!k || px < 0 || px >= m_width) continue;
+                uint32_t d = row[px];
+                unsigned r = ((d & 0xFF) * (255 - k) + cr * k + 127) / 255;
+                unsigned g = (((d >> 8) & 0xFF) * (255 - k) + cg * k + 127) / 255;
+                unsigned b = (((d >> 16) & 0xFF) * (255 - k) + cb * k + 127) / 255;
+                row[px] = 0xFF000000u | (b << 16) | (g << 8) | r;
+            }
+        }
+        x += a.cellW;
+    }
+}
+
+const char* softRasterKernelName() {
+#if defined(__AVX2__)
+    return "AVX2";
+#else
+    return "scalar";
+#endif
+}
+
+// ---- 输出 ----
+
+struct Crc32Table {
+    uint32_t v[256];
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            v[i] = c;
+        }
+    }
+};
+
+static uint32_t crc32(const uint8_t* p, size_t n) {
+    static const Crc32Table table; // 局部静态量的初始化是线程安全的
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; i++) crc = table.v[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static uint32_t adler32(const std::vector<uint8_t>& data) {
+    uint32_t a = 1, b = 0;
+    // 每 5552 字节取一次模，b 不会溢出
+    for (size_t i = 0; i < data.size();) {
+        size_t end = std::min(data.size(), i + 5552);
+        for (; i < end; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+static void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back((uint8_t)(v >> 24));
+    out.push_back((uint8_t)(v >> 16));
+    out.push_back((uint8_t)(v >> 8));
+    out.push_back((uint8_t)v);
+}
+
+// deflate 位流：数据低位先出，Huffman 码高位先出
+struct DeflateBits {
+    std::vector<uint8_t>& out;
+    uint32_t acc;
+    int bits;
+
+    void put(uint32_t v, int n) {
+        acc |= v << bits;
+        bits += n;
+        for (; bits >= 8; bits -= 8, acc >>= 8) out.push_back((uint8_t)acc);
+    }
+    void flush() {
+        if (bits > 0) out.push_back((uint8_t)acc);
+        acc = 0;
+        bits = 0;
+    }
+};
+
+// 定长 Huffman 码表（RFC 1951 3.2.6），码字预先按位倒序以便低位先出
+struct FixedHuffman {
+    uint16_t code[288];
+    uint8_t bits[288];
+    FixedHuffman() {
+        for (int sym = 0; sym < 288; sym++) {
+            uint32_t c;
+            int n;
+            if (sym < 144) c = 0x30 + sym, n = 8;
+            else if (sym < 256) c = 0x190 + sym - 144, n = 9;
+            else if (sym < 280) c = sym - 256, n = 7;
+            else c = 0xC0 + sym - 280, n = 8;
+            uint32_t rev = 0;
+            for (int i = 0; i < n; i++) rev |= ((c >> i) & 1) << (n - 1 - i);
+            code[sym] = (uint16_t)rev;
+            bits[sym] = (uint8_t)n;
+        }
+    }
+};
+
+static void putSymbol(DeflateBits& w, int sym) {
+    static const FixedHuffman table;
+    w.put(table.code[sym], table.bits[sym]);
+}
+
+static const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83,
+    99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+// 只用距离 1 的匹配（即游程）：滤波后的整段同色区域几乎全是 0，已足够压缩面板图片
+static void deflateRuns(const std::vector<uint8_t>& in, std::vector<uint8_t>& out) {
+    DeflateBits w{ out, 0, 0 };
+    w.put(1, 1); // 最后一块
+    w.put(1, 2); // 定长 Huffman
+    size_t n = in.size();
+    for (size_t i = 0; i < n;) {
+        size_t run = 0;
+        if (i > 0) {
+            while (i + run < n && run < 258 && in[i + run] == in[i - 1]) run++;
+        }
+        if (run >= 3) {
+            int k = 28;
+            while (LENGTH_BASE[k] > run) k--;
+            putSymbol(w, 257 + k);
+            w.put((uint32_t)(run - LENGTH_BASE[k]), LENGTH_EXTRA[k]);
+            w.put(0, 5); // 距离码 0（5 位全 0）：距离 1
+            i += run;
+        }
+        else {
+            putSymbol(w, in[i++]);
+        }
+    }
+    putSymbol(w, 256);
+    w.flush();
+}
+
+static bool writeChunk(FILE* fp, const char* type, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> buf;
+    putBE32(buf, (uint32_t)data.size());
+    buf.insert(buf.end(), type, type + 4);
+    buf.insert(buf.end(), data.begin(), data.end());
+    putBE32(buf, crc32(buf.data() + 4, buf.size() - 4));
+    return fwrite(buf.data(), 1, buf.size(), fp) == buf.size();
+}
+
+bool writePng(const char* path, const SoftRenderer& r) {
+    int w = r.width(), h = r.height();
+    size_t stride = (size_t)w * 4;
+    std::vector<uint8_t> raw((stride + 1) * h);
+    const uint8_t* src = (const uint8_t*)r.pixels();
+    for (int y = 0; y < h; y++) {
+        uint8_t* row = &raw[(stride + 1) * y];
+        const uint8_t* s = src + stride * y;
+        row[0] = 1; // Sub 滤波：减去左边像素
+        for (size_t i = 0; i < stride; i++) row[1 + i] = (uint8_t)(s[i] - (i >= 4 ? s[i - 4] : 0));
+    }
+
+    std::vector<uint8_t> ihdr, idat = { 0x78, 0x01 }; // zlib 头
+    putBE32(ihdr, (uint32_t)w);
+    putBE32(ihdr, (uint32_t)h);
+    ihdr.insert(ihdr.end(), { 8, 6, 0, 0, 0 }); // 8 位 RGBA
+    deflateRuns(raw, idat);
+    putBE32(idat, adler32(raw));
+
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return false;
+    static const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    bool ok = fwrite(SIGNATURE, 1, 8, fp) == 8 && writeChunk(fp, "IHDR", ihdr) && writeChunk(fp, "IDAT", idat) &&
+        writeChunk(fp, "IEND", std::vector<uint8_t>());
+    return fclose(fp) == 0 && ok;
+}
+
+bool writeRawFrame(FILE* fp, const SoftRenderer& r) {
+    size_t n = (size_t)r.width() * r.height();
+    return fwrite(r.pixels(), 4, n, fp) == n;
+}
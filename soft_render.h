@@ -0,0 +1,54 @@
+﻿#pragma once
+// 软件光栅器：PanelRenderer 的无图形库实现，画进内存中的 RGBA 帧缓冲，再写成 PNG 或原始帧序列。
+// 每个 SoftRenderer 拥有自己的帧缓冲与字形图集，不共享可变状态，多个实例可在不同线程并行绘制。
+//
+// 填充按行扫描：整段同色用 AVX2 一次写 8 个像素，扇形逐 8 像素算出角度掩码后混合写入
+// （编译时按 __AVX2__ 选择，否则为标量）。文字用内置 5x7 点阵字体，首次用到某字高时
+// 按面积采样缩放成抗锯齿的覆盖率图集，之后逐字形混合。
+#include "panel.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// 一个字高的字形图集
+struct GlyphAtlas {
+    int height;                 // 字高
+    int cellW, cellH;           // 每个字形的宽高（即字距与行高）
+    int top;                    // 字形相对文字顶部的下移
+    std::vector<uint8_t> alpha; // 各字形依次排列，每个 cellW * cellH 个覆盖率
+};
+
+class SoftRenderer : public PanelRenderer {
+public:
+    explicit SoftRenderer(int width = PANEL_WIDTH, int height = PANEL_HEIGHT);
+
+    void line(int x0, int y0, int x1, int y1, PanelColor c) override;
+    void arc(int cx, int cy, int r, double startAngle, double endAngle, PanelColor c) override;
+    void fillPie(int cx, int cy, int r, double startAngle, double endAngle, PanelColor c) override;
+    void fillRect(int left, int top, int right, int bottom, PanelColor c) override;
+    void fillRoundRect(int left, int top, int right, int bottom, int corner, PanelColor c) override;
+    void text(int x, int y, int height, PanelColor c, const char* s) override;
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    // 逐行的像素，内存中按 R、G、B、A 字节排列
+    const uint32_t* pixels() const { return m_pixels.data(); }
+
+private:
+    const GlyphAtlas& atlas(int height);
+    void plot(int x, int y, uint32_t px);
+    void span(int y, int x0, int x1, uint32_t px);
+
+    int m_width, m_height;
+    std::vector<uint32_t> m_pixels;
+    std::vector<GlyphAtlas> m_atlases;
+};
+
+// 编译选用的填充内核（"AVX2" 或 "scalar"）
+const char* softRasterKernelName();
+
+// 写 PNG（8 位 RGBA；按行 Sub 滤波，deflate 用定长 Huffman 编码与游程匹配）
+bool writePng(const char* path, const SoftRenderer& r);
+// 追加一帧原始 RGBA，多帧连续写入同一文件即为视频序列：
+// ffmpeg -f rawvideo -pix_fmt rgba -s 600x650 -r <帧率> -i run.rgba run.mp4
+bool writeRawFrame(FILE* fp, const SoftRenderer& r);
@@ -0,0 +1,58 @@
+﻿#pragma once
+// 单生产者/单消费者无锁环形缓冲区
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+template <class T>
+class SpscRing {
+public:
+    // 容量向上取整为 2 的幂
+    explicit SpscRing(size_t capacity = 1024) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        m_buf.resize(n);
+        m_mask = n - 1;
+    }
+
+    size_t capacity() const { return m_buf.size(); }
+
+    // 生产者调用；满时返回 false
+    bool push(const T& v) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail > m_mask) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail > m_mask) return false;
+        }
+        m_buf[head & m_mask] = v;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用；一次取出至多 max 条
+    size_t popBatch(T* out, size_t max) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (m_cachedHead == tail) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (m_cachedHead == tail) return 0;
+        }
+        size_t n = m_cachedHead - tail;
+        if (n > max) n = max;
+        for (size_t i = 0; i < n; i++) out[i] = m_buf[(tail + i) & m_mask];
+        m_tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    bool empty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> m_buf;
+    size_t m_mask;
+    // 生产者、消费者各自的字段分处不同缓存行，避免伪共享
+    alignas(64) std::atomic<size_t> m_head{0};
+    size_t m_cachedTail = 0;
+    alignas(64) std::atomic<size_t> m_tail{0};
+    size_t m_cachedHead = 0;
+};
@@ -0,0 +1,75 @@
+﻿#include "telemetry.h"
+#include "trace.h"
+#include <cstdio>
+
+void telemetryColumnName(char* buf, size_t size, const char* signal, int engine, int engineCount) {
+    if (engineCount == 1) snprintf(buf, size, "%s", signal);
+    else if (engineCount == 2) snprintf(buf, size, "%s_%s", signal, engine == SIM_LEFT ? "left" : "right");
+    else snprintf(buf, size, "%s_%d", signal, engine + 1);
+}
+
+std::string csvHeader(int engineCount) {
+    static const char* const signals[] = { "N1", "T", "FF" };
+    std::string h = "Time(ms)";
+    char name[32];
+    for (const char* signal : signals) {
+        for (int i = 0; i < engineCount; i++) {
+            telemetryColumnName(name, sizeof(name), signal, i, engineCount);
+            h += ",";
+            h += name;
+        }
+    }
+    return h + ",Fuel\n";
+}
+
+int formatCsvRow(char* buf, size_t size, const TelemetrySample& s) {
+    if (s.engineCount == 2) {
+        return snprintf(buf, size, "%lld,%g,%g,%g,%g,%g,%g,%g\n", (long long)s.timeMs,
+            s.N1[SIM_LEFT], s.N1[SIM_RIGHT], s.T[SIM_LEFT], s.T[SIM_RIGHT],
+            s.FF[SIM_LEFT], s.FF[SIM_RIGHT], s.fuel);
+    }
+    // 其他台数逐列追加
+    int len = snprintf(buf, size, "%lld", (long long)s.timeMs);
+    const double* columns[] = { s.N1, s.T, s.FF };
+    for (const double* c : columns) {
+        for (int i = 0; i < s.engineCount; i++) {
+            len += snprintf(buf + len, len < (int)size ? size - len : 0, ",%g", c[i]);
+        }
+    }
+    len += snprintf(buf + len, len < (int)size ? size - len : 0, ",%g\n", s.fuel);
+    return len;
+}
+
+int formatLogLine(char* buf, size_t size, int64_t timeMs, FaultType ft) {
+    return snprintf(buf, size, "%lldms: %s\n", (long long)timeMs, faultTypeToString(ft));
+}
+
+bool CsvTelemetrySink::open(const char* dataPath, const char* logPath, int engineCount) {
+    m_dataFile.open(dataPath, std::ios::out);
+    m_dataFile << csvHeader(engineCount);
+    m_logFile.open(logPath, std::ios::out);
+    return m_dataFile.is_open() && m_logFile.is_open();
+}
+
+void CsvTelemetrySink::close() {
+    m_dataFile.close();
+    m_logFile.close();
+}
+
+// 写入数据文件
+void CsvTelemetrySink::onSample(const TelemetrySample& s) {
+    TRACE_ZONE("csv write");
+    m_dataFile << s.timeMs;
+    for (const double* c : { s.N1, s.T, s.FF }) {
+        for (int i = 0; i < s.engineCount; i++) m_dataFile << "," << c[i];
+    }
+    m_dataFile << "," << s.fuel << "\n";
+    m_dataFile.flush();
+}
+
+// 写入log
+void CsvTelemetrySink::onFault(int64_t timeMs, FaultType ft) {
+    TRACE_ZONE("log write");
+    m_logFile << timeMs << "ms: " << faultTypeToString(ft) << std::endl;
+    m_logFile.flush();
+}
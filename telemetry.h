@@ -0,0 +1,27 @@
+﻿#pragma once
+// 遥测文件输出：data.csv 与 log.txt
+#include "sim_core.h"
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+// 列名：双发为 N1_left/N1_right，单发为 N1，其余为 N1_1..N1_n
+void telemetryColumnName(char* buf, size_t size, const char* signal, int engine, int engineCount);
+// data.csv 表头：时间、各发动机 N1、T、FF、燃油合计
+std::string csvHeader(int engineCount);
+// 按 std::ostream 默认格式（%g，6位有效数字）格式化一行数据 / 一条日志，返回长度
+int formatCsvRow(char* buf, size_t size, const TelemetrySample& s);
+int formatLogLine(char* buf, size_t size, int64_t timeMs, FaultType ft);
+
+// 与原界面版相同格式的 CSV/日志输出
+class CsvTelemetrySink : public TelemetrySink {
+public:
+    bool open(const char* dataPath, const char* logPath, int engineCount = SIM_DEFAULT_ENGINES);
+    void close();
+    void onSample(const TelemetrySample& s) override;
+    void onFault(int64_t timeMs, FaultType ft) override;
+
+private:
+    std::ofstream m_dataFile;
+    std::ofstream m_logFile;
+};
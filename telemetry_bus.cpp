@@ -0,0 +1,289 @@
+﻿#include "telemetry_bus.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+SharedMemory::SharedMemory() : m_data(NULL), m_size(0), m_owner(false), m_mapping(NULL) {
+    m_name[0] = 0;
+}
+#else
+SharedMemory::SharedMemory() : m_data(NULL), m_size(0), m_owner(false) {
+    m_name[0] = 0;
+}
+#endif
+
+SharedMemory::~SharedMemory() {
+    close();
+}
+
+#ifdef _WIN32
+// "engine" 或 "/engine" -> "Local\engine"（当前登录会话内可见）
+static void shmName(char* buf, size_t size, const char* name) {
+    snprintf(buf, size, "Local\\%s", name[0] == '/' ? name + 1 : name);
+}
+
+bool SharedMemory::create(const char* name, size_t size) {
+    close();
+    shmName(m_name, sizeof(m_name), name);
+    HANDLE m = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+        (DWORD)((uint64_t)size >> 32), (DWORD)size, m_name);
+    if (!m) return false;
+    void* p = MapViewOfFile(m, FILE_MAP_WRITE, 0, 0, size);
+    if (!p) {
+        CloseHandle(m);
+        return false;
+    }
+    // 同名映射已存在时拿到的是旧段，清零后重建
+    memset(p, 0, size);
+    m_mapping = m;
+    m_data = (uint8_t*)p;
+    m_size = size;
+    m_owner = true;
+    return true;
+}
+
+bool SharedMemory::open(const char* name) {
+    close();
+    shmName(m_name, sizeof(m_name), name);
+    HANDLE m = OpenFileMappingA(FILE_MAP_READ, FALSE, m_name);
+    if (!m) return false;
+    void* p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (!p || !VirtualQuery(p, &info, sizeof(info))) {
+        if (p) UnmapViewOfFile(p);
+        CloseHandle(m);
+        return false;
+    }
+    m_mapping = m;
+    m_data = (uint8_t*)p;
+    m_size = info.RegionSize;
+    return true;
+}
+
+void SharedMemory::close() {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    m_data = NULL;
+    m_size = 0;
+    m_mapping = NULL;
+    m_owner = false;
+}
+#else
+// POSIX 共享内存名以 '/' 开头
+static void shmName(char* buf, size_t size, const char* name) {
+    snprintf(buf, size, "%s%s", name[0] == '/' ? "" : "/", name);
+}
+
+bool SharedMemory::create(const char* name, size_t size) {
+    close();
+    shmName(m_name, sizeof(m_name), name);
+    // 先删除旧名称：仍映射着旧段的读者不受影响，新打开的读者看到新段
+    shm_unlink(m_name);
+    int fd = shm_open(m_name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) return false;
+    void* p = MAP_FAILED;
+    if (ftruncate(fd, (off_t)size) == 0) p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(m_name);
+        return false;
+    }
+    m_data = (uint8_t*)p;
+    m_size = size;
+    m_owner = true;
+    return true;
+}
+
+bool SharedMemory::open(const char* name) {
+    close();
+    shmName(m_name, sizeof(m_name), name);
+    int fd = shm_open(m_name, O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    m_data = (uint8_t*)p;
+    m_size = (size_t)st.st_size;
+    return true;
+}
+
+void SharedMemory::close() {
+    if (m_data) munmap(m_data, m_size);
+    if (m_owner) shm_unlink(m_name);
+    m_data = NULL;
+    m_size = 0;
+    m_owner = false;
+}
+#endif
+
+static uint32_t currentPid() {
+#ifdef _WIN32
+    return (uint32_t)GetCurrentProcessId();
+#else
+    return (uint32_t)getpid();
+#endif
+}
+
+bool TelemetryBusSink::open(const char* name, int engineCount, uint32_t capacity) {
+    close();
+    uint32_t n = 2;
+    while (n < capacity) n <<= 1;
+    if (!m_shm.create(name, sizeof(TelemetryBusHeader) + (size_t)n * sizeof(TelemetryBusSlot))) return false;
+
+    // 新段内容全为 0：head 与各槽位序号为 0，即没有记录
+    m_header = (TelemetryBusHeader*)m_shm.data();
+    m_slots = (TelemetryBusSlot*)(m_shm.data() + sizeof(TelemetryBusHeader));
+    m_header->version = TBUS_VERSION;
+    m_header->headerSize = sizeof(TelemetryBusHeader);
+    m_header->slotSize = sizeof(TelemetryBusSlot);
+    m_header->capacity = n;
+    m_header->engineCount = engineCount;
+    m_header->writerPid = currentPid();
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->magic = TBUS_MAGIC;
+    m_mask = n - 1;
+    m_next = 0;
+    return true;
+}
+
+void TelemetryBusSink::close() {
+    if (!m_header) return;
+    m_header->closed.store(1, std::memory_order_release);
+    m_shm.close();
+    m_header = nullptr;
+    m_slots = nullptr;
+}
+
+void TelemetryBusSink::publish(const TelemetryBusRecord& r) {
+    if (!m_header) return;
+    uint64_t n = m_next++;
+    TelemetryBusSlot& slot = m_slots[n & m_mask];
+    slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    uint64_t w[TBUS_RECORD_WORDS] = {};
+    memcpy(w, &r, sizeof(r));
+    for (int i = 0; i < TBUS_RECORD_WORDS; i++) slot.words[i].store(w[i], std::memory_order_relaxed);
+    slot.seq.store(2 * n + 2, std::memory_order_release);
+    m_header->head.store(n + 1, std::memory_order_release);
+}
+
+void TelemetryBusSink::onSample(const TelemetrySample& s) {
+    TelemetryBusRecord r;
+    r.kind = TBUS_SAMPLE;
+    r.fault = NO_FAULT;
+    r.sample = s;
+    publish(r);
+}
+
+void TelemetryBusSink::onFault(int64_t timeMs, FaultType ft) {
+    TelemetryBusRecord r;
+    memset(&r, 0, sizeof(r));
+    r.kind = TBUS_FAULT;
+    r.fault = ft;
+    r.sample.timeMs = timeMs;
+    publish(r);
+}
+
+bool TelemetryBusReader::open(const char* name, bool fromOldest) {
+    close();
+    if (!m_shm.open(name) || m_shm.size() < sizeof(TelemetryBusHeader)) return false;
+    const TelemetryBusHeader* h = (const TelemetryBusHeader*)m_shm.data();
+    bool ok = h->magic == TBUS_MAGIC && h->version == TBUS_VERSION
+        && h->headerSize == sizeof(TelemetryBusHeader) && h->slotSize == sizeof(TelemetryBusSlot)
+        && h->capacity >= 2 && (h->capacity & (h->capacity - 1)) == 0
+        && m_shm.size() >= sizeof(TelemetryBusHeader) + (size_t)h->capacity * sizeof(TelemetryBusSlot);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!ok) {
+        m_shm.close();
+        return false;
+    }
+    m_header = h;
+    m_slots = (const TelemetryBusSlot*)(m_shm.data() + sizeof(TelemetryBusHeader));
+    m_mask = h->capacity - 1;
+    m_lost = 0;
+    uint64_t head = h->head.load(std::memory_order_acquire);
+    m_next = head;
+    if (fromOldest) {
+        m_next = 0;
+        skipToOldest(head);
+        m_lost = 0;
+    }
+    return true;
+}
+
+void TelemetryBusReader::close() {
+    m_shm.close();
+    m_header = nullptr;
+    m_slots = nullptr;
+}
+
+// 第 head - capacity 条所在的槽位可能正被第 head 条覆盖，最早的完好记录是其下一条
+void TelemetryBusReader::skipToOldest(uint64_t head) {
+    uint64_t oldest = head > m_mask ? head - m_mask : 0;
+    if (oldest <= m_next) return;
+    m_lost += oldest - m_next;
+    m_next = oldest;
+}
+
+TelemetryBusResult TelemetryBusReader::next(TelemetryBusRecord& out) {
+    uint64_t head = m_header->head.load(std::memory_order_acquire);
+    if (m_next >= head) return TBUS_EMPTY;
+    if (head - m_next > m_mask) {
+        skipToOldest(head);
+        return TBUS_OVERRUN;
+    }
+    const TelemetryBusSlot& slot = m_slots[m_next & m_mask];
+    uint64_t done = 2 * m_next + 2;
+    uint64_t w[TBUS_RECORD_WORDS];
+    bool intact = slot.seq.load(std::memory_order_acquire) == done;
+    if (intact) {
+        for (int i = 0; i < TBUS_RECORD_WORDS; i++) w[i] = slot.words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        intact = slot.seq.load(std::memory_order_relaxed) == done;
+    }
+    if (!intact) {
+        // 复制期间被写者追上覆盖
+        uint64_t before = m_lost;
+        skipToOldest(m_header->head.load(std::memory_order_acquire));
+        if (m_lost == before) {
+            m_lost++;
+            m_next++;
+        }
+        return TBUS_OVERRUN;
+    }
+    memcpy(&out, w, sizeof(out));
+    m_next++;
+    return TBUS_RECORD;
+}
+
+bool TelemetryBusReader::writerAlive() const {
+    uint32_t pid = m_header->writerPid;
+#ifdef _WIN32
+    HANDLE h = OpenProcess(SYNCHRONIZE, FALSE, pid);
+    if (!h) return GetLastError() == ERROR_ACCESS_DENIED;
+    bool alive = WaitForSingleObject(h, 0) == WAIT_TIMEOUT;
+    CloseHandle(h);
+    return alive;
+#else
+    // EPERM：进程存在，只是属于其他用户
+    return kill((pid_t)pid, 0) == 0 || errno == EPERM;
+#endif
+}
+
+bool TelemetryBusReader::finished() const {
+    if (m_next < m_header->head.load(std::memory_order_acquire)) return false;
+    // 已读完时才检查写者进程，读数据时不做系统调用
+    return m_header->closed.load(std::memory_order_acquire) || !writerAlive();
+}
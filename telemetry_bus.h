@@ -0,0 +1,139 @@
+﻿#pragma once
+// 共享内存遥测总线：仿真每步把数据记录与告警写入命名共享内存中的环形缓冲区，
+// 本机任意多个读者进程（仪表盘、记录器、分析工具）直接从映射内存读取，不解析文本，
+// 也不影响仿真的时序：写者从不等待读者，读者落后超过一圈时自行发现并跳过丢失的记录。
+// POSIX 为 shm_open（名称如 "/engine"），Windows 为命名文件映射（"Local\engine"）。
+//
+// 内存布局（版本 1，小端，偏移为字节）：
+//   0    TelemetryBusHeader（128 字节）
+//   128  capacity 个 TelemetryBusSlot（每个 slotSize 字节）
+// 第 n 条记录（从 0 数起）写在槽位 n % capacity，槽位序号写入中为 2n + 1，写完为 2n + 2，
+// 随后 head 置为 n + 1。读者复制前后序号都是 2n + 2 才算读到第 n 条；序号更大说明已被覆盖。
+#include "sim_core.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum : uint32_t {
+    TBUS_MAGIC = 0x53554254, // "TBUS"
+    TBUS_VERSION = 1
+};
+
+// 记录类型
+enum : uint32_t {
+    TBUS_SAMPLE = 1, // 一步的数据
+    TBUS_FAULT = 2   // 一条新告警，只有 sample.timeMs 有效
+};
+
+struct TelemetryBusRecord {
+    uint32_t kind;
+    int32_t fault; // FaultType
+    TelemetrySample sample;
+};
+
+struct TelemetryBusHeader {
+    uint32_t magic;               // 最后写入，读者见到 magic 即可使用其余字段
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t slotSize;
+    uint32_t capacity;            // 槽位数，2 的幂
+    int32_t engineCount;
+    uint32_t writerPid;           // 写者进程；读者据此发现写者未关闭就退出的情况
+    std::atomic<uint32_t> closed; // 写者已关闭
+    uint32_t reserved[9];
+    alignas(64) std::atomic<uint64_t> head; // 已发布的记录数
+};
+
+enum { TBUS_RECORD_WORDS = (sizeof(TelemetryBusRecord) + 7) / 8 };
+
+struct TelemetryBusSlot {
+    std::atomic<uint64_t> seq;
+    std::atomic<uint64_t> words[TBUS_RECORD_WORDS]; // TelemetryBusRecord 按 8 字节原子字存放
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "bus needs address-free 64-bit atomics");
+static_assert(sizeof(TelemetrySample) == 128 && sizeof(TelemetryBusRecord) == 136, "bus layout changed, bump TBUS_VERSION");
+static_assert(sizeof(TelemetryBusHeader) == 128 && offsetof(TelemetryBusHeader, head) == 64, "bus layout changed, bump TBUS_VERSION");
+static_assert(sizeof(TelemetryBusSlot) == 144, "bus layout changed, bump TBUS_VERSION");
+
+// 共享内存段（创建或打开）
+class SharedMemory {
+public:
+    SharedMemory();
+    ~SharedMemory();
+    // 创建（已存在则重建）size 字节的可读写段
+    bool create(const char* name, size_t size);
+    // 打开已有的段，只读
+    bool open(const char* name);
+    // 解除映射；创建者同时删除名称
+    void close();
+    uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    SharedMemory(const SharedMemory&);
+    SharedMemory& operator=(const SharedMemory&);
+
+    uint8_t* m_data;
+    size_t m_size;
+    char m_name[128];
+    bool m_owner;
+#ifdef _WIN32
+    void* m_mapping;
+#endif
+};
+
+// 写者：作为 EngineSim 的输出接口，每条记录只做十几次 8 字节写入
+class TelemetryBusSink : public TelemetrySink {
+public:
+    // capacity 向上取整为 2 的幂
+    bool open(const char* name, int engineCount = SIM_DEFAULT_ENGINES, uint32_t capacity = 4096);
+    void close();
+    void onSample(const TelemetrySample& s) override;
+    void onFault(int64_t timeMs, FaultType ft) override;
+
+private:
+    void publish(const TelemetryBusRecord& r);
+
+    SharedMemory m_shm;
+    TelemetryBusHeader* m_header = nullptr;
+    TelemetryBusSlot* m_slots = nullptr;
+    uint64_t m_mask = 0;
+    uint64_t m_next = 0;
+};
+
+enum TelemetryBusResult {
+    TBUS_RECORD,  // 读到一条
+    TBUS_EMPTY,   // 暂无新记录
+    TBUS_OVERRUN  // 落后超过一圈，已跳到最早的未覆盖记录；丢失条数见 lost()
+};
+
+// 读者：只读映射，不写共享内存，多个读者互不影响
+class TelemetryBusReader {
+public:
+    // 打开总线并检查版本与布局；fromOldest 为真时从仍在缓冲区中的最早记录读起，否则只读新记录
+    bool open(const char* name, bool fromOldest = false);
+    void close();
+    TelemetryBusResult next(TelemetryBusRecord& out);
+
+    int engineCount() const { return m_header->engineCount; }
+    uint32_t capacity() const { return m_header->capacity; }
+    // 写者已关闭（或进程已退出而未关闭）且没有未读记录
+    bool finished() const;
+    // 写者进程是否仍在运行（按 writerPid 检查）
+    bool writerAlive() const;
+    // 累计丢失的记录数
+    uint64_t lost() const { return m_lost; }
+    // 落后于写者的记录数
+    uint64_t backlog() const { return m_header->head.load(std::memory_order_acquire) - m_next; }
+
+private:
+    void skipToOldest(uint64_t head);
+
+    SharedMemory m_shm;
+    const TelemetryBusHeader* m_header = nullptr;
+    const TelemetryBusSlot* m_slots = nullptr;
+    uint64_t m_mask = 0;
+    uint64_t m_next = 0;
+    uint64_t m_lost = 0;
+};
@@ -0,0 +1,496 @@
+﻿#include "telemetry_format.h"
+#include "telemetry.h"
+#include "trace.h"
+#include <cstring>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+bool fileSync(FILE* fp) {
+    if (!fp || fflush(fp) != 0) return false;
+#if defined(_WIN32)
+    return _commit(_fileno(fp)) == 0;
+#else
+    return fsync(fileno(fp)) == 0;
+#endif
+}
+
+// ---- 位流 ----
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : m_out(out), m_acc(0), m_bits(0) {}
+    // 写入 v 的低 n 位（n<=64），高位在前
+    void put(uint64_t v, int n) {
+        while (n > 0) {
+            int take = n < 8 - m_bits ? n : 8 - m_bits;
+            uint64_t chunk = (v >> (n - take)) & ((1ull << take) - 1);
+            m_acc = (uint8_t)((m_acc << take) | chunk);
+            m_bits += take;
+            n -= take;
+            if (m_bits == 8) {
+                m_out.push_back(m_acc);
+                m_acc = 0;
+                m_bits = 0;
+            }
+        }
+    }
+    void finish() {
+        if (m_bits > 0) m_out.push_back((uint8_t)(m_acc << (8 - m_bits)));
+        m_acc = 0;
+        m_bits = 0;
+    }
+
+private:
+    std::vector<uint8_t>& m_out;
+    uint8_t m_acc;
+    int m_bits;
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* p, size_t n) : m_p(p), m_n(n), m_pos(0) {}
+    uint64_t get(int n) {
+        uint64_t v = 0;
+        while (n > 0) {
+            size_t byte = m_pos >> 3;
+            if (byte >= m_n) {
+                m_overrun = true;
+                return n >= 64 ? 0 : v << n;
+            }
+            int off = (int)(m_pos & 7);
+            int take = n < 8 - off ? n : 8 - off;
+            uint64_t chunk = (m_p[byte] >> (8 - off - take)) & ((1u << take) - 1);
+            v = (v << take) | chunk;
+            m_pos += take;
+            n -= take;
+        }
+        return v;
+    }
+    bool overrun() const { return m_overrun; }
+
+private:
+    const uint8_t* m_p;
+    size_t m_n;
+    size_t m_pos;
+    bool m_overrun = false;
+};
+
+static inline uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static inline int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+static inline int clz64(uint64_t v) {
+    int n = 0;
+    while (n < 64 && !(v & (1ull << 63))) { v <<= 1; n++; }
+    return n;
+}
+static inline int ctz64(uint64_t v) {
+    int n = 0;
+    while (n < 64 && !(v & 1)) { v >>= 1; n++; }
+    return n;
+}
+
+// ---- 整数列（时间、状态字）：delta-of-delta ----
+
+static void encodeTime(const std::vector<int64_t>& t, std::vector<uint8_t>& out) {
+    BitWriter bw(out);
+    int64_t prev = 0, prevDelta = 0;
+    for (size_t i = 0; i < t.size(); i++) {
+        if (i == 0) {
+            bw.put((uint64_t)t[0], 64);
+        }
+        else {
+            int64_t delta = t[i] - prev;
+            uint64_t z = zigzag(delta - prevDelta);
+            if (z == 0) bw.put(0, 1);
+            else if (z < (1u << 7)) { bw.put(2, 2); bw.put(z, 7); }
+            else if (z < (1u << 9)) { bw.put(6, 3); bw.put(z, 9); }
+            else if (z < (1u << 12)) { bw.put(14, 4); bw.put(z, 12); }
+            else { bw.put(15, 4); bw.put(z, 64); }
+            prevDelta = delta;
+        }
+        prev = t[i];
+    }
+    bw.finish();
+}
+
+// 首行 64 位、其余每行至少 1 位；行数来自文件，先按负载长度检查再分配
+static bool rowsFit(size_t n, size_t rows) {
+    return rows == 0 || (uint64_t)n * 8 >= 63 + (uint64_t)rows;
+}
+
+static bool decodeTime(const uint8_t* p, size_t n, size_t rows, std::vector<int64_t>& t) {
+    if (!rowsFit(n, rows)) return false;
+    BitReader br(p, n);
+    t.resize(rows);
+    int64_t prev = 0, prevDelta = 0;
+    for (size_t i = 0; i < rows; i++) {
+        if (i == 0) {
+            t[0] = (int64_t)br.get(64);
+        }
+        else {
+            uint64_t z;
+            if (br.get(1) == 0) z = 0;
+            else if (br.get(1) == 0) z = br.get(7);
+            else if (br.get(1) == 0) z = br.get(9);
+            else if (br.get(1) == 0) z = br.get(12);
+            else z = br.get(64);
+            prevDelta += unzigzag(z);
+            t[i] = prev + prevDelta;
+        }
+        prev = t[i];
+    }
+    return !br.overrun();
+}
+
+// ---- 数值列：Gorilla XOR ----
+
+static void encodeXor(const std::vector<double>& v, std::vector<uint8_t>& out) {
+    BitWriter bw(out);
+    uint64_t prev = 0;
+    int prevLead = -1, prevTrail = 0;
+    for (size_t i = 0; i < v.size(); i++) {
+        uint64_t bits;
+        memcpy(&bits, &v[i], 8);
+        if (i == 0) {
+            bw.put(bits, 64);
+        }
+        else {
+            uint64_t x = bits ^ prev;
+            if (x == 0) {
+                bw.put(0, 1);
+            }
+            else {
+                int lead = clz64(x), trail = ctz64(x);
+                if (lead > 31) lead = 31;
+                if (prevLead >= 0 && lead >= prevLead && trail >= prevTrail) {
+                    // 沿用上一个有效位窗口
+                    bw.put(2, 2);
+                    bw.put(x >> prevTrail, 64 - prevLead - prevTrail);
+                }
+                else {
+                    int sig = 64 - lead - trail;
+                    bw.put(3, 2);
+                    bw.put((uint64_t)lead, 5);
+                    bw.put((uint64_t)(sig & 63), 6); // 64 记为 0
+                    bw.put(x >> trail, sig);
+                    prevLead = lead;
+                    prevTrail = trail;
+                }
+            }
+        }
+        prev = bits;
+    }
+    bw.finish();
+}
+
+static bool decodeXor(const uint8_t* p, size_t n, size_t rows, std::vector<double>& v) {
+    if (!rowsFit(n, rows)) return false;
+    BitReader br(p, n);
+    v.resize(rows);
+    uint64_t prev = 0;
+    int prevLead = 0, prevTrail = 0;
+    for (size_t i = 0; i < rows; i++) {
+        uint64_t bits;
+        if (i == 0) {
+            bits = br.get(64);
+        }
+        else if (br.get(1) == 0) {
+            bits = prev;
+        }
+        else {
+            if (br.get(1) == 1) {
+                prevLead = (int)br.get(5);
+                int sig = (int)br.get(6);
+                if (sig == 0) sig = 64;
+                // 损坏的文件可能给出超过 64 位的窗口
+                if (prevLead + sig > 64) return false;
+                prevTrail = 64 - prevLead - sig;
+            }
+            int sig = 64 - prevLead - prevTrail;
+            bits = prev ^ (br.get(sig) << prevTrail);
+        }
+        memcpy(&v[i], &bits, 8);
+        prev = bits;
+    }
+    return !br.overrun();
+}
+
+static void appendBytes(std::vector<uint8_t>& out, const void* p, size_t n) {
+    const uint8_t* b = (const uint8_t*)p;
+    out.insert(out.end(), b, b + n);
+}
+
+// ---- 写 ----
+
+// 列名与 data.csv 表头一致，另加状态字
+static void tlmColumnName(char* buf, size_t size, int c, int engineCount) {
+    static const char* const signals[] = { "N1", "T", "FF" };
+    if (c == 0) snprintf(buf, size, "Time(ms)");
+    else if (c <= 3 * engineCount) telemetryColumnName(buf, size, signals[(c - 1) / engineCount], (c - 1) % engineCount, engineCount);
+    else snprintf(buf, size, c == 3 * engineCount + 1 ? "Fuel" : "Status");
+}
+
+static bool tlmIntColumn(int c, int columnCount) {
+    return c == 0 || c == columnCount - 1;
+}
+
+TlmWriter::TlmWriter() : m_fp(NULL), m_engineCount(SIM_DEFAULT_ENGINES), m_bytes(0), m_failures(0) {
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+TlmWriter::~TlmWriter() {
+    close();
+}
+
+bool TlmWriter::open(const char* path, bool compress, uint32_t rowsPerBlock, int engineCount) {
+    close();
+    if (engineCount < 1 || engineCount > SIM_MAX_ENGINES) return false;
+    m_fp = fopen(path, "wb");
+    if (!m_fp) return false;
+
+    m_engineCount = engineCount;
+    memset(&m_header, 0, sizeof(m_header));
+    memcpy(m_header.magic, "ETLM", 4);
+    m_header.version = TLM_VERSION;
+    m_header.columnCount = (uint16_t)tlmColumnCount(engineCount);
+    m_header.rowsPerBlock = rowsPerBlock ? rowsPerBlock : 4096;
+    for (int c = 0; c < m_header.columnCount; c++) {
+        TlmColumnDesc& d = m_header.columns[c];
+        tlmColumnName(d.name, sizeof(d.name), c, engineCount);
+        bool isInt = tlmIntColumn(c, m_header.columnCount);
+        d.type = isInt ? TLM_INT64 : TLM_FLOAT64;
+        d.codec = !compress ? TLM_RAW : (isInt ? TLM_DELTA : TLM_XOR);
+    }
+    m_failures = 0;
+    if (fwrite(&m_header, sizeof(m_header), 1, m_fp) != 1) m_failures++;
+    m_bytes = sizeof(m_header);
+
+    m_time.clear();
+    m_time.reserve(m_header.rowsPerBlock);
+    for (int c = 0; c < tlmValueColumns(engineCount); c++) {
+        m_values[c].clear();
+        m_values[c].reserve(m_header.rowsPerBlock);
+    }
+    m_status.clear();
+    m_status.reserve(m_header.rowsPerBlock);
+    m_events.clear();
+    return true;
+}
+
+void TlmWriter::close() {
+    if (!m_fp) return;
+    flush();
+    fclose(m_fp);
+    m_fp = NULL;
+}
+
+void TlmWriter::onSample(const TelemetrySample& s) {
+    if (!m_fp) return;
+    const int n = m_engineCount;
+    m_time.push_back(s.timeMs);
+    for (int i = 0; i < n; i++) {
+        m_values[i].push_back(s.N1[i]);
+        m_values[n + i].push_back(s.T[i]);
+        m_values[2 * n + i].push_back(s.FF[i]);
+    }
+    m_values[3 * n].push_back(s.fuel);
+    m_status.push_back((int64_t)(uint32_t)s.state | ((int64_t)s.sensorFlags << 8));
+    if (m_time.size() >= m_header.rowsPerBlock) flush();
+}
+
+void TlmWriter::onFault(int64_t timeMs, FaultType ft) {
+    if (!m_fp) return;
+    TlmEvent e = { timeMs, (int32_t)ft, 0 };
+    m_events.push_back(e);
+}
+
+void TlmWriter::flush() {
+    if (!m_fp) return;
+    if (!m_time.empty()) {
+        m_payload.clear();
+        for (int c = 0; c < m_header.columnCount; c++) {
+            // 每列：uint32 字节数 + 编码数据
+            size_t lenPos = m_payload.size();
+            uint32_t len = 0;
+            appendBytes(m_payload, &len, 4);
+            const TlmColumnDesc& d = m_header.columns[c];
+            if (tlmIntColumn(c, m_header.columnCount)) {
+                const std::vector<int64_t>& v = c == 0 ? m_time : m_status;
+                if (d.codec == TLM_DELTA) encodeTime(v, m_payload);
+                else appendBytes(m_payload, v.data(), v.size() * 8);
+            }
+            else {
+                const std::vector<double>& v = m_values[c - 1];
+                if (d.codec == TLM_XOR) encodeXor(v, m_payload);
+                else appendBytes(m_payload, v.data(), v.size() * 8);
+            }
+            len = (uint32_t)(m_payload.size() - lenPos - 4);
+            memcpy(&m_payload[lenPos], &len, 4);
+        }
+        writeBlock(TLM_DATA_BLOCK, (uint32_t)m_time.size(), m_time.front(), m_time.back());
+        m_time.clear();
+        for (int c = 0; c < tlmValueColumns(m_engineCount); c++) m_values[c].clear();
+        m_status.clear();
+    }
+    if (!m_events.empty()) {
+        m_payload.clear();
+        appendBytes(m_payload, m_events.data(), m_events.size() * sizeof(TlmEvent));
+        writeBlock(TLM_EVENT_BLOCK, (uint32_t)m_events.size(), m_events.front().timeMs, m_events.back().timeMs);
+        m_events.clear();
+    }
+}
+
+void TlmWriter::writeBlock(uint32_t kind, uint32_t rows, int64_t first, int64_t last) {
+    TlmBlockHeader bh;
+    bh.kind = kind;
+    bh.rowCount = rows;
+    bh.firstTimeMs = first;
+    bh.lastTimeMs = last;
+    bh.payloadBytes = (uint32_t)m_payload.size();
+    bh.reserved = 0;
+    TRACE_ZONE("tlm write block");
+    if (fwrite(&bh, sizeof(bh), 1, m_fp) != 1
+        || fwrite(m_payload.data(), 1, m_payload.size(), m_fp) != m_payload.size()) {
+        m_failures++;
+        return;
+    }
+    m_bytes += sizeof(bh) + m_payload.size();
+}
+
+bool TlmWriter::sync() {
+    if (!m_fp) return true;
+    if (fileSync(m_fp)) return true;
+    m_failures++;
+    return false;
+}
+
+// ---- 读 ----
+
+void TlmBlock::sample(size_t row, TelemetrySample& s) const {
+    const int n = engineCount;
+    s.timeMs = time[row];
+    s.engineCount = n;
+    for (int i = 0; i < SIM_MAX_ENGINES; i++) {
+        s.N1[i] = i < n ? values[i][row] : 0;
+        s.T[i] = i < n ? values[n + i][row] : 0;
+        s.FF[i] = i < n ? values[2 * n + i][row] : 0;
+    }
+    s.fuel = values[3 * n][row];
+    s.state = (int32_t)(status[row] & 0xff);
+    s.sensorFlags = (uint32_t)(status[row] >> 8);
+}
+
+bool tlmCheckHeader(const TlmFileHeader& h) {
+    int n = tlmEngineCount(h.columnCount);
+    return memcmp(h.magic, "ETLM", 4) == 0 && h.version == TLM_VERSION
+        && n >= 1 && n <= SIM_MAX_ENGINES && h.columnCount == tlmColumnCount(n);
+}
+
+bool tlmDecodeBlock(const TlmFileHeader& h, const TlmBlockHeader& bh, const uint8_t* payload, TlmBlock& out) {
+    out.kind = bh.kind;
+    out.engineCount = tlmEngineCount(h.columnCount);
+    size_t rows = bh.rowCount;
+    if (bh.kind == TLM_EVENT_BLOCK) {
+        if (bh.payloadBytes != rows * sizeof(TlmEvent)) return false;
+        out.events.resize(rows);
+        if (rows) memcpy(out.events.data(), payload, bh.payloadBytes);
+        out.time.clear();
+        return true;
+    }
+    if (bh.kind != TLM_DATA_BLOCK) return false;
+
+    out.events.clear();
+    size_t pos = 0;
+    for (int c = 0; c < h.columnCount; c++) {
+        uint32_t len;
+        if (pos + 4 > bh.payloadBytes) return false;
+        memcpy(&len, payload + pos, 4);
+        pos += 4;
+        if (pos + len > bh.payloadBytes) return false;
+        const uint8_t* p = payload + pos;
+        const TlmColumnDesc& d = h.columns[c];
+        bool ok = true;
+        if (tlmIntColumn(c, h.columnCount)) {
+            std::vector<int64_t>& v = c == 0 ? out.time : out.status;
+            if (d.codec == TLM_DELTA) ok = decodeTime(p, len, rows, v);
+            else if (len == rows * 8) {
+                v.resize(rows);
+                memcpy(v.data(), p, len);
+            }
+            else ok = false;
+        }
+        else {
+            std::vector<double>& v = out.values[c - 1];
+            if (d.codec == TLM_XOR) ok = decodeXor(p, len, rows, v);
+            else if (len == rows * 8) {
+                v.resize(rows);
+                memcpy(v.data(), p, len);
+            }
+            else ok = false;
+        }
+        if (!ok) return false;
+        pos += len;
+    }
+    return true;
+}
+
+bool tlmDecodeTimeColumn(const TlmFileHeader& h, const TlmBlockHeader& bh, const uint8_t* payload, std::vector<int64_t>& time) {
+    uint32_t len;
+    if (bh.kind != TLM_DATA_BLOCK || bh.payloadBytes < 4) return false;
+    memcpy(&len, payload, 4);
+    if (4 + (size_t)len > bh.payloadBytes) return false;
+    if (h.columns[0].codec == TLM_DELTA) return decodeTime(payload + 4, len, bh.rowCount, time);
+    if (len != bh.rowCount * 8) return false;
+    time.resize(bh.rowCount);
+    memcpy(time.data(), payload + 4, len);
+    return true;
+}
+
+TlmFileReader::TlmFileReader() : m_fp(NULL), m_failed(false) {
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+TlmFileReader::~TlmFileReader() {
+    close();
+}
+
+bool TlmFileReader::open(const char* path) {
+    close();
+    m_failed = false;
+    m_fp = fopen(path, "rb");
+    if (!m_fp) return false;
+    if (fread(&m_header, sizeof(m_header), 1, m_fp) != 1 || !tlmCheckHeader(m_header)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TlmFileReader::close() {
+    if (m_fp) fclose(m_fp);
+    m_fp = NULL;
+}
+
+bool TlmFileReader::next(TlmBlock& block) {
+    if (!m_fp) return false;
+    TlmBlockHeader bh;
+    size_t got = fread(&bh, 1, sizeof(bh), m_fp);
+    if (got == 0) return false;
+    if (got != sizeof(bh)) {
+        m_failed = true;
+        return false;
+    }
+    m_payload.resize(bh.payloadBytes);
+    if (bh.payloadBytes && fread(m_payload.data(), 1, bh.payloadBytes, m_fp) != bh.payloadBytes) {
+        m_failed = true;
+        return false;
+    }
+    if (!tlmDecodeBlock(m_header, bh, m_payload.data(), block)) {
+        m_failed = true;
+        return false;
+    }
+    return true;
+}
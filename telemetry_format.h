@@ -0,0 +1,134 @@
+﻿#pragma once
+// 二进制列式遥测格式（.tlm）
+//
+// 文件 = 固定文件头(含列定义) + 若干块。每块有块头，数据块内按列存放：
+// 时间列用 delta-of-delta 编码，数值列用 Gorilla 风格 XOR 编码（也可不压缩）。
+// 告警事件存放在事件块中。所有整数均为小端。
+#include "sim_core.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// 列：时间 + 每台发动机 N1/T/FF + 燃油 + 状态字(状态机状态 | 传感器故障标志<<8)；
+// 发动机台数由列数得出，双发文件与原格式相同
+enum {
+    TLM_VERSION = 2,
+    TLM_MAX_COLUMNS = 32,
+    TLM_MAX_VALUE_COLUMNS = 3 * SIM_MAX_ENGINES + 1
+};
+
+inline int tlmColumnCount(int engineCount) { return 1 + 3 * engineCount + 1 + 1; }
+inline int tlmValueColumns(int engineCount) { return 3 * engineCount + 1; }
+inline int tlmEngineCount(int columnCount) { return (columnCount - 3) / 3; }
+
+enum TlmColumnType { TLM_INT64 = 0, TLM_FLOAT64 = 1 };
+enum TlmCodec { TLM_RAW = 0, TLM_DELTA = 1, TLM_XOR = 2 };
+enum TlmBlockKind { TLM_DATA_BLOCK = 0x4B4C4244, TLM_EVENT_BLOCK = 0x4B4C4245 }; // "DBLK" / "EBLK"
+
+#pragma pack(push, 1)
+struct TlmColumnDesc {
+    char name[24];
+    uint8_t type;  // TlmColumnType
+    uint8_t codec; // TlmCodec
+    uint16_t reserved;
+};
+
+struct TlmFileHeader {
+    char magic[4]; // "ETLM"
+    uint16_t version;
+    uint16_t columnCount;
+    uint32_t rowsPerBlock;
+    uint32_t reserved;
+    TlmColumnDesc columns[TLM_MAX_COLUMNS];
+};
+
+struct TlmBlockHeader {
+    uint32_t kind;        // TlmBlockKind
+    uint32_t rowCount;
+    int64_t firstTimeMs;
+    int64_t lastTimeMs;
+    uint32_t payloadBytes;
+    uint32_t reserved;
+};
+
+struct TlmEvent {
+    int64_t timeMs;
+    int32_t type; // FaultType
+    int32_t reserved;
+};
+#pragma pack(pop)
+
+// 解码后的一块
+struct TlmBlock {
+    uint32_t kind;
+    int engineCount;
+    std::vector<int64_t> time;
+    std::vector<double> values[TLM_MAX_VALUE_COLUMNS];
+    std::vector<int64_t> status;
+    std::vector<TlmEvent> events;
+
+    size_t rows() const { return kind == TLM_DATA_BLOCK ? time.size() : events.size(); }
+    void sample(size_t row, TelemetrySample& s) const;
+};
+
+// 写文件：可直接作为仿真的输出
+class TlmWriter : public TelemetrySink {
+public:
+    TlmWriter();
+    ~TlmWriter();
+    bool open(const char* path, bool compress = true, uint32_t rowsPerBlock = 4096, int engineCount = SIM_DEFAULT_ENGINES);
+    void close();
+    void onSample(const TelemetrySample& s) override;
+    void onFault(int64_t timeMs, FaultType ft) override;
+    // 把不满一块的数据也写出
+    void flush();
+    // 是否有尚未写出的行或告警
+    bool buffered() const { return !m_time.empty() || !m_events.empty(); }
+    uint64_t bytesWritten() const { return m_bytes; }
+    // 写入失败（磁盘满等）的块数
+    uint64_t writeFailures() const { return m_failures; }
+    // 把已写出的块刷到磁盘
+    bool sync();
+
+private:
+    void writeBlock(uint32_t kind, uint32_t rows, int64_t first, int64_t last);
+
+    FILE* m_fp;
+    TlmFileHeader m_header;
+    int m_engineCount;
+    uint64_t m_bytes;
+    uint64_t m_failures;
+    std::vector<int64_t> m_time;
+    std::vector<double> m_values[TLM_MAX_VALUE_COLUMNS];
+    std::vector<int64_t> m_status;
+    std::vector<TlmEvent> m_events;
+    std::vector<uint8_t> m_payload;
+};
+
+// fflush 后再 fsync / _commit，确保数据到达磁盘
+bool fileSync(FILE* fp);
+
+bool tlmCheckHeader(const TlmFileHeader& h);
+// 解码一块的负载；payload 长度为 bh.payloadBytes
+bool tlmDecodeBlock(const TlmFileHeader& h, const TlmBlockHeader& bh, const uint8_t* payload, TlmBlock& out);
+// 只解码数据块的时间列（建索引用）
+bool tlmDecodeTimeColumn(const TlmFileHeader& h, const TlmBlockHeader& bh, const uint8_t* payload, std::vector<int64_t>& time);
+
+// 顺序读文件，逐块解码
+class TlmFileReader {
+public:
+    TlmFileReader();
+    ~TlmFileReader();
+    bool open(const char* path);
+    void close();
+    const TlmFileHeader& header() const { return m_header; }
+    // 读下一块；文件结束或出错返回 false
+    bool next(TlmBlock& block);
+    bool failed() const { return m_failed; }
+
+private:
+    FILE* m_fp;
+    TlmFileHeader m_header;
+    std::vector<uint8_t> m_payload;
+    bool m_failed;
+};
@@ -0,0 +1,103 @@
+﻿#include "telemetry_replay.h"
+#include <algorithm>
+#include <cstring>
+
+TlmReplay::TlmReplay() : m_rows(0), m_cached((size_t)-1) {
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+int64_t TlmReplay::advanceTimeline(int64_t timeline, int64_t prevRaw, int64_t raw) {
+    if (prevRaw < 0) return raw;
+    int64_t d = raw - prevRaw;
+    // START 时 Time(ms) 归零：从新段起点继续
+    if (d < 0) d = raw;
+    return timeline + d;
+}
+
+bool TlmReplay::open(const char* path) {
+    close();
+    if (!m_file.open(path)) return false;
+    const uint8_t* p = m_file.data();
+    size_t size = m_file.size();
+    if (size < sizeof(TlmFileHeader)) return false;
+    memcpy(&m_header, p, sizeof(m_header));
+    if (!tlmCheckHeader(m_header)) return false;
+
+    // 扫描块头建索引；数据块只解码时间列
+    size_t pos = sizeof(TlmFileHeader);
+    int64_t timeline = 0, prevRaw = -1;
+    std::vector<int64_t> time;
+    while (pos + sizeof(TlmBlockHeader) <= size) {
+        TlmBlockHeader bh;
+        memcpy(&bh, p + pos, sizeof(bh));
+        const uint8_t* payload = p + pos + sizeof(bh);
+        if (pos + sizeof(bh) + bh.payloadBytes > size) break; // 末块不完整（录制中断）
+        if (bh.kind == TLM_DATA_BLOCK && bh.rowCount > 0) {
+            if (!tlmDecodeTimeColumn(m_header, bh, payload, time)) break;
+            BlockIndex bi;
+            bi.offset = pos;
+            bi.rows = bh.rowCount;
+            bi.prevRaw = prevRaw;
+            for (size_t r = 0; r < time.size(); r++) {
+                timeline = advanceTimeline(timeline, prevRaw, time[r]);
+                prevRaw = time[r];
+                if (r == 0) bi.firstMs = timeline;
+            }
+            bi.lastMs = timeline;
+            m_blocks.push_back(bi);
+            m_rows += bh.rowCount;
+        }
+        else if (bh.kind == TLM_EVENT_BLOCK && bh.payloadBytes == bh.rowCount * sizeof(TlmEvent)) {
+            // 先核对长度再分配，行数来自文件
+            size_t n = m_events.size();
+            m_events.resize(n + bh.rowCount);
+            if (bh.rowCount) memcpy(&m_events[n], payload, bh.payloadBytes);
+        }
+        pos += sizeof(bh) + bh.payloadBytes;
+    }
+    return !m_blocks.empty();
+}
+
+void TlmReplay::close() {
+    m_file.close();
+    m_blocks.clear();
+    m_events.clear();
+    m_rows = 0;
+    m_cached = (size_t)-1;
+}
+
+bool TlmReplay::loadBlock(size_t i) {
+    if (i == m_cached) return true;
+    const BlockIndex& bi = m_blocks[i];
+    TlmBlockHeader bh;
+    memcpy(&bh, m_file.data() + bi.offset, sizeof(bh));
+    if (!tlmDecodeBlock(m_header, bh, m_file.data() + bi.offset + sizeof(bh), m_block)) return false;
+
+    // 还原块内每行的时间轴位置
+    m_timeline.resize(m_block.time.size());
+    int64_t timeline = bi.firstMs, prevRaw = bi.prevRaw;
+    for (size_t r = 0; r < m_block.time.size(); r++) {
+        timeline = r == 0 ? bi.firstMs : advanceTimeline(timeline, prevRaw, m_block.time[r]);
+        prevRaw = m_block.time[r];
+        m_timeline[r] = timeline;
+    }
+    m_cached = i;
+    return true;
+}
+
+bool TlmReplay::sampleAt(int64_t t, TelemetrySample& s) {
+    if (m_blocks.empty()) return false;
+    // 二分查找首行不晚于 t 的最后一块
+    size_t lo = 0, hi = m_blocks.size();
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (m_blocks[mid].firstMs <= t) lo = mid;
+        else hi = mid;
+    }
+    if (!loadBlock(lo)) return false;
+    // 块内二分
+    size_t row = std::upper_bound(m_timeline.begin(), m_timeline.end(), t) - m_timeline.begin();
+    if (row > 0) row--;
+    m_block.sample(row, s);
+    return true;
+}
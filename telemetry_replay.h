@@ -0,0 +1,65 @@
+﻿#pragma once
+// .tlm 回放：内存映射文件，按块建立稀疏时间索引，O(log n) 跳转到任意时刻
+//
+// 记录中的 Time(ms) 在每次 START 时归零，回放使用单调的“时间轴”：
+// 逐行累加时间差，遇到归零时按新段起点继续累加。
+#include "mapped_file.h"
+#include "telemetry_format.h"
+#include <vector>
+
+class TlmReplay {
+public:
+    TlmReplay();
+    bool open(const char* path);
+    void close();
+
+    // 时间轴范围（毫秒）
+    int64_t beginMs() const { return m_blocks.empty() ? 0 : m_blocks.front().firstMs; }
+    int64_t endMs() const { return m_blocks.empty() ? 0 : m_blocks.back().lastMs; }
+    uint64_t rowCount() const { return m_rows; }
+    // 时间轴位置 t 处的记录（不晚于 t 的最后一条）
+    bool sampleAt(int64_t t, TelemetrySample& s);
+    // 记录中的告警事件
+    const std::vector<TlmEvent>& events() const { return m_events; }
+
+private:
+    // 稀疏索引：每个数据块一项
+    struct BlockIndex {
+        size_t offset;   // 块头在文件中的偏移
+        uint32_t rows;
+        int64_t firstMs; // 块首行的时间轴位置
+        int64_t lastMs;  // 块末行的时间轴位置
+        int64_t prevRaw; // 前一块最后一行的原始 Time(ms)，首块为 -1
+    };
+
+    bool loadBlock(size_t i);
+    static int64_t advanceTimeline(int64_t timeline, int64_t prevRaw, int64_t raw);
+
+    MappedFile m_file;
+    TlmFileHeader m_header;
+    std::vector<BlockIndex> m_blocks;
+    std::vector<TlmEvent> m_events;
+    uint64_t m_rows;
+
+    // 当前解码的块
+    size_t m_cached;
+    TlmBlock m_block;
+    std::vector<int64_t> m_timeline;
+};
+
+// 回放进度：按墙钟推进，支持变速、暂停、跳转
+struct ReplayClock {
+    double positionMs = 0;
+    double speed = 1.0;
+    bool paused = false;
+
+    void advance(double wallSeconds, int64_t endMs) {
+        if (!paused) positionMs += wallSeconds * 1000.0 * speed;
+        seek(positionMs, endMs);
+    }
+    void seek(double ms, int64_t endMs) {
+        if (ms < 0) ms = 0;
+        if (ms > endMs) ms = (double)endMs;
+        positionMs = ms;
+    }
+};
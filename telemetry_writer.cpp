@@ -0,0 +1,163 @@
+﻿#include "telemetry_writer.h"
+#include "telemetry.h"
+#include "trace.h"
+#include <chrono>
+
+AsyncTelemetrySink::AsyncTelemetrySink()
+    : m_ring(NULL), m_dataFile(NULL), m_logFile(NULL),
+    m_running(false), m_written(0), m_dropped(0), m_backpressured(0), m_writeFailures(0), m_tlmFailures(0) {
+}
+
+AsyncTelemetrySink::~AsyncTelemetrySink() {
+    close();
+}
+
+bool AsyncTelemetrySink::open(const char* dataPath, const char* logPath, const AsyncWriterOptions& opt) {
+    close();
+    m_opt = opt;
+    m_writeFailures.store(0, std::memory_order_relaxed);
+    m_tlmFailures = 0;
+    if (opt.binary) {
+        if (!m_tlm.open(dataPath, opt.compress, 4096, opt.engineCount)) return false;
+    }
+    else if (!openText(dataPath, logPath)) {
+        return false;
+    }
+
+    m_ring = new SpscRing<Record>(opt.ringCapacity);
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&AsyncTelemetrySink::writerLoop, this);
+    return true;
+}
+
+bool AsyncTelemetrySink::openText(const char* dataPath, const char* logPath) {
+    // 文本模式，与 CsvTelemetrySink 的 std::ofstream 相同（Windows 下换行为 CRLF）
+    m_dataFile = fopen(dataPath, "w");
+    m_logFile = fopen(logPath, "w");
+    if (!m_dataFile || !m_logFile) {
+        close();
+        return false;
+    }
+    // 由本类自己攒块，关闭 stdio 缓冲
+    setvbuf(m_dataFile, NULL, _IONBF, 0);
+    setvbuf(m_logFile, NULL, _IONBF, 0);
+    fputs(csvHeader(m_opt.engineCount).c_str(), m_dataFile);
+    return true;
+}
+
+void AsyncTelemetrySink::close() {
+    if (m_thread.joinable()) {
+        m_running.store(false, std::memory_order_release);
+        m_thread.join();
+    }
+    if (m_dataFile) fclose(m_dataFile);
+    if (m_logFile) fclose(m_logFile);
+    m_dataFile = m_logFile = NULL;
+    m_tlm.close();
+    delete m_ring;
+    m_ring = NULL;
+}
+
+void AsyncTelemetrySink::push(const Record& r) {
+    if (!m_ring) return;
+    if (m_ring->push(r)) return;
+    if (m_opt.dropWhenFull) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // 等待后台线程腾出空间
+    m_backpressured.fetch_add(1, std::memory_order_relaxed);
+    while (!m_ring->push(r)) std::this_thread::yield();
+}
+
+void AsyncTelemetrySink::onSample(const TelemetrySample& s) {
+    Record r;
+    r.s = s;
+    r.ft = NO_FAULT;
+    push(r);
+}
+
+void AsyncTelemetrySink::onFault(int64_t timeMs, FaultType ft) {
+    Record r;
+    r.s.timeMs = timeMs;
+    r.ft = ft;
+    push(r);
+}
+
+void AsyncTelemetrySink::writeOut(std::vector<char>& buf, FILE* fp, bool sync) {
+    TRACE_ZONE(sync ? "writer flush" : "writer write");
+    if (!fp) return;
+    if (!buf.empty() && fwrite(buf.data(), 1, buf.size(), fp) != buf.size()) {
+        m_writeFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+    buf.clear();
+    if (sync && !fileSync(fp)) m_writeFailures.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 取出队列中的记录并格式化，攒满一块就写出
+void AsyncTelemetrySink::drain(std::vector<char>& data, std::vector<char>& log) {
+    Record batch[256];
+    char line[256];
+    size_t n;
+    while ((n = m_ring->popBatch(batch, 256)) > 0) {
+        TRACE_ZONE("writer format");
+        for (size_t i = 0; i < n; i++) {
+            if (m_opt.binary) {
+                if (batch[i].ft == NO_FAULT) m_tlm.onSample(batch[i].s);
+                else m_tlm.onFault(batch[i].s.timeMs, batch[i].ft);
+            }
+            else if (batch[i].ft == NO_FAULT) {
+                int len = formatCsvRow(line, sizeof(line), batch[i].s);
+                data.insert(data.end(), line, line + len);
+            }
+            else {
+                int len = formatLogLine(line, sizeof(line), batch[i].s.timeMs, batch[i].ft);
+                log.insert(log.end(), line, line + len);
+            }
+        }
+        m_written.fetch_add(n, std::memory_order_relaxed);
+        if (data.size() >= m_opt.blockBytes) writeOut(data, m_dataFile, false);
+        if (log.size() >= m_opt.blockBytes) writeOut(log, m_logFile, false);
+    }
+}
+
+void AsyncTelemetrySink::writerLoop() {
+    typedef std::chrono::steady_clock Clock;
+    std::vector<char> data, log;
+    data.reserve(m_opt.blockBytes + 256);
+    log.reserve(4096);
+    Clock::time_point lastFlush = Clock::now();
+    TRACE_THREAD_NAME("telemetry writer");
+
+    for (;;) {
+        // 先读标志再取数据，保证关闭前放入的记录都能取到
+        bool running = m_running.load(std::memory_order_acquire);
+        drain(data, log);
+        if (!running) break;
+
+        if (m_opt.maxLatencyMs > 0 && (!data.empty() || !log.empty() || m_tlm.buffered())
+            && Clock::now() - lastFlush >= std::chrono::milliseconds(m_opt.maxLatencyMs)) {
+            flushAll(data, log, true);
+            lastFlush = Clock::now();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // 关闭时只写出，fclose 交给系统缓存，与 std::ofstream 相同
+    flushAll(data, log, false);
+}
+
+// 把已攒下的数据写出；sync 时再 fsync 到磁盘
+void AsyncTelemetrySink::flushAll(std::vector<char>& data, std::vector<char>& log, bool sync) {
+    if (m_opt.binary) {
+        // 二进制模式：不满一块的行也编码成一块，没有新行时不写空块
+        TRACE_ZONE("writer flush");
+        if (m_tlm.buffered()) m_tlm.flush();
+        if (sync) m_tlm.sync();
+        uint64_t failures = m_tlm.writeFailures();
+        m_writeFailures.fetch_add(failures - m_tlmFailures, std::memory_order_relaxed);
+        m_tlmFailures = failures;
+        return;
+    }
+    writeOut(data, m_dataFile, sync);
+    writeOut(log, m_logFile, sync);
+}
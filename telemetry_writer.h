@@ -0,0 +1,64 @@
+﻿#pragma once
+// 异步遥测输出：仿真线程只把记录放入无锁环形缓冲区，
+// 后台线程批量格式化并整块写入 data.csv / log.txt，或编码为 .tlm
+#include "sim_core.h"
+#include "spsc_ring.h"
+#include "telemetry_format.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+struct AsyncWriterOptions {
+    size_t ringCapacity = 1 << 16; // 环形缓冲区记录数
+    size_t blockBytes = 1 << 20;   // 每次整块写入的大小
+    int maxLatencyMs = 100;        // 数据最迟多久写出并 fsync 到磁盘（<=0 表示只在缓冲满或关闭时写，不 fsync）
+    bool dropWhenFull = false;     // 满时丢弃（否则等待后台线程，计入 backpressured）
+    bool binary = false;           // 写 .tlm 二进制格式（告警事件写在同一文件中）
+    bool compress = true;          // .tlm 是否压缩
+    int engineCount = SIM_DEFAULT_ENGINES; // 决定 data.csv / .tlm 的列
+};
+
+class AsyncTelemetrySink : public TelemetrySink {
+public:
+    AsyncTelemetrySink();
+    ~AsyncTelemetrySink();
+    bool open(const char* dataPath, const char* logPath, const AsyncWriterOptions& opt = AsyncWriterOptions());
+    // 写完队列中剩余记录后关闭文件
+    void close();
+    void onSample(const TelemetrySample& s) override;
+    void onFault(int64_t timeMs, FaultType ft) override;
+
+    uint64_t written() const { return m_written.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    uint64_t backpressured() const { return m_backpressured.load(std::memory_order_relaxed); }
+    // 写入或 fsync 失败的次数（磁盘满等），关闭后包含 .tlm 的失败
+    uint64_t writeFailures() const { return m_writeFailures.load(std::memory_order_relaxed); }
+
+private:
+    // ft == NO_FAULT 表示数据记录，否则为告警日志
+    struct Record {
+        TelemetrySample s;
+        FaultType ft;
+    };
+
+    bool openText(const char* dataPath, const char* logPath);
+    void push(const Record& r);
+    void writerLoop();
+    void drain(std::vector<char>& data, std::vector<char>& log);
+    void writeOut(std::vector<char>& buf, FILE* fp, bool sync);
+    void flushAll(std::vector<char>& data, std::vector<char>& log, bool sync);
+
+    SpscRing<Record>* m_ring;
+    AsyncWriterOptions m_opt;
+    FILE* m_dataFile;
+    FILE* m_logFile;
+    TlmWriter m_tlm;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_written;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic<uint64_t> m_backpressured;
+    std::atomic<uint64_t> m_writeFailures;
+    uint64_t m_tlmFailures; // 已计入 m_writeFailures 的 .tlm 失败数（仅后台线程使用）
+};
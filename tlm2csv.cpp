@@ -0,0 +1,62 @@
+﻿// 把 .tlm 二进制遥测还原为与仿真器原样一致的 data.csv / log.txt
+#include "telemetry.h"
+#include "telemetry_format.h"
+#include <cstdio>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 4) {
+        printf("Usage: %s <input.tlm> [data.csv] [log.txt]\n", argv[0]);
+        return 1;
+    }
+    const char* csvPath = argc > 2 ? argv[2] : "data.csv";
+    const char* logPath = argc > 3 ? argv[3] : "log.txt";
+
+    TlmFileReader reader;
+    if (!reader.open(argv[1])) {
+        fprintf(stderr, "%s: not a telemetry file\n", argv[1]);
+        return 1;
+    }
+    // 文本模式，与仿真器的 data.csv / log.txt 相同（Windows 下为 CRLF）
+    FILE* csv = fopen(csvPath, "w");
+    FILE* log = fopen(logPath, "w");
+    if (!csv || !log) {
+        fprintf(stderr, "cannot open %s / %s\n", csvPath, logPath);
+        return 1;
+    }
+    fputs(csvHeader(tlmEngineCount(reader.header().columnCount)).c_str(), csv);
+
+    TlmBlock block;
+    TelemetrySample s;
+    std::vector<char> out;
+    char line[256];
+    long long rows = 0, events = 0;
+    while (reader.next(block)) {
+        out.clear();
+        if (block.kind == TLM_DATA_BLOCK) {
+            for (size_t r = 0; r < block.rows(); r++) {
+                block.sample(r, s);
+                int len = formatCsvRow(line, sizeof(line), s);
+                out.insert(out.end(), line, line + len);
+            }
+            fwrite(out.data(), 1, out.size(), csv);
+            rows += block.rows();
+        }
+        else {
+            for (const TlmEvent& e : block.events) {
+                int len = formatLogLine(line, sizeof(line), e.timeMs, (FaultType)e.type);
+                out.insert(out.end(), line, line + len);
+            }
+            fwrite(out.data(), 1, out.size(), log);
+            events += block.rows();
+        }
+    }
+    fclose(csv);
+    fclose(log);
+    if (reader.failed()) {
+        fprintf(stderr, "%s: corrupt block after %lld rows\n", argv[1], rows);
+        return 1;
+    }
+    printf("rows=%lld events=%lld\n", rows, events);
+    return 0;
+}
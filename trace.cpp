@@ -0,0 +1,128 @@
+﻿#include "trace.h"
+
+#if defined(ENGINE_TRACE)
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum { TRACE_BUFFER_EVENTS = 1 << 16 };
+
+struct TraceEvent {
+    const char* name;
+    int64_t start; // traceTicks 读数
+    int64_t end;
+};
+
+// 每个线程一个；注册后不释放，线程退出后事件仍可导出
+struct TraceBuffer {
+    TraceEvent events[TRACE_BUFFER_EVENTS];
+    uint64_t count; // 写入过的事件总数，超过容量后环形覆盖
+    int tid;
+    const char* name;
+};
+
+static std::mutex g_traceMutex;
+static std::vector<TraceBuffer*> g_traceBuffers;
+static thread_local TraceBuffer* t_traceBuffer = nullptr;
+
+typedef std::chrono::steady_clock TraceClock;
+
+// 时间戳换算：进程启动时与导出时各取一对 (ticks, steady_clock)，按两点线性换算
+static const TraceClock::time_point g_traceEpoch = TraceClock::now();
+static const int64_t g_traceEpochTicks = traceTicks();
+
+static TraceBuffer* traceBuffer() {
+    if (!t_traceBuffer) {
+        TraceBuffer* b = new TraceBuffer();
+        std::lock_guard<std::mutex> lock(g_traceMutex);
+        b->tid = (int)g_traceBuffers.size() + 1;
+        g_traceBuffers.push_back(b);
+        t_traceBuffer = b;
+    }
+    return t_traceBuffer;
+}
+
+// JSON 字符串中需要转义的只有引号和反斜杠（区间名都是代码中的字面量）
+static void writeJsonString(FILE* fp, const char* s) {
+    fputc('"', fp);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', fp);
+        fputc(*s, fp);
+    }
+    fputc('"', fp);
+}
+
+#if !(defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__))
+int64_t traceTicks() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(TraceClock::now().time_since_epoch()).count();
+}
+#endif
+
+void traceRecord(const char* name, int64_t start, int64_t end) {
+    TraceBuffer* b = traceBuffer();
+    TraceEvent& e = b->events[b->count & (TRACE_BUFFER_EVENTS - 1)];
+    e.name = name;
+    e.start = start;
+    e.end = end;
+    b->count++;
+}
+
+void traceSetThreadName(const char* name) {
+    traceBuffer()->name = name;
+}
+
+bool traceEnabled() {
+    return true;
+}
+
+bool traceWrite(const char* path) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) return false;
+    // 换算系数取启动以来的整段时间，至少间隔 10ms 以保证精度
+    TraceClock::time_point now = TraceClock::now();
+    if (now - g_traceEpoch < std::chrono::milliseconds(10)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        now = TraceClock::now();
+    }
+    double elapsedNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(now - g_traceEpoch).count();
+    double nsPerTick = elapsedNs / (double)(traceTicks() - g_traceEpochTicks);
+
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const TraceBuffer* b : g_traceBuffers) {
+        if (b->name) {
+            fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", first ? "" : ",\n", b->tid);
+            writeJsonString(fp, b->name);
+            fprintf(fp, "}}");
+            first = false;
+        }
+        // 环形缓冲区已满时从最旧的一条开始
+        uint64_t begin = b->count > TRACE_BUFFER_EVENTS ? b->count - TRACE_BUFFER_EVENTS : 0;
+        for (uint64_t i = begin; i < b->count; i++) {
+            const TraceEvent& e = b->events[i & (TRACE_BUFFER_EVENTS - 1)];
+            fprintf(fp, "%s{\"name\":", first ? "" : ",\n");
+            writeJsonString(fp, e.name);
+            fprintf(fp, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                b->tid, (e.start - g_traceEpochTicks) * nsPerTick / 1000.0, (e.end - e.start) * nsPerTick / 1000.0);
+            first = false;
+        }
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+    return true;
+}
+
+#else
+
+bool traceEnabled() {
+    return false;
+}
+
+bool traceWrite(const char*) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,54 @@
+﻿#pragma once
+// 作用域追踪：记录主循环各阶段与文件 I/O 的起止时刻，导出为 Chrome trace JSON
+// （chrome://tracing 或 ui.perfetto.dev 打开），用于查明某一帧超时的时间花在哪里。
+//
+// 只有定义 ENGINE_TRACE 时编译（g++ -DENGINE_TRACE，MSVC /DENGINE_TRACE），
+// 否则 TRACE_ZONE 展开为空语句，不产生任何代码。
+// 每个线程写自己的定长环形缓冲区（满后覆盖最旧的事件），记录时不加锁、不分配内存。
+#include <cstdint>
+
+#if defined(ENGINE_TRACE)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// 时间戳：x86 上直接读 TSC（比 steady_clock 便宜得多，导出时再换算成纳秒），其他平台用 steady_clock
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+inline int64_t traceTicks() { return (int64_t)__rdtsc(); }
+#else
+int64_t traceTicks();
+#endif
+// 记录一个完整区间 [start, end)（traceTicks 的读数）；name 须为静态字符串
+void traceRecord(const char* name, int64_t start, int64_t end);
+// 给当前线程命名（显示在追踪视图中）
+void traceSetThreadName(const char* name);
+
+class TraceZone {
+public:
+    explicit TraceZone(const char* name) : m_name(name), m_start(traceTicks()) {}
+    ~TraceZone() { traceRecord(m_name, m_start, traceTicks()); }
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+    const char* m_name;
+    int64_t m_start;
+};
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+// 从此处到所在作用域结束计为一个区间
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) traceSetThreadName(name)
+#else
+#define TRACE_ZONE(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+// 是否以 ENGINE_TRACE 编译
+bool traceEnabled();
+// 把所有线程缓冲区中的事件写成 Chrome trace JSON；应在其他线程停止记录后调用。
+// 未启用或无法写文件时返回 false
+bool traceWrite(const char* path);
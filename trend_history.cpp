@@ -0,0 +1,107 @@
+﻿#include "trend_history.h"
+#include <algorithm>
+#include <cfloat>
+
+// 第 l 层每桶的步数
+static uint64_t levelSpan(int l) {
+    return (uint64_t)1 << (2 * l);
+}
+
+static_assert(TREND_FANOUT == 4, "levelSpan assumes a fan-out of 4");
+
+TrendHistory::TrendHistory(double sampleSeconds) {
+    reset(sampleSeconds);
+}
+
+void TrendHistory::reset(double sampleSeconds) {
+    m_sampleSeconds = sampleSeconds;
+    m_samples = 0;
+    m_levels.assign(TREND_LEVELS, Level());
+    for (Level& lv : m_levels) {
+        lv.buckets.assign((size_t)TREND_CHANNELS * TREND_LEVEL_CAPACITY, Bucket{ 0, 0, 0 });
+        for (Bucket& b : lv.partial) b = Bucket{ FLT_MAX, -FLT_MAX, 0 };
+    }
+}
+
+void TrendHistory::append(const TelemetrySample& s) {
+    Bucket b[TREND_CHANNELS];
+    for (int i = 0; i < SIM_MAX_ENGINES; i++) {
+        bool on = i < s.engineCount;
+        float n1 = on ? (float)s.N1[i] : 0, t = on ? (float)s.T[i] : 0, ff = on ? (float)s.FF[i] : 0;
+        b[trendChannel(TREND_N1, i)] = Bucket{ n1, n1, n1 };
+        b[trendChannel(TREND_EGT, i)] = Bucket{ t, t, t };
+        b[trendChannel(TREND_FF, i)] = Bucket{ ff, ff, ff };
+    }
+    float fuel = (float)s.fuel;
+    b[TREND_FUEL] = Bucket{ fuel, fuel, fuel };
+
+    uint64_t n = m_samples++;
+    Level& raw = m_levels[0];
+    for (int ch = 0; ch < TREND_CHANNELS; ch++) raw.buckets[(size_t)(n % TREND_LEVEL_CAPACITY) * TREND_CHANNELS + ch] = b[ch];
+
+    // 第 l 层的桶每 4^l 步完成一个，完成后并入上一层正在累积的桶
+    for (int l = 1; l < TREND_LEVELS; l++) {
+        Level& lv = m_levels[l];
+        for (int ch = 0; ch < TREND_CHANNELS; ch++) {
+            Bucket& p = lv.partial[ch];
+            p.min = std::min(p.min, b[ch].min);
+            p.max = std::max(p.max, b[ch].max);
+            p.sum += b[ch].sum;
+        }
+        if ((m_samples & (levelSpan(l) - 1)) != 0) break;
+        size_t slot = (size_t)((m_samples / levelSpan(l) - 1) % TREND_LEVEL_CAPACITY);
+        for (int ch = 0; ch < TREND_CHANNELS; ch++) {
+            b[ch] = lv.partial[ch];
+            lv.buckets[slot * TREND_CHANNELS + ch] = b[ch];
+            lv.partial[ch] = Bucket{ FLT_MAX, -FLT_MAX, 0 };
+        }
+    }
+}
+
+void TrendHistory::query(int channel, double spanSeconds, TrendPoint* out, int width) const {
+    for (int p = 0; p < width; p++) out[p] = TrendPoint{ 0, 0, 0, false };
+    if (width <= 0 || m_samples == 0) return;
+    int64_t span = std::max<int64_t>(1, (int64_t)(spanSeconds / m_sampleSeconds + 0.5));
+    int64_t end = (int64_t)m_samples, start = end - span;
+
+    // 每桶不超过一个像素的最粗一层；该层已覆盖不到窗口起点时再往粗里选
+    double perPixel = (double)span / width;
+    int level = 0;
+    while (level + 1 < TREND_LEVELS && (double)levelSpan(level + 1) <= perPixel) level++;
+    auto oldest = [&](int l) {
+        int64_t done = end / (int64_t)levelSpan(l);
+        return std::max<int64_t>(0, done - TREND_LEVEL_CAPACITY) * (int64_t)levelSpan(l);
+    };
+    while (level + 1 < TREND_LEVELS && oldest(level) > std::max<int64_t>(start, 0)) level++;
+
+    // 按桶的第一步所在的像素归并
+    std::vector<double> sum(width, 0.0);
+    std::vector<int64_t> count(width, 0);
+    auto add = [&](int l, int64_t index) {
+        int64_t n = (int64_t)levelSpan(l), first = index * n;
+        if (first + n <= start) return;
+        int p = first <= start ? 0 : (int)((first - start) * width / span);
+        if (p >= width) p = width - 1;
+        const Bucket& b = m_levels[l].buckets[(size_t)(index % TREND_LEVEL_CAPACITY) * TREND_CHANNELS + channel];
+        TrendPoint& o = out[p];
+        if (!o.valid) o = TrendPoint{ b.min, b.max, 0, true };
+        o.min = std::min(o.min, b.min);
+        o.max = std::max(o.max, b.max);
+        sum[p] += b.sum;
+        count[p] += n;
+    };
+
+    // 所选层已完成的桶，之后不足一桶的尾部由更细的层补齐（每层至多 3 个桶）
+    int64_t from = std::max<int64_t>(std::max<int64_t>(start, 0), oldest(level)) / (int64_t)levelSpan(level);
+    int64_t to = end / (int64_t)levelSpan(level);
+    for (int64_t i = from; i < to; i++) add(level, i);
+    for (int l = level - 1; l >= 0; l--) {
+        int64_t n = (int64_t)levelSpan(l);
+        for (int64_t i = to * TREND_FANOUT; i < end / n; i++) add(l, i);
+        to = end / n;
+    }
+
+    for (int p = 0; p < width; p++) {
+        if (count[p]) out[p].mean = (float)(sum[p] / count[p]);
+    }
+}
@@ -0,0 +1,55 @@
+﻿#pragma once
+// 遥测历史：每个通道（各发动机 N1、EGT、FF 与燃油合计）一个多分辨率最小/最大/平均金字塔，
+// 供面板画趋势图，不必每帧重扫原始数据。
+//
+// 第 0 层是逐步的原始值，第 l 层每个桶汇总 4^l 步；每层都是 TREND_LEVEL_CAPACITY 个桶的环形缓冲区，
+// 内存固定（约 7MB）。1kHz 时第 0 层保留约 4 秒，第 7 层保留 4^7×4096 步，约 18.6 小时。
+// 每步追加时只更新各层正在累积的桶（均摊约 1.33 个桶），不回头重算。
+// 查询“最近 T 秒画成 W 个像素”时选每桶不超过一个像素的最粗一层，只访问约 4W 个桶，与 T 无关。
+#include "sim_core.h"
+#include <cstdint>
+#include <vector>
+
+enum { TREND_N1, TREND_EGT, TREND_FF, TREND_SIGNALS };
+// 通道编号：信号 * SIM_MAX_ENGINES + 发动机，最后一个为燃油合计
+inline int trendChannel(int signal, int engine) { return signal * SIM_MAX_ENGINES + engine; }
+enum { TREND_FUEL = TREND_SIGNALS * SIM_MAX_ENGINES, TREND_CHANNELS };
+
+enum { TREND_FANOUT = 4, TREND_LEVELS = 8, TREND_LEVEL_CAPACITY = 4096 };
+
+// 一个像素（或一个桶）内的取值范围；valid 为 false 表示没有数据
+struct TrendPoint {
+    float min, max, mean;
+    bool valid;
+};
+
+// 按步追加，步长固定（与物理步长相同）；只由一个线程访问
+class TrendHistory : public TelemetrySink {
+public:
+    explicit TrendHistory(double sampleSeconds = 0.001);
+    void reset(double sampleSeconds);
+
+    void append(const TelemetrySample& s);
+    void onSample(const TelemetrySample& s) override { append(s); }
+    void onFault(int64_t, FaultType) override {}
+
+    // 已追加的步数
+    uint64_t samples() const { return m_samples; }
+    double sampleSeconds() const { return m_sampleSeconds; }
+    // 最近 spanSeconds 秒按时间从旧到新均分为 width 段，写出每段的最小/最大/平均值
+    void query(int channel, double spanSeconds, TrendPoint* out, int width) const;
+
+private:
+    struct Bucket {
+        float min, max;
+        double sum;
+    };
+    struct Level {
+        std::vector<Bucket> buckets;          // [TREND_LEVEL_CAPACITY][通道]：每步写入的各通道相邻
+        Bucket partial[TREND_CHANNELS];       // 正在累积的桶（第 0 层不用）
+    };
+
+    double m_sampleSeconds;
+    uint64_t m_samples;
+    std::vector<Level> m_levels;
+};
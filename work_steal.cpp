@@ -0,0 +1,130 @@
+﻿#include "work_steal.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+struct Range {
+    size_t begin, end;
+};
+
+// 每个线程一个队列；锁只在取/放区间时持有，远少于区间内的计算量
+struct alignas(64) WorkQueue {
+    std::mutex lock;
+    std::deque<Range> ranges;
+
+    void pushBack(Range r) {
+        std::lock_guard<std::mutex> g(lock);
+        ranges.push_back(r);
+    }
+    bool popBack(Range& r) {
+        std::lock_guard<std::mutex> g(lock);
+        if (ranges.empty()) return false;
+        r = ranges.back();
+        ranges.pop_back();
+        return true;
+    }
+    bool stealFront(Range& r) {
+        std::lock_guard<std::mutex> g(lock);
+        if (ranges.empty()) return false;
+        r = ranges.front();
+        ranges.pop_front();
+        return true;
+    }
+};
+
+}
+
+int stealingThreadCount(int threads) {
+    if (threads > 0) return threads;
+    int hw = (int)std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+bool pinThreadToCore(int core) {
+    int hw = (int)std::thread::hardware_concurrency();
+    if (hw > 0) core %= hw;
+#if defined(_WIN32)
+    return core < 64 && SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)core;
+    return false;
+#endif
+}
+
+void parallelForStealing(size_t n, size_t grain, int threads,
+    const std::function<void(size_t, size_t, int)>& fn, bool pin) {
+    if (n == 0) return;
+    if (grain == 0) grain = 1;
+    int count = stealingThreadCount(threads);
+    if ((size_t)count > n) count = (int)n;
+
+    std::unique_ptr<WorkQueue[]> queues(new WorkQueue[count]);
+    for (int w = 0; w < count; w++) {
+        queues[w].ranges.push_back({ n * w / count, n * (w + 1) / count });
+    }
+    std::atomic<size_t> remaining(n);
+
+    auto worker = [&](int self) {
+        if (pin) pinThreadToCore(self);
+        unsigned victim = (unsigned)self;
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            Range r;
+            bool got = queues[self].popBack(r);
+            for (int k = 1; !got && k < count; k++) {
+                victim = (victim + 1) % count;
+                if ((int)victim != self) got = queues[victim].stealFront(r);
+            }
+            if (!got) {
+                // 其他线程还在处理最后的区间
+                std::this_thread::yield();
+                continue;
+            }
+            while (r.end - r.begin > grain) {
+                size_t mid = r.begin + (r.end - r.begin) / 2;
+                queues[self].pushBack({ mid, r.end });
+                r.end = mid;
+            }
+            fn(r.begin, r.end, self);
+            remaining.fetch_sub(r.end - r.begin, std::memory_order_release);
+        }
+    };
+
+    // 调用线程也作为 0 号工作线程，固定前保存其亲和性，返回前恢复
+#if defined(_WIN32)
+    DWORD_PTR callerMask = 0;
+    if (pin) {
+        DWORD_PTR process, system;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &process, &system)) callerMask = SetThreadAffinityMask(GetCurrentThread(), process);
+    }
+#elif defined(__linux__)
+    cpu_set_t callerSet;
+    bool callerSaved = pin && pthread_getaffinity_np(pthread_self(), sizeof(callerSet), &callerSet) == 0;
+#endif
+
+    std::vector<std::thread> pool;
+    for (int w = 1; w < count; w++) pool.emplace_back(worker, w);
+    worker(0);
+    for (auto& t : pool) t.join();
+
+#if defined(_WIN32)
+    if (callerMask) SetThreadAffinityMask(GetCurrentThread(), callerMask);
+#elif defined(__linux__)
+    if (callerSaved) pthread_setaffinity_np(pthread_self(), sizeof(callerSet), &callerSet);
+#endif
+}
@@ -0,0 +1,20 @@
+﻿#pragma once
+// 工作窃取并行循环
+//
+// [0, n) 先按线程数均分到各线程的双端队列。线程从自己队列尾部取区间，
+// 区间大于 grain 时对半拆分，把后一半放回队尾；自己队列空了就从其他线程
+// 队列头部窃取（头部是尚未拆分的大区间）。每次运行耗时差异很大时也能保持各核忙碌。
+#include <cstddef>
+#include <functional>
+
+// fn(begin, end, worker)：处理 [begin, end)，worker 为线程序号 0..threads-1
+// threads <= 0 时使用硬件线程数；调用线程作为 0 号线程参与计算。
+// pin 为真时 w 号线程固定在第 w 个硬件线程上（调用线程作为 0 号，返回前恢复其原有亲和性）
+void parallelForStealing(size_t n, size_t grain, int threads,
+    const std::function<void(size_t, size_t, int)>& fn, bool pin = false);
+
+// 把当前线程固定到第 core 个硬件线程（超出时取模）；不支持的平台返回 false
+bool pinThreadToCore(int core);
+
+// 实际使用的线程数（threads <= 0 时取硬件线程数）
+int stealingThreadCount(int threads);